@@ -21,6 +21,7 @@ Created by tvl (t.vanlankveld@esciencecenter.nl) on 08-09-2020
 
 #include "bezier.h"
 
+#include <algorithm>
 #include <cmath>
 
 #include <glog/logging.h>
@@ -100,6 +101,58 @@ Point<Inexact> BezierCurve::evaluate(const Number<Inexact>& t) const {
 	       d * m_controlPoints[3];
 }
 
+/**@brief Compute the number of segments needed to flatten the curve, without an upper limit.
+ *
+ * Linear interpolation between \f$n\f$ evenly spaced times deviates at most \f$\frac{1}{8 n^2} \max |B''(t)|\f$
+ * from the curve, and \f$|B''(t)|\f$ is at most 6 times the largest second difference of the control points.
+ * @param tolerance the maximum allowed distance between the curve and the polyline; must be positive.
+ * @return the smallest number of segments for which this bound is at most the tolerance.
+ */
+Number<Inexact> BezierCurve::requiredSegmentCount(const Number<Inexact>& tolerance) const {
+	CHECK_GT(tolerance, 0);
+	const Vector<Inexact> d1 = m_controlPoints[0] - 2 * m_controlPoints[1] + m_controlPoints[2];
+	const Vector<Inexact> d2 = m_controlPoints[1] - 2 * m_controlPoints[2] + m_controlPoints[3];
+	const Number<Inexact> m = std::sqrt(std::max(d1.squared_length(), d2.squared_length()));
+	return std::max(std::ceil(std::sqrt(3 * m / (4 * tolerance))), Number<Inexact>(1));
+}
+
+/**@brief Compute the number of segments the curve is flattened into.
+ *
+ * @param tolerance the maximum allowed distance between the curve and the polyline; must be positive.
+ * @return the number of segments needed to stay within the tolerance, capped at \ref MAX_FLATTENING_SEGMENTS.
+ */
+int BezierCurve::flatteningSegmentCount(const Number<Inexact>& tolerance) const {
+	return static_cast<int>(std::min(requiredSegmentCount(tolerance), Number<Inexact>(MAX_FLATTENING_SEGMENTS)));
+}
+
+/**@brief Append a polyline approximating the curve.
+ *
+ * @param tolerance the maximum allowed distance between the curve and the polyline; must be positive.
+ * @param points the buffer to append the vertices to, except the source of the curve.
+ * @return whether the polyline is within the tolerance; false if the curve needs more than \ref
+ * MAX_FLATTENING_SEGMENTS segments.
+ */
+bool BezierCurve::flatten(const Number<Inexact>& tolerance, std::vector<Point<Inexact>>& points) const {
+	const Number<Inexact> required = requiredSegmentCount(tolerance);
+	const int n = static_cast<int>(std::min(required, Number<Inexact>(MAX_FLATTENING_SEGMENTS)));
+	const size_t first = points.size();
+	points.resize(first + n);
+
+	// The times are independent, so the compiler can vectorize this loop.
+	const Number<Inexact> ax = m_coefficients[0].x(), ay = m_coefficients[0].y();
+	const Number<Inexact> bx = m_coefficients[1].x(), by = m_coefficients[1].y();
+	const Number<Inexact> cx = m_coefficients[2].x(), cy = m_coefficients[2].y();
+	const Number<Inexact> dx = m_coefficients[3].x(), dy = m_coefficients[3].y();
+	const Number<Inexact> step = Number<Inexact>(1) / n;
+	Point<Inexact>* out = points.data() + first;
+	for (int i = 0; i < n - 1; ++i) {
+		const Number<Inexact> t = (i + 1) * step;
+		out[i] = Point<Inexact>(((ax * t + bx) * t + cx) * t + dx, ((ay * t + by) * t + cy) * t + dy);
+	}
+	out[n - 1] = target();
+	return required <= MAX_FLATTENING_SEGMENTS;
+}
+
 size_t BezierCurve::intersectRay(const Point<Inexact>& source, const Point<Inexact>& target,
                                  Point<Inexact>* intersections,
                                  Number<Inexact>* intersection_t) const {
@@ -400,4 +453,26 @@ Box BezierSpline::computeBoundingBox() const {
 	return bounding_box_;
 }
 
+/**@brief Flatten the spline into a polyline.
+ *
+ * The previous contents of the buffer are replaced, but its capacity is kept, so that a buffer can be reused for many
+ * splines without reallocating.
+ * @param tolerance the maximum allowed distance between the spline and the polyline; must be positive.
+ * @param points the buffer to store the vertices of the polyline in.
+ * @return whether the polyline is within the tolerance; false if a curve needs more than \ref
+ * MAX_FLATTENING_SEGMENTS segments.
+ */
+bool BezierSpline::flatten(const Number<Inexact>& tolerance, std::vector<Point<Inexact>>& points) const {
+	points.clear();
+	if (curves_.empty()) {
+		return true;
+	}
+	points.push_back(curves_.front().source());
+	bool withinTolerance = true;
+	for (const BezierCurve& curve : curves_) {
+		withinTolerance &= curve.flatten(tolerance, points);
+	}
+	return withinTolerance;
+}
+
 } // namespace cartocrow::necklace_map
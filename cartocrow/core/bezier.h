@@ -55,6 +55,22 @@ class BezierCurve {
 	/// Evaluates the curve at time \c t.
 	Point<Inexact> evaluate(const Number<Inexact>& t) const;
 
+	/// Returns the number of segments \ref flatten() approximates this curve
+	/// with. This is at most \ref MAX_FLATTENING_SEGMENTS.
+	int flatteningSegmentCount(const Number<Inexact>& tolerance) const;
+	/// Appends a polyline approximating this curve to \p points.
+	/**
+	 * The polyline deviates at most \p tolerance from the curve, unless that
+	 * takes more than \ref MAX_FLATTENING_SEGMENTS segments. In that case the
+	 * curve is approximated with that many segments and false is returned.
+	 * The vertices are evaluated at evenly spaced times; their number follows
+	 * from the curvature of the control polygon (Wang's formula), so flat parts
+	 * of a spline get few vertices. The source is not appended, so that the
+	 * curves of a spline can be flattened into one buffer one after the other;
+	 * the last point appended is exactly the target.
+	 */
+	bool flatten(const Number<Inexact>& tolerance, std::vector<Point<Inexact>>& points) const;
+
 	/// TODO document
 	// There can be up to three intersections.
 	size_t intersectRay(const Point<Inexact>& source, const Point<Inexact>& target,
@@ -63,6 +79,10 @@ class BezierCurve {
 	BezierCurve transform(const CGAL::Aff_transformation_2<Inexact> &t) const;
 
   protected:
+	/// Returns the number of segments needed to flatten this curve within the
+	/// tolerance, which may exceed \ref MAX_FLATTENING_SEGMENTS.
+	Number<Inexact> requiredSegmentCount(const Number<Inexact>& tolerance) const;
+
 	// TODO control points stored as Vectors instead of Points
 	std::array<Vector<Inexact>, 4> m_controlPoints;
 	std::array<Vector<Inexact>, 4> m_coefficients;
@@ -100,6 +120,8 @@ class BezierSpline {
 
 	Box computeBoundingBox() const;
 
+	bool flatten(const Number<Inexact>& tolerance, std::vector<Point<Inexact>>& points) const;
+
   private:
 	CurveSet curves_;
 
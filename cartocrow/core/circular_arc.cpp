@@ -4,6 +4,11 @@
 
 #include "circular_arc.h"
 
+#include <algorithm>
+#include <cmath>
+
+#include <glog/logging.h>
+
 namespace cartocrow {
 
 CircularArc::CircularArc(const Circle<Inexact>& circle, const Number<Inexact>& start_angle, const Number<Inexact>& span_angle)
@@ -21,4 +26,33 @@ Number<Inexact> CircularArc::spanAngle() const {
 	return m_span_angle;
 }
 
+bool CircularArc::flatten(const Number<Inexact>& tolerance, std::vector<Point<Inexact>>& points) const {
+	CHECK_GT(tolerance, 0);
+	const Number<Inexact> radius = std::sqrt(m_circle.squared_radius());
+	// A chord spanning an angle of 2 * acos(1 - tolerance / radius) deviates
+	// exactly the tolerance from the arc in its middle.
+	const Number<Inexact> maxStep = tolerance >= radius ? M_PI : 2 * std::acos(1 - tolerance / radius);
+	const Number<Inexact> required = std::max(std::ceil(std::abs(m_span_angle) / maxStep), Number<Inexact>(1));
+	const int n = static_cast<int>(std::min(required, Number<Inexact>(MAX_FLATTENING_SEGMENTS)));
+
+	points.resize(n + 1);
+	// Rotate the radius vector by a fixed angle each step, which avoids
+	// evaluating sines and cosines for every vertex.
+	const Number<Inexact> step = m_span_angle / n;
+	const Number<Inexact> cosStep = std::cos(step);
+	const Number<Inexact> sinStep = std::sin(step);
+	const Point<Inexact>& center = m_circle.center();
+	Number<Inexact> x = radius * std::cos(m_start_angle);
+	Number<Inexact> y = radius * std::sin(m_start_angle);
+	for (int i = 0; i < n; ++i) {
+		points[i] = Point<Inexact>(center.x() + x, center.y() + y);
+		const Number<Inexact> nextX = x * cosStep - y * sinStep;
+		y = x * sinStep + y * cosStep;
+		x = nextX;
+	}
+	const Number<Inexact> end = m_start_angle + m_span_angle;
+	points[n] = Point<Inexact>(center.x() + radius * std::cos(end), center.y() + radius * std::sin(end));
+	return required <= MAX_FLATTENING_SEGMENTS;
+}
+
 }
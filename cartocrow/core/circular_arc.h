@@ -7,6 +7,8 @@
 
 #include "core.h"
 
+#include <vector>
+
 namespace cartocrow {
 
 class CircularArc {
@@ -20,6 +22,17 @@ class CircularArc {
 
 	Number<Inexact> spanAngle() const;
 
+	/// Replaces the contents of \p points by a polyline approximating this arc.
+	/**
+	 * The polyline deviates at most \p tolerance from the arc, unless that
+	 * takes more than \ref MAX_FLATTENING_SEGMENTS segments. In that case the
+	 * arc is approximated with that many segments and false is returned.
+	 * The vertices are evenly spaced on the arc, starting at the start and ending
+	 * at the end of the arc. The capacity of \p points is kept, so that a buffer
+	 * can be reused for many arcs without reallocating.
+	 */
+	bool flatten(const Number<Inexact>& tolerance, std::vector<Point<Inexact>>& points) const;
+
 	Circle<Inexact> m_circle;
 	Number<Inexact> m_start_angle;
 	Number<Inexact> m_span_angle;
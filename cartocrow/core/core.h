@@ -83,6 +83,16 @@ template <class K> using Arrangement = CGAL::Arrangement_2<CGAL::Arr_segment_tra
  */
 constexpr const Number<Inexact> M_EPSILON = 0.0000001;
 
+/// The largest number of segments a single curve is flattened into.
+/**
+ * This bounds the memory and time used by \ref BezierCurve::flatten() and
+ * \ref CircularArc::flatten() when the tolerance is tiny compared to the curve.
+ * If a curve needs more segments to stay within the tolerance, it is flattened
+ * into this many segments anyway, and the functions report that the tolerance
+ * was not met.
+ */
+constexpr int MAX_FLATTENING_SEGMENTS = 1 << 16;
+
 /// Converts a point from exact representation to an approximation in inexact
 /// representation.
 template <class K>
@@ -0,0 +1,289 @@
+/*
+The CartoCrow library implements algorithmic geo-visualization methods,
+developed at TU Eindhoven.
+Copyright (C) 2021  Netherlands eScience Center and TU Eindhoven
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "profiler.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string_view>
+
+namespace cartocrow {
+
+namespace {
+
+/// Converts a duration to microseconds, the unit of the Chrome trace format.
+std::string toMicroseconds(Profiler::Clock::duration time) {
+	char buffer[32];
+	double us = std::chrono::duration<double, std::micro>(time).count();
+	auto [end, error] = std::to_chars(buffer, buffer + sizeof(buffer), us, std::chars_format::fixed, 3);
+	return std::string(buffer, end);
+}
+
+double toSeconds(Profiler::Clock::duration time) {
+	return std::chrono::duration<double>(time).count();
+}
+
+std::string escapeForJson(std::string_view text) {
+	std::string result;
+	result.reserve(text.size());
+	for (char c : text) {
+		if (c == '"' || c == '\\') {
+			result += '\\';
+		}
+		result += c;
+	}
+	return result;
+}
+
+} // namespace
+
+/// Holds the buffer of a thread, and frees it when the thread exits.
+struct ThreadBufferLease {
+	~ThreadBufferLease() {
+		if (m_buffer) {
+			Profiler::instance().release(*m_buffer);
+		}
+	}
+	Profiler::ThreadBuffer* m_buffer = nullptr;
+};
+
+Profiler::Profiler() : m_epoch(Clock::now()) {
+	if (const char* file = std::getenv("CARTOCROW_PROFILE"); file && *file) {
+		m_traceFile = file;
+		m_enabled = true;
+	}
+}
+
+Profiler::~Profiler() {
+	if (!m_traceFile.empty()) {
+		try {
+			saveChromeTrace(m_traceFile);
+		} catch (const std::exception& e) {
+			std::cerr << e.what() << std::endl;
+		}
+	}
+}
+
+Profiler& Profiler::instance() {
+	static Profiler profiler;
+	return profiler;
+}
+
+bool Profiler::enabled() {
+	return instance().m_enabled.load(std::memory_order_relaxed);
+}
+
+void Profiler::setEnabled(bool enabled) {
+	m_enabled = enabled;
+}
+
+void Profiler::clear() {
+	std::lock_guard lock(m_mutex);
+	for (const auto& buffer : m_buffers) {
+		std::lock_guard bufferLock(buffer->m_mutex);
+		buffer->m_zones.clear();
+		buffer->m_counters.clear();
+	}
+	m_epoch = Clock::now();
+}
+
+void Profiler::count(const char* name, long long delta) {
+	if (!enabled()) {
+		return;
+	}
+	ThreadBuffer& buffer = instance().buffer();
+	Clock::time_point now = Clock::now();
+	std::lock_guard lock(buffer.m_mutex);
+	Counter& counter = buffer.m_counters[name];
+	counter.m_value += delta;
+	counter.m_time = now;
+}
+
+Profiler::ThreadBuffer& Profiler::buffer() {
+	thread_local ThreadBufferLease lease;
+	if (!lease.m_buffer) {
+		std::lock_guard lock(m_mutex);
+		auto free = std::find_if(m_buffers.begin(), m_buffers.end(), [](const auto& buffer) {
+			return !buffer->m_inUse;
+		});
+		if (free != m_buffers.end()) {
+			(*free)->m_inUse = true;
+			lease.m_buffer = free->get();
+		} else {
+			m_buffers.push_back(std::make_unique<ThreadBuffer>());
+			m_buffers.back()->m_thread = static_cast<int>(m_buffers.size()) - 1;
+			lease.m_buffer = m_buffers.back().get();
+		}
+	}
+	return *lease.m_buffer;
+}
+
+void Profiler::release(ThreadBuffer& buffer) {
+	std::lock_guard lock(m_mutex);
+	buffer.m_inUse = false;
+}
+
+std::vector<Profiler::Zone> Profiler::zones() const {
+	std::vector<Zone> result;
+	{
+		std::lock_guard lock(m_mutex);
+		for (const auto& buffer : m_buffers) {
+			std::lock_guard bufferLock(buffer->m_mutex);
+			result.insert(result.end(), buffer->m_zones.begin(), buffer->m_zones.end());
+		}
+	}
+	// zones are recorded when they are left, so inner zones come before outer ones
+	std::sort(result.begin(), result.end(), [](const Zone& a, const Zone& b) {
+		if (a.m_start != b.m_start) {
+			return a.m_start < b.m_start;
+		}
+		if (a.m_thread != b.m_thread) {
+			return a.m_thread < b.m_thread;
+		}
+		return a.m_depth < b.m_depth;
+	});
+	return result;
+}
+
+std::map<std::string, Profiler::Counter> Profiler::combinedCounters() const {
+	// counters are keyed by the address of their name, which need not be the
+	// same for equal names, so they are combined by name
+	std::map<std::string, Counter> result;
+	std::lock_guard lock(m_mutex);
+	for (const auto& buffer : m_buffers) {
+		std::lock_guard bufferLock(buffer->m_mutex);
+		for (const auto& [name, counter] : buffer->m_counters) {
+			Counter& combined = result[name];
+			combined.m_value += counter.m_value;
+			combined.m_time = std::max(combined.m_time, counter.m_time);
+		}
+	}
+	return result;
+}
+
+std::map<std::string, long long> Profiler::counters() const {
+	std::map<std::string, long long> result;
+	for (const auto& [name, counter] : combinedCounters()) {
+		result[name] = counter.m_value;
+	}
+	return result;
+}
+
+void Profiler::writeSummary(std::ostream& out) const {
+	struct Totals {
+		Clock::duration m_total{};
+		Clock::duration m_children{};
+		size_t m_calls = 0;
+	};
+	std::map<std::string, Totals> totals;
+
+	// Find the parent of each zone to compute self times. Zones are ordered by
+	// start time, so the parent of a zone is the last zone on the same thread
+	// one level up.
+	std::vector<Zone> all = zones();
+	std::map<int, std::vector<const Zone*>> stacks;
+	for (const Zone& zone : all) {
+		std::vector<const Zone*>& stack = stacks[zone.m_thread];
+		while (!stack.empty() && stack.back()->m_depth >= zone.m_depth) {
+			stack.pop_back();
+		}
+		if (!stack.empty() && stack.back()->m_depth == zone.m_depth - 1) {
+			totals[stack.back()->m_name].m_children += zone.m_duration;
+		}
+		stack.push_back(&zone);
+		Totals& zoneTotals = totals[zone.m_name];
+		zoneTotals.m_total += zone.m_duration;
+		++zoneTotals.m_calls;
+	}
+
+	std::vector<std::pair<std::string, Totals>> ordered(totals.begin(), totals.end());
+	std::stable_sort(ordered.begin(), ordered.end(), [](const auto& a, const auto& b) {
+		return a.second.m_total > b.second.m_total;
+	});
+	for (const auto& [name, zoneTotals] : ordered) {
+		out << name << ": " << toSeconds(zoneTotals.m_total) << " s (self "
+		    << toSeconds(zoneTotals.m_total - zoneTotals.m_children) << " s, " << zoneTotals.m_calls
+		    << (zoneTotals.m_calls == 1 ? " call)" : " calls)") << "\n";
+	}
+	for (const auto& [name, value] : counters()) {
+		out << name << ": " << value << "\n";
+	}
+}
+
+void Profiler::writeChromeTrace(std::ostream& out) const {
+	Clock::time_point epoch;
+	{
+		std::lock_guard lock(m_mutex);
+		epoch = m_epoch;
+	}
+	out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+	bool first = true;
+	auto separate = [&]() {
+		out << (first ? "" : ",\n");
+		first = false;
+	};
+	for (const Zone& zone : zones()) {
+		separate();
+		out << "{\"name\": \"" << escapeForJson(zone.m_name) << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": "
+		    << zone.m_thread << ", \"ts\": " << toMicroseconds(zone.m_start - epoch)
+		    << ", \"dur\": " << toMicroseconds(zone.m_duration) << "}";
+	}
+	for (const auto& [name, counter] : combinedCounters()) {
+		separate();
+		out << "{\"name\": \"" << escapeForJson(name) << "\", \"ph\": \"C\", \"pid\": 1, \"ts\": "
+		    << toMicroseconds(counter.m_time - epoch) << ", \"args\": {\"value\": " << counter.m_value << "}}";
+	}
+	out << "\n]}\n";
+}
+
+void Profiler::saveChromeTrace(const std::filesystem::path& file) const {
+	std::ofstream out(file);
+	if (!out) {
+		throw std::runtime_error("Could not open " + file.string() + " for writing");
+	}
+	writeChromeTrace(out);
+	if (!out) {
+		throw std::runtime_error("Could not write " + file.string());
+	}
+}
+
+ProfileZone::ProfileZone(const char* name) : m_name(name) {
+	if (!Profiler::enabled()) {
+		return;
+	}
+	m_buffer = &Profiler::instance().buffer();
+	m_depth = m_buffer->m_depth++;
+	m_start = Profiler::Clock::now();
+}
+
+ProfileZone::~ProfileZone() {
+	if (!m_buffer) {
+		return;
+	}
+	Profiler::Clock::duration duration = Profiler::Clock::now() - m_start;
+	--m_buffer->m_depth;
+	std::lock_guard lock(m_buffer->m_mutex);
+	m_buffer->m_zones.push_back(Profiler::Zone{m_name, m_buffer->m_thread, m_depth, m_start, duration});
+}
+
+} // namespace cartocrow
@@ -0,0 +1,201 @@
+/*
+The CartoCrow library implements algorithmic geo-visualization methods,
+developed at TU Eindhoven.
+Copyright (C) 2021  Netherlands eScience Center and TU Eindhoven
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef CARTOCROW_CORE_PROFILER_H
+#define CARTOCROW_CORE_PROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace cartocrow {
+
+/// Collects the running times of nested zones of code, on any number of threads.
+/**
+ * Where \ref Timer is meant for reporting the steps of a single algorithm, the
+ * profiler is meant to be left in library code, so that it is possible to see
+ * where time goes in a complete run. Code is instrumented by putting a \ref
+ * ProfileZone in a scope:
+ * ```
+ * void NecklaceMap::compute() {
+ *     ProfileZone zone("NecklaceMap::compute");
+ *     // ...
+ * }
+ * ```
+ * Zones can be nested, and can be used concurrently on different threads. Each
+ * thread records its zones in a buffer of its own; the buffers are merged only
+ * when the results are requested. When a thread exits, its buffer is kept
+ * with the zones recorded so far, and handed to the next thread that starts
+ * using the profiler. Next to zones, the profiler keeps track of named
+ * counters, which are incremented with \ref count(). Counters are summed in
+ * place, so they can be used in hot loops without using more memory.
+ *
+ * The profiler is disabled by default, in which case a zone costs no more than
+ * a check of a flag. It is enabled with \ref setEnabled(), or by setting the
+ * environment variable `CARTOCROW_PROFILE` to the name of a file; in the latter
+ * case a Chrome trace (see \ref writeChromeTrace()) is written to that file when
+ * the program exits.
+ */
+class Profiler {
+  public:
+	/// The clock used for the timestamps.
+	using Clock = std::chrono::steady_clock;
+
+	/// A recorded execution of a zone.
+	struct Zone {
+		/// The name of the zone.
+		const char* m_name;
+		/// The index of the thread the zone ran on. Threads that did not run at
+		/// the same time may share an index.
+		int m_thread;
+		/// The number of zones this zone was nested in.
+		int m_depth;
+		/// The time the zone was entered.
+		Clock::time_point m_start;
+		/// The time spent in the zone.
+		Clock::duration m_duration;
+	};
+
+	/// Returns the profiler.
+	static Profiler& instance();
+
+	/// Checks whether zones and counters are being recorded.
+	static bool enabled();
+	/// Starts or stops recording zones and counters.
+	void setEnabled(bool enabled);
+	/// Drops everything recorded so far.
+	void clear();
+
+	/// Adds \p delta to the counter with the given name.
+	/**
+	 * The name must remain valid as long as the profiler is used; in practice it
+	 * should be a string literal.
+	 */
+	static void count(const char* name, long long delta = 1);
+
+	/// Returns the zones recorded on all threads, ordered by their start time.
+	/**
+	 * Zones that have not been left yet are not included.
+	 */
+	std::vector<Zone> zones() const;
+	/// Returns the current value of each counter.
+	std::map<std::string, long long> counters() const;
+
+	/// Outputs the total and self time and the number of calls of each zone,
+	/// followed by the counters, in a human-readable format.
+	void writeSummary(std::ostream& out) const;
+	/// Outputs the zones and counters in the Chrome trace event format, which
+	/// can be viewed in `chrome://tracing` or Perfetto. Each counter is shown
+	/// with its final value, at the time it was last changed.
+	void writeChromeTrace(std::ostream& out) const;
+	/// Writes a Chrome trace (see \ref writeChromeTrace()) to a file.
+	///
+	/// Throws a `std::runtime_error` if the file cannot be written.
+	void saveChromeTrace(const std::filesystem::path& file) const;
+
+  private:
+	friend class ProfileZone;
+
+	friend struct ThreadBufferLease;
+
+	/// The value of a counter.
+	struct Counter {
+		long long m_value = 0;
+		/// The time the counter was last changed.
+		Clock::time_point m_time;
+	};
+
+	/// The zones and counters recorded on one thread.
+	struct ThreadBuffer {
+		/// Protects the recorded data; only contended while the results are read.
+		mutable std::mutex m_mutex;
+		/// The index of the thread.
+		int m_thread;
+		/// Whether a running thread records in this buffer; protected by
+		/// Profiler::m_mutex.
+		bool m_inUse = true;
+		/// The number of zones the thread is currently in.
+		int m_depth = 0;
+		std::vector<Zone> m_zones;
+		std::unordered_map<const char*, Counter> m_counters;
+	};
+
+	Profiler();
+	~Profiler();
+
+	/// Returns the buffer of the calling thread, taking a free buffer or
+	/// registering a new one on first use.
+	ThreadBuffer& buffer();
+	/// Marks the buffer as free, so that another thread can record in it.
+	void release(ThreadBuffer& buffer);
+	/// Returns the counters of all threads combined.
+	std::map<std::string, Counter> combinedCounters() const;
+
+	/// Whether we are recording.
+	std::atomic<bool> m_enabled = false;
+	/// The time that timestamps in the trace are relative to.
+	Clock::time_point m_epoch;
+	/// The file to write a trace to on exit, if any.
+	std::filesystem::path m_traceFile;
+
+	/// Protects \ref m_buffers.
+	mutable std::mutex m_mutex;
+	/// The buffers of all threads that have used the profiler. There are as
+	/// many as there were threads using the profiler at the same time.
+	std::vector<std::unique_ptr<ThreadBuffer>> m_buffers;
+};
+
+/// Records the time spent in a scope in the \ref Profiler.
+/**
+ * The zone is entered on construction and left on destruction. The name must
+ * remain valid as long as the profiler is used; in practice it should be a
+ * string literal.
+ */
+class ProfileZone {
+  public:
+	/// Enters the zone with the given name.
+	explicit ProfileZone(const char* name);
+	/// Leaves the zone.
+	~ProfileZone();
+
+	ProfileZone(const ProfileZone&) = delete;
+	ProfileZone& operator=(const ProfileZone&) = delete;
+
+  private:
+	/// The buffer to record the zone in, or \c nullptr if the profiler was
+	/// disabled when the zone was entered.
+	Profiler::ThreadBuffer* m_buffer = nullptr;
+	/// The name of the zone.
+	const char* m_name;
+	/// The nesting depth of the zone.
+	int m_depth = 0;
+	/// The time the zone was entered.
+	Profiler::Clock::time_point m_start;
+};
+
+} // namespace cartocrow
+
+#endif //CARTOCROW_CORE_PROFILER_H
@@ -32,7 +32,7 @@ Timer::Timer() {
 void Timer::reset() {
 	m_stamps.clear();
 	m_descriptions.clear();
-	m_stamps.push_back(clock());
+	m_stamps.push_back(Clock::now());
 }
 
 std::pair<std::string, double> Timer::operator[](const size_t& i) const {
@@ -40,17 +40,17 @@ std::pair<std::string, double> Timer::operator[](const size_t& i) const {
 }
 
 double Timer::stamp(const std::string& description) {
-	m_stamps.push_back(clock());
+	m_stamps.push_back(Clock::now());
 	m_descriptions.push_back(description);
-	return toSeconds(m_stamps.back() - m_stamps[m_stamps.size() - 1]);
+	return toSeconds(m_stamps.back() - m_stamps[m_stamps.size() - 2]);
 }
 
 double Timer::peek() const {
-	return toSeconds(clock() - m_stamps[m_stamps.size() - 1]);
+	return toSeconds(Clock::now() - m_stamps.back());
 }
 
 double Timer::span() const {
-	return double(m_stamps.back() - m_stamps.front()) / CLOCKS_PER_SEC;
+	return toSeconds(m_stamps.back() - m_stamps.front());
 }
 
 size_t Timer::size() const {
@@ -63,8 +63,8 @@ void Timer::output() const {
 	}
 }
 
-double Timer::toSeconds(clock_t time) {
-	return double(time) / CLOCKS_PER_SEC;
+double Timer::toSeconds(Clock::duration time) {
+	return std::chrono::duration<double>(time).count();
 }
 
 } // namespace cartocrow
@@ -22,8 +22,7 @@ Created by tvl (t.vanlankveld@esciencecenter.nl) on 04-02-2020
 #ifndef CARTOCROW_CORE_TIMER_H
 #define CARTOCROW_CORE_TIMER_H
 
-#include "time.h"
-
+#include <chrono>
 #include <string>
 #include <vector>
 
@@ -57,7 +56,12 @@ namespace cartocrow {
  * std::cout << timer[0].first << "\n";  // "Demolish Earth"
  * std::cout << timer[0].second << "\n";  // "120.0"
  * ```
- * Any methods returning \c double return times in seconds.
+ * Any methods returning \c double return times in seconds. Times are
+ * measured as wall-clock time on a monotonic, high-resolution clock, so they
+ * include time spent waiting for other threads.
+ *
+ * To find out where time goes across a whole run, including on other threads,
+ * use the \ref Profiler instead.
  */
 class Timer {
   public:
@@ -96,12 +100,14 @@ class Timer {
 	void output() const;
 
   private:
-	/// Converts a time in clock ticks to seconds.
-	static double toSeconds(clock_t time);
+	/// The clock used for the timestamps.
+	using Clock = std::chrono::steady_clock;
+	/// Converts a duration to seconds.
+	static double toSeconds(Clock::duration time);
 	/// The event descriptions for each step.
 	std::vector<std::string> m_descriptions;
 	/// The timestamps (one more than contained in \ref m_descriptions).
-	std::vector<clock_t> m_stamps;
+	std::vector<Clock::time_point> m_stamps;
 };
 
 } // namespace cartocrow
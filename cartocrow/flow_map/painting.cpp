@@ -68,18 +68,17 @@ void Painting::paintFlow(renderer::GeometryRenderer& renderer) const {
 
 void Painting::paintNodes(renderer::GeometryRenderer& renderer) const {
 	renderer.setMode(renderer::GeometryRenderer::vertices);
-	renderer.setStroke(Color{100, 100, 100}, 4);
+	std::vector<Point<Inexact>> steinerNodes;
+	std::vector<Point<Inexact>> otherNodes;
 	for (const auto& node : m_tree->nodes()) {
-		if (node->isSteiner()) {
-			renderer.draw(node->m_position.toCartesian() + (m_tree->rootPosition() - CGAL::ORIGIN));
-		}
+		Point<Inexact> position =
+		    node->m_position.toCartesian() + (m_tree->rootPosition() - CGAL::ORIGIN);
+		(node->isSteiner() ? steinerNodes : otherNodes).push_back(position);
 	}
+	renderer.setStroke(Color{100, 100, 100}, 4);
+	renderer.drawPoints(steinerNodes);
 	renderer.setStroke(Color{0, 0, 0}, 4);
-	for (const auto& node : m_tree->nodes()) {
-		if (!node->isSteiner()) {
-			renderer.draw(node->m_position.toCartesian() + (m_tree->rootPosition() - CGAL::ORIGIN));
-		}
-	}
+	renderer.drawPoints(otherNodes);
 	renderer.setStroke(Color{0, 50, 150}, 4);
 	renderer.draw(m_tree->rootPosition());
 }
@@ -26,6 +26,7 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include <ostream>
 
 #include "../core/core.h"
+#include "../core/profiler.h"
 #include "intersections.h"
 #include "polar_point.h"
 #include "polar_segment.h"
@@ -383,6 +384,7 @@ ReachableRegionAlgorithm::ReachableRegionAlgorithm(std::shared_ptr<SpiralTree> t
       m_circle(SweepInterval::Type::REACHABLE) {}
 
 ReachableRegionAlgorithm::ReachableRegion ReachableRegionAlgorithm::run() {
+	ProfileZone zone("ReachableRegionAlgorithm::run");
 
 	std::cout << "\033[1m──────────────────────────────────────────────────────────\033[0m\n"
 	          << "\033[1m Step 1: Outwards sweep to construct the reachable region \033[0m\n"
@@ -410,6 +412,7 @@ ReachableRegionAlgorithm::ReachableRegion ReachableRegionAlgorithm::run() {
 	while (!m_queue.empty()) {
 		std::shared_ptr<Event> event = m_queue.top();
 		m_queue.pop();
+		Profiler::count("reachable region events");
 		if (!event->isValid()) {
 			continue;
 		}
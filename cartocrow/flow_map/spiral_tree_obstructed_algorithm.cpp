@@ -27,6 +27,7 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include <ostream>
 
 #include "../core/core.h"
+#include "../core/profiler.h"
 #include "intersections.h"
 #include "polar_point.h"
 #include "polar_segment.h"
@@ -401,6 +402,7 @@ SpiralTreeObstructedAlgorithm::SpiralTreeObstructedAlgorithm(
       m_circle(SweepInterval::Type::FREE) {}
 
 void SpiralTreeObstructedAlgorithm::run() {
+	ProfileZone zone("SpiralTreeObstructedAlgorithm::run");
 
 	std::cout << "\033[1m────────────────────────────────────────────────────\033[0m\n"
 	          << "\033[1m Step 2: Inwards sweep to construct the spiral tree \033[0m\n"
@@ -430,6 +432,7 @@ void SpiralTreeObstructedAlgorithm::run() {
 	while (!m_queue.empty() && (activeNodeCount > 1 || remainingNodeVertexEventCount > 0)) {
 		std::shared_ptr<Event> event = m_queue.top();
 		m_queue.pop();
+		Profiler::count("spiral tree events");
 		if (!event->isValid()) {
 			continue;
 		}
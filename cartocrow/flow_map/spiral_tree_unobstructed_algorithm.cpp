@@ -25,6 +25,7 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include <ostream>
 
 #include "../core/core.h"
+#include "../core/profiler.h"
 #include "../necklace_map/circular_range.h"
 #include "circulator.h"
 #include "intersections.h"
@@ -37,6 +38,7 @@ SpiralTreeUnobstructedAlgorithm::SpiralTreeUnobstructedAlgorithm(SpiralTree& tre
     : m_tree(tree), m_debugPainting(std::make_shared<renderer::PaintingRenderer>()) {}
 
 void SpiralTreeUnobstructedAlgorithm::run() {
+	ProfileZone zone("SpiralTreeUnobstructedAlgorithm::run");
 
 	// we maintain a wavefront as a BST of events, with their angle around the
 	// root as the key
@@ -52,6 +54,7 @@ void SpiralTreeUnobstructedAlgorithm::run() {
 	while (!events.empty()) {
 		Event event = events.top();
 		events.pop();
+		Profiler::count("spiral tree events");
 
 		// if we have reached the root, handle that and stop
 		if (event.m_relative_position.r() == 0) {
@@ -0,0 +1,172 @@
+/*
+The CartoCrow library implements algorithmic geo-visualization methods,
+developed at TU Eindhoven.
+Copyright (C) 2024 TU Eindhoven
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "binary_isolines.h"
+#include <bit>
+
+namespace cartocrow::isoline_simplification {
+namespace {
+constexpr char MAGIC[8] = {'C', 'C', 'I', 'S', 'O', 'L', 'N', '1'};
+/// The number of coordinates read from the file at once.
+constexpr size_t CHUNK_SIZE = 1 << 16;
+/// The size in bytes of the file header: the magic string, the two counts and the bounding box.
+constexpr uint64_t HEADER_SIZE = 8 + 2 * sizeof(uint64_t) + 4 * sizeof(double);
+/// The size in bytes of an isoline apart from its vertices: the vertex count and the closed flag.
+constexpr uint64_t ISOLINE_SIZE = sizeof(uint64_t) + sizeof(uint8_t);
+/// The size in bytes of a vertex.
+constexpr uint64_t VERTEX_SIZE = 2 * sizeof(double);
+
+static_assert(std::endian::native == std::endian::little,
+              "Binary isoline files are little-endian; reading them on big-endian systems is not supported");
+
+template <typename T> void readValue(std::ifstream& in, T& value) {
+	in.read(reinterpret_cast<char*>(&value), sizeof(T));
+	if (!in) {
+		throw std::runtime_error("Unexpected end of binary isoline file");
+	}
+}
+
+template <typename T> void writeValue(std::ofstream& out, const T& value) {
+	out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+}
+
+BinaryIsolineReader::BinaryIsolineReader(const std::filesystem::path& file) : m_in(file, std::ios::binary) {
+	if (!m_in) {
+		throw std::runtime_error("Cannot open binary isoline file " + file.string());
+	}
+	char magic[8];
+	m_in.read(magic, 8);
+	if (!m_in || !std::equal(magic, magic + 8, MAGIC)) {
+		throw std::runtime_error(file.string() + " is not a binary isoline file");
+	}
+	readValue(m_in, m_header.m_isolines);
+	readValue(m_in, m_header.m_vertices);
+	// The counts determine the size of the file, so check them against it before trusting them. This also keeps
+	// them small enough that the sizes computed from them do not overflow.
+	uint64_t size = std::filesystem::file_size(file);
+	uint64_t body = size < HEADER_SIZE ? 0 : size - HEADER_SIZE;
+	if (m_header.m_isolines > body / ISOLINE_SIZE ||
+	    m_header.m_vertices > (body - m_header.m_isolines * ISOLINE_SIZE) / VERTEX_SIZE) {
+		throw std::runtime_error(file.string() + " is shorter than its header states");
+	}
+	if (m_header.m_isolines * ISOLINE_SIZE + m_header.m_vertices * VERTEX_SIZE != body) {
+		throw std::runtime_error(file.string() + " is longer than its header states");
+	}
+	double xmin, ymin, xmax, ymax;
+	readValue(m_in, xmin);
+	readValue(m_in, ymin);
+	readValue(m_in, xmax);
+	readValue(m_in, ymax);
+	m_header.m_bbox = Box(xmin, ymin, xmax, ymax);
+}
+
+const BinaryIsolineHeader& BinaryIsolineReader::header() const {
+	return m_header;
+}
+
+std::optional<Isoline<K>> BinaryIsolineReader::next() {
+	if (m_read >= m_header.m_isolines) {
+		return std::nullopt;
+	}
+	uint64_t count;
+	readValue(m_in, count);
+	uint8_t closed;
+	readValue(m_in, closed);
+	// The header bounds the vertex count, which also keeps the coordinate count below from overflowing.
+	if (count > m_header.m_vertices - m_verticesRead) {
+		throw std::runtime_error("Binary isoline file contains more vertices than its header states");
+	}
+	m_verticesRead += count;
+
+	Isoline<K> isoline;
+	isoline.m_closed = closed != 0;
+	size_t remaining = 2 * static_cast<size_t>(count);
+	while (remaining > 0) {
+		size_t chunk = std::min(remaining, CHUNK_SIZE);
+		m_buffer.resize(chunk);
+		m_in.read(reinterpret_cast<char*>(m_buffer.data()), chunk * sizeof(double));
+		if (!m_in) {
+			throw std::runtime_error("Unexpected end of binary isoline file");
+		}
+		for (size_t i = 0; i + 1 < chunk; i += 2) {
+			isoline.m_points.emplace_back(m_buffer[i], m_buffer[i + 1]);
+		}
+		remaining -= chunk;
+	}
+	++m_read;
+	if (m_read == m_header.m_isolines && (m_verticesRead != m_header.m_vertices ||
+	                                      m_in.peek() != std::ifstream::traits_type::eof())) {
+		throw std::runtime_error("Binary isoline file contains data after its last isoline");
+	}
+	return isoline;
+}
+
+std::vector<Isoline<K>> BinaryIsolineReader::readAll() {
+	std::vector<Isoline<K>> isolines;
+	// The constructor checked the isoline count against the file size.
+	isolines.reserve(m_header.m_isolines - m_read);
+	while (auto isoline = next()) {
+		isolines.push_back(std::move(*isoline));
+	}
+	return isolines;
+}
+
+std::vector<Isoline<K>> binaryToIsolines(const std::filesystem::path& file) {
+	BinaryIsolineReader reader(file);
+	return reader.readAll();
+}
+
+void isolinesToBinary(const std::vector<Isoline<K>>& isolines, const std::filesystem::path& file) {
+	std::ofstream out(file, std::ios::binary);
+	if (!out) {
+		throw std::runtime_error("Cannot open " + file.string() + " for writing");
+	}
+
+	uint64_t vertices = 0;
+	Box bbox;
+	for (const auto& isoline : isolines) {
+		vertices += isoline.m_points.size();
+		for (const auto& p : isoline.m_points) {
+			bbox += p.bbox();
+		}
+	}
+
+	out.write(MAGIC, 8);
+	writeValue(out, static_cast<uint64_t>(isolines.size()));
+	writeValue(out, vertices);
+	writeValue(out, bbox.xmin());
+	writeValue(out, bbox.ymin());
+	writeValue(out, bbox.xmax());
+	writeValue(out, bbox.ymax());
+
+	for (const auto& isoline : isolines) {
+		writeValue(out, static_cast<uint64_t>(isoline.m_points.size()));
+		writeValue(out, static_cast<uint8_t>(isoline.m_closed ? 1 : 0));
+		for (const auto& p : isoline.m_points) {
+			writeValue(out, p.x());
+			writeValue(out, p.y());
+		}
+	}
+	if (!out) {
+		throw std::runtime_error("Failed to write binary isoline file " + file.string());
+	}
+}
+}
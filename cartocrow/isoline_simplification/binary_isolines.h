@@ -0,0 +1,88 @@
+/*
+The CartoCrow library implements algorithmic geo-visualization methods,
+developed at TU Eindhoven.
+Copyright (C) 2024 TU Eindhoven
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef CARTOCROW_BINARY_ISOLINES_H
+#define CARTOCROW_BINARY_ISOLINES_H
+
+#include "types.h"
+#include <filesystem>
+#include <fstream>
+
+namespace cartocrow::isoline_simplification {
+/// Summary of a binary isoline file, stored in its header such that it is available before reading any isolines.
+struct BinaryIsolineHeader {
+	/// The number of isolines in the file.
+	uint64_t m_isolines = 0;
+	/// The total number of vertices of all isolines in the file.
+	uint64_t m_vertices = 0;
+	/// The bounding box of all vertices in the file.
+	Box m_bbox;
+};
+
+/// Reads isolines one by one from a binary isoline file, without loading the whole file in memory.
+///
+/// A binary isoline file is meant for contour sets too large to read comfortably through Ipelib. All values are
+/// little-endian. The file starts with a header:
+/// - the 8-byte magic string `CCISOLN1`;
+/// - the number of isolines and the total number of vertices, as `uint64`;
+/// - the bounding box as `xmin ymin xmax ymax`, as `double`.
+///
+/// Then each isoline follows as its number of vertices (`uint64`), a byte that is 1 if the isoline is closed and 0
+/// otherwise, and the `x y` coordinates of its vertices (`double`).
+/// Such files can be written with \ref isolinesToBinary.
+///
+/// ```
+/// BinaryIsolineReader reader("contours.isolines");
+/// std::cout << reader.header().m_vertices << " vertices\n";
+/// while (auto isoline = reader.next()) {
+///     // ...
+/// }
+/// ```
+class BinaryIsolineReader {
+  public:
+	/// Opens the file and reads its header. Throws if the file cannot be read, is not a binary isoline file, or if
+	/// its size does not match the counts in the header.
+	explicit BinaryIsolineReader(const std::filesystem::path& file);
+	/// Returns the header of the file.
+	const BinaryIsolineHeader& header() const;
+	/// Reads the next isoline, or returns \c std::nullopt if all isolines have been read.
+	/// Throws if the isoline is inconsistent with the header, or if it is the last one and data follows it.
+	std::optional<Isoline<K>> next();
+	/// Reads all remaining isolines.
+	std::vector<Isoline<K>> readAll();
+
+  private:
+	std::ifstream m_in;
+	BinaryIsolineHeader m_header;
+	/// The number of isolines read so far.
+	uint64_t m_read = 0;
+	/// The number of vertices read so far.
+	uint64_t m_verticesRead = 0;
+	/// Buffer for coordinates, reused between isolines.
+	std::vector<double> m_buffer;
+};
+
+/// Reads all isolines from a binary isoline file; see \ref BinaryIsolineReader.
+std::vector<Isoline<K>> binaryToIsolines(const std::filesystem::path& file);
+/// Writes isolines to a binary isoline file; see \ref BinaryIsolineReader.
+void isolinesToBinary(const std::vector<Isoline<K>>& isolines, const std::filesystem::path& file);
+}
+
+#endif //CARTOCROW_BINARY_ISOLINES_H
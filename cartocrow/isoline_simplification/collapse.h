@@ -36,6 +36,9 @@ class SlopeLadder {
 	bool m_valid = true;
 	bool m_old = false;
 	bool m_intersects = false;
+	/// Whether the result of the topology check is cached in \ref m_topology_violation.
+	bool m_validated = false;
+	bool m_topology_violation = false;
 	void compute_cost(const PointToPoint& p_prev, const PointToPoint& p_next);
 };
 
@@ -0,0 +1,94 @@
+/*
+The CartoCrow library implements algorithmic geo-visualization methods,
+developed at TU Eindhoven.
+Copyright (C) 2024 TU Eindhoven
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "dyken_simplifier.h"
+#include <numeric>
+
+namespace cartocrow::isoline_simplification {
+typedef PS::Stop_below_count_threshold Stop;
+typedef PS::Hybrid_squared_distance_cost<K::FT> Cost;
+
+DykenSimplifier::DykenSimplifier(std::vector<Isoline<K>> isolines) : m_isolines(std::move(isolines)) {
+	build();
+}
+
+void DykenSimplifier::build() {
+	m_ct.clear();
+	m_ids.clear();
+	m_ids.reserve(m_isolines.size());
+	m_complexity = 0;
+
+	for (const auto& isoline : m_isolines) {
+		m_complexity += isoline.m_points.size();
+		if (isoline.m_closed) {
+			m_ids.push_back(m_ct.insert_constraint(isoline.polygon()));
+		} else {
+			m_ids.push_back(m_ct.insert_constraint(isoline.m_points.begin(), isoline.m_points.end()));
+		}
+	}
+}
+
+void DykenSimplifier::reset() {
+	build();
+}
+
+int DykenSimplifier::simplify(int target, double sep_dist) {
+	if (m_complexity <= target) return 0;
+	int removed = PS::simplify(m_ct, Cost(sep_dist), Stop(target));
+	m_complexity -= removed;
+	return removed;
+}
+
+std::vector<std::vector<Isoline<K>>> DykenSimplifier::simplify(std::vector<int> targets, double sep_dist) {
+	std::vector<size_t> order(targets.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::sort(order.begin(), order.end(), [&targets](size_t i, size_t j) {
+		return targets[i] > targets[j];
+	});
+
+	std::vector<std::vector<Isoline<K>>> results(targets.size());
+	for (size_t i : order) {
+		simplify(targets[i], sep_dist);
+		results[i] = isolines();
+	}
+	return results;
+}
+
+std::vector<Isoline<K>> DykenSimplifier::isolines() const {
+	std::vector<Isoline<K>> result;
+	result.reserve(m_isolines.size());
+
+	for (int i = 0; i < m_ids.size(); ++i) {
+		std::vector<Point<K>> simplified_points;
+		for (auto vit = m_ct.points_in_constraint_begin(m_ids[i]); vit != m_ct.points_in_constraint_end(m_ids[i]); ++vit) {
+			simplified_points.push_back(*vit);
+		}
+		if (m_isolines[i].m_closed) {
+			simplified_points.pop_back();
+		}
+		result.emplace_back(simplified_points, m_isolines[i].m_closed);
+	}
+	return result;
+}
+
+int DykenSimplifier::complexity() const {
+	return m_complexity;
+}
+}
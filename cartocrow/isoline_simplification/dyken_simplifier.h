@@ -0,0 +1,82 @@
+/*
+The CartoCrow library implements algorithmic geo-visualization methods,
+developed at TU Eindhoven.
+Copyright (C) 2024 TU Eindhoven
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef CARTOCROW_DYKEN_SIMPLIFIER_H
+#define CARTOCROW_DYKEN_SIMPLIFIER_H
+
+#include "types.h"
+#include <CGAL/Constrained_Delaunay_triangulation_2.h>
+#include <CGAL/Constrained_triangulation_plus_2.h>
+#include <CGAL/Polyline_simplification_2/simplify.h>
+
+namespace cartocrow::isoline_simplification {
+namespace PS = CGAL::Polyline_simplification_2;
+
+/// Simplifies isolines with the CGAL implementation of the method of Dyken et al.
+///
+/// The constrained triangulation with constraint hierarchy is built once on construction. Every call to
+/// \ref simplify continues from the result of the previous call, so a sequence of decreasing targets is evaluated in
+/// a single pass:
+/// ```
+/// DykenSimplifier simplifier(isolines);
+/// auto results = simplifier.simplify(std::vector<int>({1000, 500, 100}), 1.0);
+/// ```
+/// Simplifying to a higher complexity than the current one requires a \ref reset.
+class DykenSimplifier {
+  public:
+	typedef PS::Vertex_base_2<K> Vb;
+	typedef CGAL::Constrained_triangulation_face_base_2<K> Fb;
+	typedef CGAL::Triangulation_data_structure_2<Vb, Fb> TDS;
+	typedef CGAL::Constrained_Delaunay_triangulation_2<K, TDS, CGAL::Exact_predicates_tag> CDT;
+	typedef CGAL::Constrained_triangulation_plus_2<CDT> CT;
+
+	/// Builds the constrained triangulation of the given isolines.
+	explicit DykenSimplifier(std::vector<Isoline<K>> isolines);
+
+	/// Removes vertices until the number of vertices is at or below the target, or no vertex can be removed.
+	/// The parameter \c sep_dist is the ratio of the hybrid squared distance cost.
+	/// Returns the number of removed vertices.
+	int simplify(int target, double sep_dist = 1);
+	/// Simplifies to each of the targets in turn, in decreasing order, and returns the simplified isolines for each
+	/// target in the order in which the targets were given.
+	std::vector<std::vector<Isoline<K>>> simplify(std::vector<int> targets, double sep_dist = 1);
+	/// Restores the isolines given on construction by rebuilding the triangulation.
+	void reset();
+
+	/// Returns the current simplified isolines, in the same order as the input isolines.
+	std::vector<Isoline<K>> isolines() const;
+	/// Returns the number of vertices of the current simplified isolines.
+	int complexity() const;
+
+  private:
+	void build();
+
+	/// The input isolines.
+	std::vector<Isoline<K>> m_isolines;
+	/// The constrained triangulation with the simplified isolines as constraints.
+	CT m_ct;
+	/// The constraint of each input isoline.
+	std::vector<CT::Constraint_id> m_ids;
+	/// The number of vertices of the current simplified isolines.
+	int m_complexity = 0;
+};
+}
+
+#endif //CARTOCROW_DYKEN_SIMPLIFIER_H
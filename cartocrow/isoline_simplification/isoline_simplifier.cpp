@@ -21,28 +21,18 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include "collapse.h"
 #include "symmetric_difference.h"
 #include "voronoi_helpers.h"
+#include "../core/profiler.h"
 #include <CGAL/Arr_conic_traits_2.h>
 #include <CGAL/CORE_algebraic_number_traits.h>
 #include <CGAL/Cartesian.h>
 
-#include <CGAL/Constrained_Delaunay_triangulation_2.h>
-#include <CGAL/Constrained_triangulation_plus_2.h>
-#include <CGAL/Polyline_simplification_2/simplify.h>
-
+#include <atomic>
+#include <future>
+#include <thread>
 #include <utility>
 #include "ipe_bezier_wrapper.h"
 
 namespace cartocrow::isoline_simplification {
-namespace PS = CGAL::Polyline_simplification_2;
-typedef PS::Stop_below_count_threshold Stop;
-typedef PS::Hybrid_squared_distance_cost<K::FT>      Cost;
-
-typedef PS::Vertex_base_2<K> Vb;
-typedef CGAL::Constrained_triangulation_face_base_2<K> Fb;
-typedef CGAL::Triangulation_data_structure_2<Vb, Fb> TDS;
-typedef CGAL::Constrained_Delaunay_triangulation_2<K, TDS, CGAL::Exact_predicates_tag> CDT;
-typedef CGAL::Constrained_triangulation_plus_2<CDT>     CT;
-
 IsolineSimplifier::IsolineSimplifier(std::vector<Isoline<K>> isolines, std::shared_ptr<LadderCollapse> collapse,
                                      double angle_filter, double alignment_filter):
       m_isolines(std::move(isolines)), m_angle_filter(angle_filter), m_alignment_filter(alignment_filter), m_collapse_ladder(std::move(collapse)) {
@@ -53,6 +43,8 @@ IsolineSimplifier::IsolineSimplifier(std::vector<Isoline<K>> isolines, std::shar
 	m_separator = medial_axis_separator(m_delaunay, m_p_isoline, m_p_prev, m_p_next);
 	m_matching = matching(m_delaunay, m_separator, m_p_prev, m_p_next, m_p_isoline, m_p_vertex, m_angle_filter, m_alignment_filter);
 	initialize_slope_ladders();
+	initialize_alignment();
+	m_metrics_history.push_back(metrics());
 }
 
 void IsolineSimplifier::initialize_point_data() {
@@ -94,6 +86,7 @@ void IsolineSimplifier::initialize_sdg() {
 		std::copy(polyline.edges_begin(), polyline.edges_end(), std::back_inserter(segments));
 	}
 	m_delaunay.insert_segments(segments.begin(), segments.end());
+	m_edge_index.assign(segments);
 
 	for (auto vit = m_delaunay.finite_vertices_begin(); vit != m_delaunay.finite_vertices_end(); vit++) {
 		auto site = vit->site();
@@ -121,38 +114,12 @@ bool IsolineSimplifier::dyken_simplify(int target, double sep_dist) {
 	m_started = true;
 	int start_complexity = m_current_complexity;
 
-	CT ct;
-
-	std::vector<CT::Constraint_id> ids;
-
-	for (const auto& isoline : m_simplified_isolines) {
-		if (isoline.m_closed) {
-			CT::Constraint_id id = ct.insert_constraint(isoline.polygon());
-			ids.push_back(id);
-		} else {
-			CT::Constraint_id id = ct.insert_constraint(isoline.m_points);
-			ids.push_back(id);
-		}
-	}
-
-	std::vector<Isoline<K>> result(m_simplified_isolines.size());
-
-	m_current_complexity -= PS::simplify(ct, Cost(sep_dist), Stop(target));
-	for(auto cit = ct.constraints_begin(); cit != ct.constraints_end(); ++cit) {
-		CT::Constraint_id id = *cit;
-		auto i = std::distance(ids.begin(), std::find(ids.begin(), ids.end(), id));
-
-		std::vector<Point<K>> simplified_points;
-		for (auto vit = ct.points_in_constraint_begin(*cit); vit != ct.points_in_constraint_end(*cit); ++vit) {
-			simplified_points.push_back(*vit);
-		}
-		if (m_simplified_isolines[i].m_closed) {
-			simplified_points.pop_back();
-		}
-		result[i] = Isoline<K>(simplified_points, m_simplified_isolines[i].m_closed);
+	// The triangulation is only built on the first call; later calls continue simplifying it.
+	if (!m_dyken) {
+		m_dyken = std::make_unique<DykenSimplifier>(m_simplified_isolines);
 	}
-
-	m_simplified_isolines = result;
+	m_current_complexity -= m_dyken->simplify(target, sep_dist);
+	m_simplified_isolines = m_dyken->isolines();
 
 	return start_complexity != m_current_complexity;
 }
@@ -176,6 +143,7 @@ void IsolineSimplifier::collapse_ladder(SlopeLadder& ladder) {
 
 	auto delaunay_remove_p = [&insert_adj, this](const Point<K>& p) {
 	 	auto vertex = m_p_vertex.at(p);
+	 	invalidate_validations(vertex);
 	 	insert_adj(vertex);
 	  	m_changed_vertices.erase(vertex);
 	  	m_deleted_points.push_back(p);
@@ -197,6 +165,7 @@ void IsolineSimplifier::collapse_ladder(SlopeLadder& ladder) {
 		}
 	    auto seg_vertex = m_e_vertex.at(seg);
 
+	    invalidate_validations(seg_vertex);
 	    insert_adj(seg_vertex);
 
 	  	m_changed_vertices.erase(seg_vertex);
@@ -272,6 +241,16 @@ void IsolineSimplifier::collapse_ladder(SlopeLadder& ladder) {
 		const Segment<K> st = Segment<K>(s, t);
 		const Segment<K> uv = Segment<K>(u, v);
 
+		m_edge_index.remove(st);
+		m_edge_index.remove(Segment<K>(t, u));
+		m_edge_index.remove(uv);
+		m_edge_index.insert(Segment<K>(s, new_point));
+		m_edge_index.insert(Segment<K>(new_point, v));
+
+		double collapse_cost = symmetric_difference(s, t, u, v, new_point);
+		m_collapse_symmetric_difference += collapse_cost;
+		m_max_collapse_symmetric_difference = std::max(m_max_collapse_symmetric_difference, collapse_cost);
+
 		auto t_it = m_p_iterator.at(t);
 		auto u_it = m_p_iterator.at(u);
 		Isoline<K>* t_iso = m_p_isoline.at(t);
@@ -335,6 +314,7 @@ void IsolineSimplifier::collapse_ladder(SlopeLadder& ladder) {
 				for (const auto& l : m_e_intersects.at(seg)) {
 					if (!l->m_old) {
 						l->m_intersects = false;
+						l->m_validated = false;
 						l->compute_cost(m_p_prev, m_p_next);
 						m_slope_ladders.increase(m_ladder_heap_handle.at(l));
 					}
@@ -453,6 +433,27 @@ void IsolineSimplifier::update_matching() {
 		for (const auto& sign : to_remove_s)
 			m_matching[pt].erase(sign);
 	}
+
+	// Alignments of pairs involving a changed point have to be recomputed for both points of the pair.
+	std::unordered_set<Point<K>> alignment_points(updated_points.begin(), updated_points.end());
+	alignment_points.insert(modified_matchings.begin(), modified_matchings.end());
+	alignment_points.insert(m_deleted_points.begin(), m_deleted_points.end());
+	std::vector<Point<K>> partners;
+	for (const auto& p : alignment_points) {
+		if (!m_matching.contains(p)) continue;
+		for (const auto& [_, mi] : m_matching.at(p))
+			for (const auto& [_, pts] : mi)
+				partners.insert(partners.end(), pts.begin(), pts.end());
+	}
+	alignment_points.insert(partners.begin(), partners.end());
+	update_alignment(alignment_points);
+
+	// The step that changed the matching recorded its metrics before the alignment was updated.
+	if (!m_metrics_history.empty()) {
+		SimplificationMetrics current = metrics();
+		m_metrics_history.back().m_average_alignment = current.m_average_alignment;
+		m_metrics_history.back().m_max_alignment = current.m_max_alignment;
+	}
 }
 
 void IsolineSimplifier::update_ladders() {
@@ -566,6 +567,11 @@ void IsolineSimplifier::update_ladders() {
 	}
 }
 
+void IsolineSimplifier::set_batch_size(int batch_size, int threads) {
+	m_batch_size = std::max(batch_size, 1);
+	m_batch_threads = std::max(threads, 0);
+}
+
 // same as next_ladder() but does not pop the next ladder from the heap.
 std::optional<std::shared_ptr<SlopeLadder>> IsolineSimplifier::get_next_ladder() {
 	if (m_slope_ladders.empty())
@@ -649,17 +655,10 @@ std::optional<std::shared_ptr<SlopeLadder>> IsolineSimplifier::next_ladder() {
 	bool found = false;
 
 	do {
-		bool old_but_not_correctly_updated = false;
-
-		for (const auto& rung : current->m_rungs) {
-			old_but_not_correctly_updated |= !m_p_iterator.contains(rung.source());
-			old_but_not_correctly_updated |= !m_p_iterator.contains(rung.target());
-		}
-
 		if (current->m_old) {
 			m_ladder_heap_handle.erase(current);
 			m_slope_ladders.pop();
-		} else if (old_but_not_correctly_updated) {
+		} else if (incorrectly_updated(*current)) {
 			std::cerr << "Incorrectly updated" << std::endl;
 			m_ladder_heap_handle.erase(current);
 			m_slope_ladders.pop();
@@ -669,21 +668,11 @@ std::optional<std::shared_ptr<SlopeLadder>> IsolineSimplifier::next_ladder() {
 			m_ladder_heap_handle.erase(current);
 			m_slope_ladders.pop();
 		}
-		else if (IntersectionResult ir = check_ladder_intersections_Voronoi(*current)) {
-			auto irv = *ir;
-			// self-intersects
-			if (holds_alternative<std::monostate>(irv)) {
-			} else { // intersects another segment
-				Segment<K> intersected = std::get<Segment<K>>(irv);
-				m_e_intersects[intersected].push_back(current);
-			}
-			current->m_intersects = true;
-			current->m_cost = std::numeric_limits<double>::infinity();
-			temp.push_back(current);
-			m_ladder_heap_handle.erase(current);
-			m_slope_ladders.pop();
+		else if (!current->m_validated) {
+			// Validates current and the next cheapest ladders; this may reorder the heap so current is recomputed.
+			validate_ladders(m_batch_size);
 		}
-		else if (check_ladder_collapse_topology(*current)) {
+		else if (current->m_topology_violation) {
 			temp.push_back(current);
 			m_ladder_heap_handle.erase(current);
 			m_slope_ladders.pop();
@@ -717,6 +706,7 @@ std::optional<std::shared_ptr<SlopeLadder>> IsolineSimplifier::next_ladder() {
 }
 
 bool IsolineSimplifier::step() {
+	ProfileZone zone("IsolineSimplifier::step");
 	m_started = true;
 
 	auto next = next_ladder();
@@ -726,12 +716,111 @@ bool IsolineSimplifier::step() {
 	m_changed_vertices.clear();
 	m_deleted_points.clear();
 	collapse_ladder(*slope_ladder);
+	Profiler::count("collapsed ladders");
+	// A collapse changes the simplified isolines behind the back of the Dyken simplifier.
+	m_dyken.reset();
+	for (const auto& vh : m_changed_vertices) {
+		invalidate_validations(vh);
+	}
 
 	slope_ladder->m_old = true;
+	m_metrics_history.push_back(metrics());
 
 	return true;
 }
 
+bool IsolineSimplifier::incorrectly_updated(const SlopeLadder& ladder) const {
+	for (const auto& rung : ladder.m_rungs) {
+		if (!m_p_iterator.contains(rung.source()) || !m_p_iterator.contains(rung.target())) {
+			return true;
+		}
+	}
+	return false;
+}
+
+LadderValidation IsolineSimplifier::validate_ladder(const SlopeLadder& ladder) const {
+	ProfileZone zone("IsolineSimplifier::validate_ladder");
+	LadderValidation validation;
+	validation.m_intersection = check_ladder_intersections_Voronoi(ladder, &validation.m_touched);
+	if (m_verify_intersections && check_ladder_intersections_naive(ladder) != validation.m_intersection.has_value()) {
+		std::cerr << "Voronoi and naive intersection checks disagree on ladder with rung "
+		          << ladder.m_rungs.front() << std::endl;
+	}
+	if (!validation.m_intersection.has_value()) {
+		validation.m_topology_violation = check_ladder_collapse_topology(ladder, &validation.m_touched);
+	}
+	return validation;
+}
+
+void IsolineSimplifier::validate_ladders(int count) {
+	std::vector<std::shared_ptr<SlopeLadder>> batch;
+	for (auto it = m_slope_ladders.ordered_begin(); it != m_slope_ladders.ordered_end(); ++it) {
+		if (batch.size() >= static_cast<size_t>(std::max(count, 1))) break;
+		const auto& ladder = *it;
+		// Non-valid slope ladders have very high cost so no ladders to validate are left
+		if (!ladder->m_valid) break;
+		if (ladder->m_old || ladder->m_intersects || ladder->m_validated || incorrectly_updated(*ladder)) continue;
+		batch.push_back(ladder);
+	}
+
+	// The checks only read the Delaunay graph and the point data, so the batch can be validated concurrently.
+	// A bounded number of workers take ladders from the batch in turn.
+	std::vector<LadderValidation> validations(batch.size());
+	int threads = m_batch_threads > 0 ? m_batch_threads : static_cast<int>(std::thread::hardware_concurrency());
+	threads = std::min(std::max(threads, 1), static_cast<int>(batch.size()));
+	if (threads <= 1) {
+		for (int i = 0; i < batch.size(); i++) {
+			validations[i] = validate_ladder(*batch[i]);
+		}
+	} else {
+		std::atomic<int> next = 0;
+		auto work = [this, &batch, &validations, &next]() {
+			for (int i = next++; i < batch.size(); i = next++) {
+				validations[i] = validate_ladder(*batch[i]);
+			}
+		};
+		std::vector<std::future<void>> workers;
+		for (int t = 1; t < threads; t++) {
+			workers.push_back(std::async(std::launch::async, work));
+		}
+		work();
+		for (auto& worker : workers) {
+			worker.get();
+		}
+	}
+
+	for (int i = 0; i < batch.size(); i++) {
+		auto& ladder = batch[i];
+		auto& validation = validations[i];
+		if (validation.m_intersection.has_value()) {
+			auto irv = *validation.m_intersection;
+			// self-intersects
+			if (holds_alternative<std::monostate>(irv)) {
+			} else { // intersects another segment
+				Segment<K> intersected = std::get<Segment<K>>(irv);
+				m_e_intersects[intersected].push_back(ladder);
+			}
+			ladder->m_intersects = true;
+			ladder->m_cost = std::numeric_limits<double>::infinity();
+			m_slope_ladders.update(m_ladder_heap_handle.at(ladder));
+			continue;
+		}
+		ladder->m_validated = true;
+		ladder->m_topology_violation = validation.m_topology_violation;
+		for (const auto& vh : validation.m_touched) {
+			m_v_validated[vh].push_back(ladder);
+		}
+	}
+}
+
+void IsolineSimplifier::invalidate_validations(SDG2::Vertex_handle vertex) {
+	if (!m_v_validated.contains(vertex)) return;
+	for (const auto& ladder : m_v_validated.at(vertex)) {
+		ladder->m_validated = false;
+	}
+	m_v_validated.erase(vertex);
+}
+
 void IsolineSimplifier::create_slope_ladder(Segment<K> seg) {
 	if (m_e_ladder.contains(seg) &&
 	        std::any_of(m_e_ladder.at(seg).begin(), m_e_ladder.at(seg).end(), [](const auto& l) { return !l->m_old; }) ||
@@ -936,6 +1025,8 @@ bool IsolineSimplifier::check_ladder_intersections_naive(const SlopeLadder& ladd
 	assert(ladder.m_valid && !ladder.m_old);
 	std::unordered_set<Segment<K>> edges_to_skip;
 	std::vector<Segment<K>> new_edges;
+	// The endpoint of each new edge that it shares with an unchanged edge
+	std::vector<Point<K>> new_edges_fixed;
 
 	for (int i = 0; i < ladder.m_rungs.size(); i++) {
 		const auto& rung = ladder.m_rungs.at(i);
@@ -953,33 +1044,21 @@ bool IsolineSimplifier::check_ladder_intersections_naive(const SlopeLadder& ladd
 		edges_to_skip.insert(uv);
 
 		const auto& p = ladder.m_collapsed.at(i);
-		const auto sp = Segment<K>(s, p);
-		const auto pv = Segment<K>(p, v);
-		new_edges.push_back(sp);
-		new_edges.push_back(pv);
+		new_edges.emplace_back(s, p);
+		new_edges_fixed.push_back(s);
+		new_edges.emplace_back(p, v);
+		new_edges_fixed.push_back(v);
 	}
 
-	for (const auto& isoline : m_simplified_isolines) {
-		auto polyline = isoline.polyline();
-		for (auto eit = polyline.edges_begin(); eit != polyline.edges_end(); eit++) {
-			const auto& edge = *eit;
+	// Only edges whose bounding box overlaps that of a new edge can intersect it
+	for (int i = 0; i < new_edges.size(); i++) {
+		const auto& new_edge = new_edges[i];
+		const auto& fixed = new_edges_fixed[i];
+		for (const auto& edge : m_edge_index.nearby(new_edge)) {
 			if (edges_to_skip.contains(edge)) continue;
-			for (int i = 0; i < ladder.m_rungs.size(); i++) {
-				const auto& rung = ladder.m_rungs.at(i);
-				const auto& p = ladder.m_collapsed.at(i);
-				bool reversed = m_p_next.at(rung.target()) == rung.source();
-				const auto& t = reversed ? rung.target() : rung.source();
-				const auto& u = reversed ? rung.source() : rung.target();
-				const auto& s = m_p_prev.at(t);
-				const auto& v = m_p_next.at(u);
-				const auto sp = Segment<K>(s, p);
-				const auto pv = Segment<K>(p, v);
-				auto spi = intersection(sp, edge);
-				auto pvi = intersection(pv, edge);
-				if (spi.has_value() && !(spi->type() == typeid(Point<K>) && boost::get<Point<K>>(*spi) == s) ||
-				    pvi.has_value() && !(pvi->type() == typeid(Point<K>) && boost::get<Point<K>>(*pvi) == v))
-					return true;
-			}
+			auto inters = intersection(new_edge, edge);
+			if (inters.has_value() && !(inters->type() == typeid(Point<K>) && boost::get<Point<K>>(*inters) == fixed))
+				return true;
 		}
 	}
 
@@ -1000,7 +1079,8 @@ bool IsolineSimplifier::check_ladder_intersections_naive(const SlopeLadder& ladd
 	return false;
 }
 
-IntersectionResult IsolineSimplifier::check_ladder_intersections_Voronoi(const SlopeLadder& ladder) {
+IntersectionResult IsolineSimplifier::check_ladder_intersections_Voronoi(const SlopeLadder& ladder,
+                                                                          std::unordered_set<SDG2::Vertex_handle>* touched) const {
 	assert(ladder.m_valid && !ladder.m_old);
 	std::unordered_set<SDG2::Vertex_handle> edges_to_skip;
 	std::vector<Segment<K>> new_edges;
@@ -1046,14 +1126,14 @@ IntersectionResult IsolineSimplifier::check_ladder_intersections_Voronoi(const S
 		if (squared_distance(st.supporting_line(), p) < 1E-9) {
 			st_coll = m_e_vertex.at(st);
 		}
-		auto spi = check_segment_intersections_Voronoi(m_delaunay, sp, m_p_vertex.at(s), edges_to_skip, st_coll);
+		auto spi = check_segment_intersections_Voronoi(m_delaunay, sp, m_p_vertex.at(s), edges_to_skip, st_coll, touched);
 		if (spi.has_value()) return spi;
 
 		std::optional<SDG2::Vertex_handle> uv_coll;
 		if (squared_distance(uv.supporting_line(), p) < 1E-9) {
 			uv_coll = m_e_vertex.at(uv);
 		}
-		auto pvi = check_segment_intersections_Voronoi(m_delaunay, pv, m_p_vertex.at(v), edges_to_skip, uv_coll);
+		auto pvi = check_segment_intersections_Voronoi(m_delaunay, pv, m_p_vertex.at(v), edges_to_skip, uv_coll, touched);
 		if (pvi.has_value()) return pvi;
 	}
 
@@ -1124,7 +1204,7 @@ std::vector<Point<K>> intersections_primal(Segment<K> seg, const CGAL::Object& o
 }
 
 std::unordered_set<SDG2::Vertex_handle>
-IsolineSimplifier::intersected_region(Segment<K> rung, Point<K> p) {
+IsolineSimplifier::intersected_region(Segment<K> rung, Point<K> p) const {
 	bool reversed = m_p_next.contains(rung.target()) && m_p_next.at(rung.target()) == rung.source();
 	Point<K> t = reversed ? rung.target() : rung.source();
 	Point<K> u = reversed ? rung.source() : rung.target();
@@ -1276,7 +1356,8 @@ IsolineSimplifier::boundaries(const std::unordered_set<SDG2::Vertex_handle>& reg
 	}
 }
 
-bool IsolineSimplifier::check_ladder_collapse_topology(const SlopeLadder& ladder) {
+bool IsolineSimplifier::check_ladder_collapse_topology(const SlopeLadder& ladder,
+                                                       std::unordered_set<SDG2::Vertex_handle>* touched) const {
 	std::unordered_set<Point<K>> points_to_skip;
 
 	for (int i = 0; i < ladder.m_rungs.size(); i++) {
@@ -1286,14 +1367,15 @@ bool IsolineSimplifier::check_ladder_collapse_topology(const SlopeLadder& ladder
 	}
 
 	for (int i = 0; i < ladder.m_rungs.size(); i++) {
-		if (check_rung_collapse_topology(ladder.m_rungs[i], ladder.m_collapsed[i], points_to_skip)) {
+		if (check_rung_collapse_topology(ladder.m_rungs[i], ladder.m_collapsed[i], points_to_skip, touched)) {
 			return true;
 		}
 	}
 	return false;
 }
 
-bool IsolineSimplifier::check_rung_collapse_topology(Segment<K> rung, Point<K> p, std::unordered_set<Point<K>>& allowed) {
+bool IsolineSimplifier::check_rung_collapse_topology(Segment<K> rung, Point<K> p, std::unordered_set<Point<K>>& allowed,
+                                                     std::unordered_set<SDG2::Vertex_handle>* touched) const {
 	auto problem_vertex = [&](SDG2::Vertex_handle vh) {
 		if (vh->is_segment()) return false;
 		auto x = vh->site().point();
@@ -1325,7 +1407,21 @@ bool IsolineSimplifier::check_rung_collapse_topology(Segment<K> rung, Point<K> p
 		return false;
 	};
 
+	// The result depends on the Delaunay vertices that are inspected and on their neighbors
+	auto touch_with_neighbors = [this, &touched](SDG2::Vertex_handle vh) {
+		if (touched == nullptr) return;
+		touched->insert(vh);
+		auto vit_start = m_delaunay.incident_vertices(vh);
+		auto vit = vit_start;
+		do {
+			touched->insert(vit);
+		} while (++vit != vit_start);
+	};
+
 	auto region = intersected_region(rung, p);
+	for (const auto& vh : region) {
+		touch_with_neighbors(vh);
+	}
 	auto [boundaries_edges, outer] = boundaries(region);
 	if (boundaries_edges.size() <= 1) return false;
 	for (int i = 0; i < boundaries_edges.size(); ++i) {
@@ -1348,6 +1444,7 @@ bool IsolineSimplifier::check_rung_collapse_topology(Segment<K> rung, Point<K> p
 
 			if (visited.contains(vh)) continue;
 			visited.insert(vh);
+			touch_with_neighbors(vh);
 
 			if (problem_vertex(vh)) {
 				return true;
@@ -1370,6 +1467,77 @@ bool IsolineSimplifier::check_rung_collapse_topology(Segment<K> rung, Point<K> p
 	return false;
 }
 
+void IsolineSimplifier::initialize_alignment() {
+	m_p_alignment.clear();
+	m_alignment_maxima.clear();
+	m_alignment_total = 0.0;
+	m_alignment_count = 0;
+
+	std::unordered_set<Point<K>> points;
+	for (const auto& [p, _] : m_matching) {
+		points.insert(p);
+	}
+	update_alignment(points);
+}
+
+AlignmentContribution IsolineSimplifier::point_alignment(const Point<K>& u) const {
+	AlignmentContribution contribution;
+	if (!m_matching.contains(u) || !m_p_isoline.contains(u)) return contribution;
+
+	for (const auto& [sign_u, mi] : m_matching.at(u)) {
+		for (const auto& [_, vs] : mi) {
+			for (const auto& v : vs) {
+				if (!m_matching.contains(v) || !m_p_isoline.contains(v)) continue;
+				// Unlike average_max_vertex_alignment(), pairs that are (temporarily) matched one way only are skipped.
+				std::optional<CGAL::Sign> sign_v;
+				for (CGAL::Sign possible_sign_v : {CGAL::LEFT_TURN, CGAL::RIGHT_TURN}) {
+					if (!m_matching.at(v).contains(possible_sign_v)) continue;
+					for (const auto& [_, pts] : m_matching.at(v).at(possible_sign_v))
+						if (std::find(pts.begin(), pts.end(), u) != pts.end())
+							sign_v = possible_sign_v;
+				}
+				if (!sign_v.has_value()) continue;
+
+				double alignment = vertex_alignment(m_p_prev, m_p_next, u, v, sign_u, *sign_v);
+				contribution.m_max = std::max(contribution.m_max, alignment);
+				contribution.m_total += alignment;
+				contribution.m_count += 1;
+			}
+		}
+	}
+	return contribution;
+}
+
+void IsolineSimplifier::update_alignment(const std::unordered_set<Point<K>>& points) {
+	for (const auto& p : points) {
+		if (m_p_alignment.contains(p)) {
+			const auto& old = m_p_alignment.at(p);
+			m_alignment_total -= old.m_total;
+			m_alignment_count -= old.m_count;
+			m_alignment_maxima.erase(m_alignment_maxima.find(old.m_max));
+			m_p_alignment.erase(p);
+		}
+		auto contribution = point_alignment(p);
+		if (contribution.m_count == 0) continue;
+		m_alignment_total += contribution.m_total;
+		m_alignment_count += contribution.m_count;
+		m_alignment_maxima.insert(contribution.m_max);
+		m_p_alignment[p] = contribution;
+	}
+}
+
+SimplificationMetrics IsolineSimplifier::metrics() const {
+	SimplificationMetrics metrics;
+	metrics.m_complexity = m_current_complexity;
+	metrics.m_symmetric_difference = m_collapse_symmetric_difference;
+	metrics.m_max_collapse_symmetric_difference = m_max_collapse_symmetric_difference;
+	if (m_alignment_count > 0) {
+		metrics.m_average_alignment = m_alignment_total / m_alignment_count;
+		metrics.m_max_alignment = *m_alignment_maxima.rbegin();
+	}
+	return metrics;
+}
+
 double IsolineSimplifier::total_symmetric_difference() const {
 	double total = 0;
 	for (int i = 0; i < m_isolines.size(); i++) {
@@ -1432,6 +1600,15 @@ void IsolineSimplifier::clear() {
 	m_separator.clear();
 	m_matching.clear();
 	m_slope_ladders.clear();
+	m_v_validated.clear();
+	m_dyken.reset();
+	m_p_alignment.clear();
+	m_alignment_maxima.clear();
+	m_alignment_total = 0.0;
+	m_alignment_count = 0;
+	m_collapse_symmetric_difference = 0.0;
+	m_max_collapse_symmetric_difference = 0.0;
+	m_metrics_history.clear();
 }
 
 int IsolineSimplifier::ladder_count() {
@@ -1442,6 +1619,8 @@ int IsolineSimplifier::ladder_count() {
 	m_matching = matching(m_delaunay, m_separator, m_p_prev, m_p_next, m_p_isoline, m_p_vertex,
 	                     m_angle_filter, m_alignment_filter);
 	initialize_slope_ladders();
+	initialize_alignment();
+	m_metrics_history.push_back(metrics());
 	return m_slope_ladders.size();
 }
 }
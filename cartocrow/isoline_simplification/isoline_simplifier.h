@@ -20,10 +20,13 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #ifndef CARTOCROW_ISOLINE_SIMPLIFICATION_H
 #define CARTOCROW_ISOLINE_SIMPLIFICATION_H
 #include "collapse.h"
+#include "dyken_simplifier.h"
 #include "isoline.h"
+#include "segment_index.h"
 #include "types.h"
 #include "voronoi_helpers.h"
 #include <boost/heap/d_ary_heap.hpp>
+#include <set>
 
 namespace cartocrow::isoline_simplification {
 struct slope_ladder_comp {
@@ -37,6 +40,39 @@ typedef std::optional<std::variant<Segment<K>, std::monostate>> IntersectionResu
 typedef boost::heap::d_ary_heap<std::shared_ptr<SlopeLadder>, boost::heap::arity<2>, boost::heap::compare<slope_ladder_comp>, boost::heap::mutable_<true>> Heap;
 typedef std::unordered_map<std::shared_ptr<SlopeLadder>, Heap::handle_type> LadderToHandle;
 
+/// Quality measures of a simplification, maintained incrementally by \ref IsolineSimplifier.
+struct SimplificationMetrics {
+	/// The number of vertices of the simplification.
+	int m_complexity = 0;
+	/// The sum of the symmetric differences of all rung collapses performed so far.
+	/// Each collapse is measured with respect to the simplification it was applied to, so this is an upper bound on
+	/// \ref IsolineSimplifier::total_symmetric_difference.
+	double m_symmetric_difference = 0.0;
+	/// The largest symmetric difference of a single rung collapse performed so far.
+	double m_max_collapse_symmetric_difference = 0.0;
+	/// The average vertex alignment of the current matching.
+	double m_average_alignment = 0.0;
+	/// The maximum vertex alignment of the current matching.
+	double m_max_alignment = 0.0;
+};
+
+/// The vertex alignments of the matching of one point; see \ref IsolineSimplifier::m_p_alignment.
+struct AlignmentContribution {
+	double m_total = 0.0;
+	double m_max = 0.0;
+	int m_count = 0;
+};
+typedef std::unordered_map<Point<K>, AlignmentContribution> PointToAlignment;
+
+/// The result of validating a slope ladder against the current segment Delaunay graph.
+struct LadderValidation {
+	IntersectionResult m_intersection;
+	bool m_topology_violation = false;
+	/// The Delaunay vertices the result depends on; the result remains correct as long as none of these change.
+	std::unordered_set<SDG2::Vertex_handle> m_touched;
+};
+typedef std::unordered_map<SDG2::Vertex_handle, std::vector<std::shared_ptr<SlopeLadder>>> VertexToSlopeLadders;
+
 /// An algorithm that simplifies isolines simultaneously such that common features are maintained.
 ///
 /// \image html harmonious-simplification.svg
@@ -97,10 +133,18 @@ class IsolineSimplifier {
 	/// exists that preserves topology.
 	bool simplify(int target, bool debug = false);
 	/// A convenience function that simplifies isolines using the CGAL implementation of the method of Dyken et al.
-	/// This does perform the redundant preprocessing step of computing slope ladders so it is not the most efficient.
+	/// This does perform the redundant preprocessing step of computing slope ladders so it is not the most efficient;
+	/// use \ref DykenSimplifier directly to avoid it.
+	/// The constrained triangulation is built on the first call and reused by subsequent calls, until \ref step
+	/// modifies the simplified isolines.
 	bool dyken_simplify(int target, double sep_dist = 1);
 	// Perform one simplification step; returns whether there was progress.
 	bool step();
+	/// Sets the number of cheapest slope ladders that are validated together when the next ladder is needed, and the
+	/// number of threads that validate them; 0 threads uses the hardware concurrency.
+	/// Larger batches only pay off on inputs where validation dominates the running time. The simplification does
+	/// not depend on these settings.
+	void set_batch_size(int batch_size, int threads = 0);
 	/// Gets the next ladder that will be simplified (only for debugging purposes).
 	std::optional<std::shared_ptr<SlopeLadder>> get_next_ladder();
 
@@ -131,6 +175,9 @@ class IsolineSimplifier {
 	EdgeToSlopeLadders m_e_intersects;
 	/// The segment Delaunay graph
 	SDG2 m_delaunay;
+	/// Spatial index on the edges of the simplified isolines, used by \ref check_ladder_intersections_naive.
+	/// Each edge is stored oriented from a point to its next point.
+	SegmentIndex m_edge_index;
 	/// The medial axis separator. Note that this is not updated after initialization.
 	Separator m_separator;
 	/// The matching from which slope ladders are derived.
@@ -147,16 +194,55 @@ class IsolineSimplifier {
 	double m_alignment_filter;
 	/// The method used to collapse slope ladders.
 	std::shared_ptr<LadderCollapse> m_collapse_ladder;
+	/// The simplifier used by \ref dyken_simplify, if it has been called since the last step.
+	std::unique_ptr<DykenSimplifier> m_dyken;
+	/// The number of cheapest slope ladders that are validated concurrently when the next ladder is needed.
+	/// Validation results are cached, so ladders of a batch that are not collapsed in this step are usually not
+	/// validated again in later steps. A batch size of 1 validates on the calling thread. See \ref set_batch_size.
+	int m_batch_size = 1;
+	/// The maximum number of threads that validate a batch; 0 uses the hardware concurrency.
+	int m_batch_threads = 0;
+	/// Maps a Delaunay vertex to the slope ladders whose cached validation depends on it.
+	VertexToSlopeLadders m_v_validated;
+	/// Whether every Voronoi-based intersection check is cross-checked with \ref check_ladder_intersections_naive.
+	/// Disagreements are reported on \c std::cerr.
+	bool m_verify_intersections = false;
+	/// The running sum of the symmetric differences of performed rung collapses.
+	double m_collapse_symmetric_difference = 0.0;
+	/// The largest symmetric difference of a performed rung collapse.
+	double m_max_collapse_symmetric_difference = 0.0;
+	/// Maps a point to the vertex alignments of its matched pairs.
+	PointToAlignment m_p_alignment;
+	/// The maximum alignment of each point in \ref m_p_alignment; its last element is the maximum alignment.
+	std::multiset<double> m_alignment_maxima;
+	/// The sum of all alignments in \ref m_p_alignment.
+	double m_alignment_total = 0.0;
+	/// The number of matched pairs in \ref m_p_alignment.
+	int m_alignment_count = 0;
 	bool check_ladder_intersections_naive(const SlopeLadder& ladder) const;
-	IntersectionResult check_ladder_intersections_Voronoi(const SlopeLadder& ladder);
-	std::unordered_set<SDG2::Vertex_handle> intersected_region(Segment<K> rung, Point<K> p);
+	IntersectionResult check_ladder_intersections_Voronoi(const SlopeLadder& ladder,
+	                                                      std::unordered_set<SDG2::Vertex_handle>* touched = nullptr) const;
+	std::unordered_set<SDG2::Vertex_handle> intersected_region(Segment<K> rung, Point<K> p) const;
 	std::pair<std::vector<std::vector<SDG2::Edge>>, int>
 	boundaries(const std::unordered_set<SDG2::Vertex_handle>& region) const;
-	bool check_rung_collapse_topology(Segment<K> rung, Point<K> p, std::unordered_set<Point<K>>& allowed);
-	bool check_ladder_collapse_topology(const SlopeLadder& ladder);
+	bool check_rung_collapse_topology(Segment<K> rung, Point<K> p, std::unordered_set<Point<K>>& allowed,
+	                                  std::unordered_set<SDG2::Vertex_handle>* touched = nullptr) const;
+	bool check_ladder_collapse_topology(const SlopeLadder& ladder,
+	                                    std::unordered_set<SDG2::Vertex_handle>* touched = nullptr) const;
+	/// Validates a slope ladder without modifying the simplifier, such that ladders can be validated concurrently.
+	LadderValidation validate_ladder(const SlopeLadder& ladder) const;
 	double total_symmetric_difference() const;
 	std::pair<double, double> average_max_vertex_alignment() const;
+	/// Returns the incrementally maintained quality measures of the current simplification in constant time.
+	/// In contrast to \ref total_symmetric_difference and \ref average_max_vertex_alignment this is cheap enough to
+	/// query after every step. These measures are not maintained by \ref dyken_simplify.
+	SimplificationMetrics metrics() const;
+	/// The metrics after every simplification step, recorded by \ref step.
+	/// \ref update_matching fills in the alignment of the last entry, as it changes only once the matching is updated.
+	/// The first entry describes the input isolines, or the isolines at the last call of \ref ladder_count.
+	std::vector<SimplificationMetrics> m_metrics_history;
 	int ladder_count();
+	/// Clears all data derived from the simplified isolines, including the metrics and their history.
 	void clear();
 
   private:
@@ -164,6 +250,12 @@ class IsolineSimplifier {
 	void initialize_sdg();
 	void initialize_slope_ladders();
 	void collapse_ladder(SlopeLadder& ladder);
+	void initialize_alignment();
+	AlignmentContribution point_alignment(const Point<K>& u) const;
+	void update_alignment(const std::unordered_set<Point<K>>& points);
+	void validate_ladders(int count);
+	void invalidate_validations(SDG2::Vertex_handle vertex);
+	bool incorrectly_updated(const SlopeLadder& ladder) const;
 	void create_slope_ladder(Segment<K> seg);
 	void clean_isolines();
 	void remove_ladder_e(Segment<K> seg);
@@ -0,0 +1,65 @@
+/*
+The CartoCrow library implements algorithmic geo-visualization methods,
+developed at TU Eindhoven.
+Copyright (C) 2024 TU Eindhoven
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "segment_index.h"
+
+namespace cartocrow::isoline_simplification {
+SegmentIndex::IndexBox SegmentIndex::box(const Segment<K>& seg) {
+	auto bbox = seg.bbox();
+	return {IndexPoint(bbox.xmin(), bbox.ymin()), IndexPoint(bbox.xmax(), bbox.ymax())};
+}
+
+void SegmentIndex::assign(const std::vector<Segment<K>>& segments) {
+	std::vector<Value> values;
+	values.reserve(segments.size());
+	for (const auto& seg : segments) {
+		values.emplace_back(box(seg), seg);
+	}
+	// The packing constructor builds a better balanced tree than repeated insertion.
+	m_rtree = decltype(m_rtree)(values.begin(), values.end());
+}
+
+void SegmentIndex::insert(const Segment<K>& seg) {
+	m_rtree.insert(Value(box(seg), seg));
+}
+
+bool SegmentIndex::remove(const Segment<K>& seg) {
+	return m_rtree.remove(Value(box(seg), seg)) > 0;
+}
+
+std::vector<Segment<K>> SegmentIndex::nearby(const Segment<K>& seg) const {
+	std::vector<Value> values;
+	m_rtree.query(boost::geometry::index::intersects(box(seg)), std::back_inserter(values));
+	std::vector<Segment<K>> segments;
+	segments.reserve(values.size());
+	for (const auto& [_, s] : values) {
+		segments.push_back(s);
+	}
+	return segments;
+}
+
+size_t SegmentIndex::size() const {
+	return m_rtree.size();
+}
+
+void SegmentIndex::clear() {
+	m_rtree.clear();
+}
+}
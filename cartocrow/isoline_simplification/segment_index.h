@@ -0,0 +1,54 @@
+/*
+The CartoCrow library implements algorithmic geo-visualization methods,
+developed at TU Eindhoven.
+Copyright (C) 2024 TU Eindhoven
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef CARTOCROW_SEGMENT_INDEX_H
+#define CARTOCROW_SEGMENT_INDEX_H
+
+#include "types.h"
+#include <boost/geometry.hpp>
+#include <boost/geometry/index/rtree.hpp>
+
+namespace cartocrow::isoline_simplification {
+/// A dynamic spatial index on segments, backed by an R-tree on their bounding boxes.
+/// Used to find the edges of the simplified isolines that are near a given segment.
+class SegmentIndex {
+  public:
+	typedef boost::geometry::model::point<double, 2, boost::geometry::cs::cartesian> IndexPoint;
+	typedef boost::geometry::model::box<IndexPoint> IndexBox;
+	typedef std::pair<IndexBox, Segment<K>> Value;
+
+	SegmentIndex() = default;
+	/// Bulk loads the index with the given segments, removing any segments that were stored before.
+	void assign(const std::vector<Segment<K>>& segments);
+	void insert(const Segment<K>& seg);
+	/// Removes the segment; returns whether it was present. A segment and its opposite are considered different.
+	bool remove(const Segment<K>& seg);
+	/// Returns the stored segments whose bounding box intersects the bounding box of \c seg.
+	std::vector<Segment<K>> nearby(const Segment<K>& seg) const;
+	size_t size() const;
+	void clear();
+
+  private:
+	static IndexBox box(const Segment<K>& seg);
+	boost::geometry::index::rtree<Value, boost::geometry::index::quadratic<16>> m_rtree;
+};
+}
+
+#endif //CARTOCROW_SEGMENT_INDEX_H
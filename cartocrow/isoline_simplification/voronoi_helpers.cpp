@@ -292,10 +292,19 @@ std::vector<Point<K>> project_snap(const SDG2& delaunay, const SDG2::Site_2& sit
 
 std::optional<Segment<K>> check_segment_intersections_Voronoi(const SDG2& delaunay, const Segment<K> seg,
                                                                  const SDG2::Vertex_handle endpoint_handle,
-                                                                 const std::unordered_set<SDG2::Vertex_handle>& allowed = std::unordered_set<SDG2::Vertex_handle>(),
-                                                                 const std::optional<SDG2::Vertex_handle> collinear_vertex = std::nullopt) {
+                                                                 const std::unordered_set<SDG2::Vertex_handle>& allowed,
+                                                                 const std::optional<SDG2::Vertex_handle> collinear_vertex,
+                                                                 std::unordered_set<SDG2::Vertex_handle>* touched) {
 	auto t = SDG2::Site_2::construct_site_2(seg.source(), seg.target());
 
+	// Records the vertices of the faces the result depends on, such that callers can tell when it may have changed.
+	auto touch = [&touched](const SDG2::Face_handle& f) {
+		if (touched == nullptr) return;
+		for (int i = 0; i < 3; i++) {
+			touched->insert(f->vertex(i));
+		}
+	};
+
 	auto check_intersections = [&t, &delaunay](SDG2::Vertex_handle vv) {
 		if (!delaunay.is_infinite(vv) && vv->is_segment()) {
 			bool intersects = arrangement_type(delaunay, t, vv->site()) == Gt::Arrangement_type_2::result_type::CROSSING;
@@ -317,10 +326,16 @@ std::optional<Segment<K>> check_segment_intersections_Voronoi(const SDG2& delaun
 		return incircle(sdg, f, q);
 	};
 
+	if (touched != nullptr) {
+		touched->insert(endpoint_handle);
+	}
 	auto vc_start = delaunay.incident_vertices(endpoint_handle);
 	auto vc = vc_start;
 	do {
 		SDG2::Vertex_handle vv(vc);
+		if (touched != nullptr) {
+			touched->insert(vv);
+		}
 		if (delaunay.is_infinite(vv)) {
 			++vc;
 			continue;
@@ -363,10 +378,12 @@ std::optional<Segment<K>> check_segment_intersections_Voronoi(const SDG2& delaun
 			continue;
 		}
 		visited.insert(curr_f);
+		touch(curr_f);
 
 		for (int i = 0; i < 3; i++) {
 			auto n = curr_f->neighbor(i);
 			if (visited.contains(n)) continue;
+			touch(n);
 
 			for (int j = 0; j < 3; j++) {
 				auto vv = n->vertex(j);
@@ -56,7 +56,8 @@ Point<K> point_of_Voronoi_edge(const SDG2::Edge& edge, const SDG2& delaunay);
 std::optional<Segment<K>> check_segment_intersections_Voronoi(const SDG2& delaunay, const Segment<K> seg,
 																 const SDG2::Vertex_handle endpoint_handle,
 																 const std::unordered_set<SDG2::Vertex_handle>& allowed,
-																 const std::optional<SDG2::Vertex_handle> collinear_vertex);
+																 const std::optional<SDG2::Vertex_handle> collinear_vertex,
+																 std::unordered_set<SDG2::Vertex_handle>* touched = nullptr);
 K::Vector_2 normal(const SDG2::Point_2& p, const PointToPoint& p_prev, const PointToPoint& p_next, CGAL::Sign side);
 double vertex_alignment(const PointToPoint& p_prev, const PointToPoint& p_next, Point<K> u, Point<K> v, CGAL::Sign uv_side, CGAL::Sign vu_side);
 }
@@ -24,6 +24,8 @@ Created by tvl (t.vanlankveld@esciencecenter.nl) on 10-09-2019
 
 #include <stdexcept>
 
+#include "../core/profiler.h"
+
 namespace cartocrow::necklace_map {
 
 NecklaceMap::NecklaceHandle::NecklaceHandle(size_t index) : m_index(index) {}
@@ -48,17 +50,27 @@ Parameters& NecklaceMap::parameters() {
 }
 
 void NecklaceMap::compute() {
+	ProfileZone zone("NecklaceMap::compute");
+
 	// compute the feasible region for each bead
-	for (auto& necklace : m_necklaces) {
-		for (auto& bead : necklace.beads) {
-			(*ComputeFeasibleInterval::construct(m_parameters))(bead, necklace);
+	{
+		ProfileZone feasibleZone("NecklaceMap::compute feasible intervals");
+		for (auto& necklace : m_necklaces) {
+			for (auto& bead : necklace.beads) {
+				(*ComputeFeasibleInterval::construct(m_parameters))(bead, necklace);
+			}
+			Profiler::count("necklace beads", necklace.beads.size());
 		}
 	}
 
 	// compute the scaling factor
-	m_scaleFactor = (*ComputeScaleFactor::construct(m_parameters))(m_necklaces);
+	{
+		ProfileZone scaleZone("NecklaceMap::compute scale factor");
+		m_scaleFactor = (*ComputeScaleFactor::construct(m_parameters))(m_necklaces);
+	}
 
 	// compute valid placement
+	ProfileZone placementZone("NecklaceMap::compute placement");
 	(*ComputeValidPlacement::construct(m_parameters))(m_scaleFactor, m_necklaces);
 }
 
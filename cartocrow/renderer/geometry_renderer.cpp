@@ -20,8 +20,140 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include "geometry_renderer.h"
 #include <CGAL/number_utils.h>
 
+#include <iterator>
+
 namespace cartocrow::renderer {
 
+namespace {
+
+/// Simplifies a chain of points with tolerance \c tolerance, keeping its
+/// endpoints. First a streaming radial-distance pass merges vertices that are
+/// closer than the tolerance to the previous kept vertex, then Douglas–Peucker
+/// removes the vertices that lie within the tolerance of the simplified chain.
+template <class InputIterator>
+std::vector<Point<Inexact>> simplifyChain(InputIterator begin, InputIterator end, Number<Inexact> tolerance) {
+	Number<Inexact> squaredTolerance = tolerance * tolerance;
+
+	std::vector<Point<Inexact>> points;
+	for (auto it = begin; it != end; ++it) {
+		if (points.empty() || CGAL::squared_distance(points.back(), *it) >= squaredTolerance) {
+			points.push_back(*it);
+		} else if (std::next(it) == end) {
+			// always keep the last point, replacing the previous one unless that is the first
+			if (points.size() == 1) {
+				points.push_back(*it);
+			} else {
+				points.back() = *it;
+			}
+		}
+	}
+	if (points.size() <= 2) {
+		return points;
+	}
+
+	std::vector<bool> keep(points.size(), false);
+	keep.front() = true;
+	keep.back() = true;
+	std::vector<std::pair<int, int>> ranges{{0, static_cast<int>(points.size()) - 1}};
+	while (!ranges.empty()) {
+		auto [first, last] = ranges.back();
+		ranges.pop_back();
+		Segment<Inexact> segment(points[first], points[last]);
+		Number<Inexact> maxDistance = squaredTolerance;
+		int farthest = -1;
+		for (int i = first + 1; i < last; ++i) {
+			Number<Inexact> distance = segment.is_degenerate()
+			                               ? CGAL::squared_distance(points[first], points[i])
+			                               : CGAL::squared_distance(segment, points[i]);
+			if (distance > maxDistance) {
+				maxDistance = distance;
+				farthest = i;
+			}
+		}
+		if (farthest != -1) {
+			keep[farthest] = true;
+			ranges.emplace_back(first, farthest);
+			ranges.emplace_back(farthest, last);
+		}
+	}
+
+	std::vector<Point<Inexact>> result;
+	for (int i = 0; i < points.size(); ++i) {
+		if (keep[i]) {
+			result.push_back(points[i]);
+		}
+	}
+	return result;
+}
+
+/// Simplifies a polygon boundary, or returns `false` if it is too small to draw.
+bool simplifyRing(const Polygon<Inexact>& p, Number<Inexact> tolerance, Polygon<Inexact>& result) {
+	if (p.is_empty()) {
+		return false;
+	}
+	Box box = p.bbox();
+	if (box.xmax() - box.xmin() < tolerance && box.ymax() - box.ymin() < tolerance) {
+		return false;
+	}
+	// close the ring, so that the chain starts and ends at the first vertex
+	std::vector<Point<Inexact>> ring(p.vertices_begin(), p.vertices_end());
+	ring.push_back(ring.front());
+	std::vector<Point<Inexact>> simplified = simplifyChain(ring.begin(), ring.end(), tolerance);
+	simplified.pop_back();
+	if (simplified.size() < 3) {
+		return false;
+	}
+	result = Polygon<Inexact>(simplified.begin(), simplified.end());
+	return true;
+}
+
+} // namespace
+
+void GeometryRenderer::setLodTolerance(Number<Inexact> tolerance) {
+	m_lodTolerance = tolerance;
+}
+
+Number<Inexact> GeometryRenderer::lodTolerance() const {
+	return m_lodTolerance;
+}
+
+const Polygon<Inexact>* GeometryRenderer::applyLod(const Polygon<Inexact>& p,
+                                                   Polygon<Inexact>& buffer) const {
+	if (m_lodTolerance <= 0) {
+		return &p;
+	}
+	return simplifyRing(p, m_lodTolerance, buffer) ? &buffer : nullptr;
+}
+
+const PolygonWithHoles<Inexact>* GeometryRenderer::applyLod(const PolygonWithHoles<Inexact>& p,
+                                                            PolygonWithHoles<Inexact>& buffer) const {
+	if (m_lodTolerance <= 0) {
+		return &p;
+	}
+	Polygon<Inexact> outer;
+	if (!simplifyRing(p.outer_boundary(), m_lodTolerance, outer)) {
+		return nullptr;
+	}
+	std::vector<Polygon<Inexact>> holes;
+	for (const auto& hole : p.holes()) {
+		Polygon<Inexact> simplifiedHole;
+		if (simplifyRing(hole, m_lodTolerance, simplifiedHole)) {
+			holes.push_back(std::move(simplifiedHole));
+		}
+	}
+	buffer = PolygonWithHoles<Inexact>(outer, holes.begin(), holes.end());
+	return &buffer;
+}
+
+const Polyline<Inexact>* GeometryRenderer::applyLod(const Polyline<Inexact>& p,
+                                                    Polyline<Inexact>& buffer) const {
+	if (m_lodTolerance <= 0 || p.num_vertices() <= 2) {
+		return &p;
+	}
+	buffer = Polyline<Inexact>(simplifyChain(p.vertices_begin(), p.vertices_end(), m_lodTolerance));
+	return &buffer;
+}
+
 void GeometryRenderer::draw(const PolygonSet<Inexact>& ps) {
 	std::vector<PolygonWithHoles<Inexact>> polygons;
 	ps.polygons_with_holes(std::back_inserter(polygons));
@@ -30,6 +162,30 @@ void GeometryRenderer::draw(const PolygonSet<Inexact>& ps) {
 	}
 }
 
+void GeometryRenderer::drawPoints(std::span<const Point<Inexact>> points) {
+	for (const Point<Inexact>& p : points) {
+		draw(p);
+	}
+}
+
+void GeometryRenderer::drawSegments(std::span<const Segment<Inexact>> segments) {
+	for (const Segment<Inexact>& s : segments) {
+		draw(s);
+	}
+}
+
+void GeometryRenderer::drawPolygons(std::span<const Polygon<Inexact>> polygons) {
+	for (const Polygon<Inexact>& p : polygons) {
+		draw(p);
+	}
+}
+
+void GeometryRenderer::drawCircles(std::span<const Circle<Inexact>> circles) {
+	for (const Circle<Inexact>& c : circles) {
+		draw(c);
+	}
+}
+
 void GeometryRenderer::draw(const BezierCurve& c) {
 	BezierSpline spline;
 	spline.appendCurve(c);
@@ -26,6 +26,8 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include "../core/polyline.h"
 #include "../core/circular_arc.h"
 
+#include <span>
+
 namespace cartocrow::renderer {
 
 /// An interface for rendering geometric objects to a GUI or a file.
@@ -112,6 +114,25 @@ class GeometryRenderer {
 	/// Draws a circular arc with the currently set style.
 	virtual void draw(const CircularArc& a) = 0;
 
+	/// Draws several points with the currently set style.
+	/**
+	 * The result is the same as drawing the points one by one, but renderers
+	 * may handle the whole batch at once, for example by writing a single path
+	 * to the output. The objects of a batch may then be drawn as one shape, so
+	 * filled or translucent objects in a batch should not overlap. The default
+	 * implementation draws the objects one by one.
+	 */
+	virtual void drawPoints(std::span<const Point<Inexact>> points);
+	/// Draws several line segments with the currently set style.
+	/// \sa drawPoints()
+	virtual void drawSegments(std::span<const Segment<Inexact>> segments);
+	/// Draws several simple polygons with the currently set style.
+	/// \sa drawPoints()
+	virtual void drawPolygons(std::span<const Polygon<Inexact>> polygons);
+	/// Draws several circles with the currently set style.
+	/// \sa drawPoints()
+	virtual void drawCircles(std::span<const Circle<Inexact>> circles);
+
 	/// Draws an exact geometry with the currently set style by approximating it.
 	template<class ExactGeometry>
 	void draw(const ExactGeometry& g) {
@@ -151,6 +172,44 @@ class GeometryRenderer {
 	virtual void setFillOpacity(int alpha) = 0;
 
 	/// @}
+
+	/// \name Level of detail
+	/// @{
+
+	/// Sets the level-of-detail tolerance, in drawing coordinates.
+	/**
+	 * If the tolerance is positive, polygons (also those of polygon sets) and
+	 * polylines are simplified before they are drawn: consecutive vertices
+	 * closer than the tolerance are merged, and the remaining vertices are
+	 * simplified with Douglas–Peucker. Polygons and holes whose bounding box is
+	 * smaller than the tolerance in both directions are not drawn at all. A
+	 * good tolerance is the size of one pixel (or point) of the output. The
+	 * default tolerance 0 disables simplification.
+	 */
+	void setLodTolerance(Number<Inexact> tolerance);
+	/// Returns the level-of-detail tolerance set by \ref setLodTolerance().
+	Number<Inexact> lodTolerance() const;
+
+	/// @}
+
+  protected:
+	/// Applies the level of detail to a polygon before drawing it. Returns \p p
+	/// itself if simplification is disabled, \p buffer containing the simplified
+	/// polygon otherwise, or `nullptr` if the polygon is too small to draw.
+	const Polygon<Inexact>* applyLod(const Polygon<Inexact>& p, Polygon<Inexact>& buffer) const;
+	/// Applies the level of detail to a polygon with holes before drawing it.
+	/// Holes that are too small to draw are dropped.
+	/// \sa applyLod(const Polygon<Inexact>&, Polygon<Inexact>&) const
+	const PolygonWithHoles<Inexact>* applyLod(const PolygonWithHoles<Inexact>& p,
+	                                          PolygonWithHoles<Inexact>& buffer) const;
+	/// Applies the level of detail to a polyline before drawing it. Polylines
+	/// are never dropped; their endpoints are always kept.
+	/// \sa applyLod(const Polygon<Inexact>&, Polygon<Inexact>&) const
+	const Polyline<Inexact>* applyLod(const Polyline<Inexact>& p, Polyline<Inexact>& buffer) const;
+
+  private:
+	/// The level-of-detail tolerance; 0 if disabled.
+	Number<Inexact> m_lodTolerance = 0;
 };
 
 } // namespace cartocrow::renderer
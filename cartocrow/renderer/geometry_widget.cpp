@@ -20,6 +20,8 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include "geometry_widget.h"
 
 #include "geometry_renderer.h"
+#include "painter_path.h"
+#include "../core/timer.h"
 
 #include <QGuiApplication>
 #include <QPainterPath>
@@ -27,6 +29,7 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include <QPoint>
 #include <QPolygon>
 #include <QSlider>
+#include <QStringList>
 #include <QToolButton>
 
 #include <cmath>
@@ -144,6 +147,12 @@ GeometryWidget::GeometryWidget() {
 	m_zoomInButton->setText("+");
 	connect(m_zoomInButton, &QToolButton::clicked, this, &GeometryWidget::zoomIn);
 	m_zoomBar->addWidget(m_zoomInButton);
+	m_statisticsButton = new QToolButton(m_zoomBar);
+	m_statisticsButton->setText("Stats");
+	m_statisticsButton->setToolTip("Show drawing statistics for each layer");
+	m_statisticsButton->setCheckable(true);
+	connect(m_statisticsButton, &QToolButton::toggled, this, &GeometryWidget::setDrawStatistics);
+	m_zoomBar->addWidget(m_statisticsButton);
 }
 
 GeometryWidget::GeometryWidget(std::shared_ptr<GeometryPainting> painting) : GeometryWidget() {
@@ -166,13 +175,26 @@ void GeometryWidget::paintEvent(QPaintEvent* event) {
 	if (m_drawAxes) {
 		drawAxes();
 	}
-	for (const auto& painting : m_paintings) {
+	QTransform transform = sceneTransform();
+	Box visibleBox = viewport();
+	Number<Inexact> lodTolerance = m_lodPixelTolerance / zoomFactor();
+	for (auto& painting : m_paintings) {
 		if (painting.visible) {
-			pushStyle();
-			painting.m_painting->paint(*this);
-			popStyle();
+			Timer timer;
+			bool outdatedLod = painting.m_scene && (painting.m_scene->lodTolerance() > 2 * lodTolerance ||
+			                                        painting.m_scene->lodTolerance() < lodTolerance / 2);
+			if (!painting.m_scene || outdatedLod) {
+				painting.m_statistics = RenderStatistics{painting.name};
+				painting.m_scene = std::make_unique<RetainedScene>(*painting.m_painting, m_style,
+				                                                   lodTolerance, &painting.m_statistics);
+			}
+			painting.m_scene->paint(*m_painter, transform, visibleBox);
+			painting.m_statistics.m_time = timer.peek();
 		}
 	}
+	if (m_drawStatistics) {
+		drawStatistics();
+	}
 
 	Point<Inexact> mouseLocation = inverseConvertPoint(m_mousePos);
 	for (const auto& editable : m_editables) {
@@ -198,6 +220,8 @@ void GeometryWidget::mouseMoveEvent(QMouseEvent* event) {
 		} else if (m_activeEditable) {
 			m_activeEditable->handleDrag(inverseConvertPoint(m_mousePos));
 			emit edited();
+			// the edit may have changed what the paintings draw
+			invalidate();
 		} else {
 			m_dragging = true;
 			emit dragStarted(inverseConvertPoint(m_previousMousePos));
@@ -307,6 +331,18 @@ Box GeometryWidget::inverseConvertBox(QRectF r) const {
 	return Box(topLeft.x(), topLeft.y(), bottomRight.x(), bottomRight.y());
 }
 
+QTransform GeometryWidget::sceneTransform() const {
+	return QTransform::fromTranslate(0.5, 0.5) * m_transform *
+	       QTransform::fromTranslate(width() / 2.0, height() / 2.0);
+}
+
+Box GeometryWidget::viewport() const {
+	Point<Inexact> topLeft = inverseConvertPoint(rect().topLeft());
+	Point<Inexact> bottomRight = inverseConvertPoint(rect().bottomRight());
+	return Box(std::min(topLeft.x(), bottomRight.x()), std::min(topLeft.y(), bottomRight.y()),
+	           std::max(topLeft.x(), bottomRight.x()), std::max(topLeft.y(), bottomRight.y()));
+}
+
 void GeometryWidget::drawAxes() {
 	Box bounds = inverseConvertBox(rect());
 	pushStyle();
@@ -444,6 +480,35 @@ void GeometryWidget::drawCoordinates() {
 	m_painter->end();
 }
 
+void GeometryWidget::drawStatistics() {
+	QStringList lines;
+	for (const auto& statistics : this->statistics()) {
+		lines << QString("%1: %2 ms, %3 objects, %4 vertices")
+		             .arg(QString::fromStdString(statistics.m_name.empty() ? "(unnamed)" : statistics.m_name))
+		             .arg(statistics.m_time * 1000, 0, 'f', 2)
+		             .arg(statistics.objectCount())
+		             .arg(statistics.m_vertices);
+	}
+	QString text = lines.join("\n");
+	QRectF bounds = m_painter->boundingRect(rect().marginsRemoved(QMargins(10, 10, 10, 10)),
+	                                        Qt::AlignLeft | Qt::AlignTop, text);
+	m_painter->setPen(Qt::NoPen);
+	m_painter->setBrush(QColor(255, 255, 255, 200));
+	m_painter->drawRect(bounds.marginsAdded(QMarginsF(5, 5, 5, 5)));
+	m_painter->setPen(QPen(QColor(0, 0, 0)));
+	m_painter->drawText(bounds, Qt::AlignLeft | Qt::AlignTop, text);
+}
+
+std::vector<RenderStatistics> GeometryWidget::statistics() const {
+	std::vector<RenderStatistics> result;
+	for (const auto& painting : m_paintings) {
+		if (painting.visible) {
+			result.push_back(painting.m_statistics);
+		}
+	}
+	return result;
+}
+
 void GeometryWidget::updateZoomSlider() {
 	double zoom = m_transform.m11();
 	double fraction = log(zoom / m_minZoom) / log(m_maxZoom / m_minZoom);
@@ -457,7 +522,7 @@ void GeometryWidget::updateLayerList() {
 	}
 	m_layerList->show();
 	m_layerList->clear();
-	for (auto painting : m_paintings) {
+	for (const auto& painting : m_paintings) {
 		QListWidgetItem* item =
 		    new QListWidgetItem(QString::fromStdString(painting.name), m_layerList);
 		item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
@@ -486,31 +551,42 @@ void GeometryWidget::draw(const Segment<Inexact>& s) {
 	}
 }
 
-void GeometryWidget::draw(const Polygon<Inexact>& p) {
+void GeometryWidget::draw(const Polygon<Inexact>& polygon) {
+	Polygon<Inexact> simplified;
+	const Polygon<Inexact>* p = applyLod(polygon, simplified);
+	if (!p) {
+		return;
+	}
 	setupPainter();
 	QPainterPath path;
-	addPolygonToPath(path, p);
+	addPolygonToPath(path, *p, [this](const Point<Inexact>& vertex) { return convertPoint(vertex); });
 	m_painter->drawPath(path);
 	if (m_style.m_mode & vertices) {
-		for (auto v = p.vertices_begin(); v != p.vertices_end(); v++) {
+		for (auto v = p->vertices_begin(); v != p->vertices_end(); v++) {
 			draw(*v);
 		}
 	}
 }
 
-void GeometryWidget::draw(const PolygonWithHoles<Inexact>& p) {
+void GeometryWidget::draw(const PolygonWithHoles<Inexact>& polygon) {
+	PolygonWithHoles<Inexact> simplified;
+	const PolygonWithHoles<Inexact>* p = applyLod(polygon, simplified);
+	if (!p) {
+		return;
+	}
 	setupPainter();
+	auto convert = [this](const Point<Inexact>& vertex) { return convertPoint(vertex); };
 	QPainterPath path;
-	addPolygonToPath(path, p.outer_boundary());
-	for (auto hole : p.holes()) {
-		addPolygonToPath(path, hole);
+	addPolygonToPath(path, p->outer_boundary(), convert);
+	for (auto hole : p->holes()) {
+		addPolygonToPath(path, hole, convert);
 	}
 	m_painter->drawPath(path);
 	if (m_style.m_mode & vertices) {
-		for (auto v = p.outer_boundary().vertices_begin(); v != p.outer_boundary().vertices_end(); v++) {
+		for (auto v = p->outer_boundary().vertices_begin(); v != p->outer_boundary().vertices_end(); v++) {
 			draw(*v);
 		}
-		for (auto h = p.holes_begin(); h != p.holes_end(); h++) {
+		for (auto h = p->holes_begin(); h != p->holes_end(); h++) {
 			for (auto v = h->vertices_begin(); v != h->vertices_end(); v++) {
 				draw(*v);
 			}
@@ -518,17 +594,6 @@ void GeometryWidget::draw(const PolygonWithHoles<Inexact>& p) {
 	}
 }
 
-void GeometryWidget::addPolygonToPath(QPainterPath& path, const Polygon<Inexact>& p) {
-	for (auto vertex = p.vertices_begin(); vertex != p.vertices_end(); vertex++) {
-		if (vertex == p.vertices_begin()) {
-			path.moveTo(convertPoint(*vertex));
-		} else {
-			path.lineTo(convertPoint(*vertex));
-		}
-	}
-	path.closeSubpath();
-}
-
 void GeometryWidget::draw(const Circle<Inexact>& c) {
 	setupPainter();
 	QRectF rect = convertBox(c.bbox());
@@ -592,7 +657,9 @@ void GeometryWidget::draw(const Line<Inexact>& l) {
 	}
 }
 
-void GeometryWidget::draw(const Polyline<Inexact>& p) {
+void GeometryWidget::draw(const Polyline<Inexact>& polyline) {
+	Polyline<Inexact> simplified;
+	const Polyline<Inexact>& p = *applyLod(polyline, simplified);
 	setupPainter();
 	QPainterPath path;
 	path.moveTo(convertPoint(*p.vertices_begin()));
@@ -607,6 +674,70 @@ void GeometryWidget::draw(const Polyline<Inexact>& p) {
 	}
 }
 
+void GeometryWidget::drawPoints(std::span<const Point<Inexact>> points) {
+	if (points.empty()) {
+		return;
+	}
+	// All points have the same size in pixels, so they can be drawn in one call
+	// as points of a pen with round caps, which look like disks of that size.
+	std::vector<QPointF> converted;
+	converted.reserve(points.size());
+	for (const Point<Inexact>& p : points) {
+		converted.push_back(convertPoint(p));
+	}
+	m_painter->setPen(QPen(m_style.m_strokeColor, m_style.m_pointSize, Qt::SolidLine, Qt::RoundCap));
+	m_painter->setBrush(Qt::NoBrush);
+	m_painter->drawPoints(converted.data(), static_cast<int>(converted.size()));
+}
+
+void GeometryWidget::drawSegments(std::span<const Segment<Inexact>> segments) {
+	setupPainter();
+	std::vector<QLineF> lines;
+	lines.reserve(segments.size());
+	for (const Segment<Inexact>& s : segments) {
+		lines.emplace_back(convertPoint(s.start()), convertPoint(s.end()));
+	}
+	m_painter->drawLines(lines.data(), static_cast<int>(lines.size()));
+
+	if (m_style.m_mode & vertices) {
+		std::vector<Point<Inexact>> points;
+		points.reserve(2 * segments.size());
+		for (const Segment<Inexact>& s : segments) {
+			points.push_back(s.start());
+			points.push_back(s.end());
+		}
+		drawPoints(points);
+	}
+}
+
+void GeometryWidget::drawPolygons(std::span<const Polygon<Inexact>> polygons) {
+	setupPainter();
+	QPainterPath path;
+	std::vector<Point<Inexact>> points;
+	Polygon<Inexact> simplified;
+	for (const Polygon<Inexact>& polygon : polygons) {
+		if (const Polygon<Inexact>* p = applyLod(polygon, simplified)) {
+			addPolygonToPath(path, *p, [this](const Point<Inexact>& vertex) { return convertPoint(vertex); });
+			if (m_style.m_mode & vertices) {
+				points.insert(points.end(), p->vertices_begin(), p->vertices_end());
+			}
+		}
+	}
+	m_painter->drawPath(path);
+	drawPoints(points);
+}
+
+void GeometryWidget::drawCircles(std::span<const Circle<Inexact>> circles) {
+	setupPainter();
+	QPainterPath path;
+	// Qt adds all ellipses in the same direction, so this draws their union.
+	path.setFillRule(Qt::WindingFill);
+	for (const Circle<Inexact>& c : circles) {
+		path.addEllipse(convertBox(c.bbox()));
+	}
+	m_painter->drawPath(path);
+}
+
 void GeometryWidget::drawText(const Point<Inexact>& p, const std::string& text) {
 	setupPainter();
 	QPointF p2 = convertPoint(p);
@@ -685,6 +816,12 @@ void GeometryWidget::setDrawAxes(bool drawAxes) {
 	update();
 }
 
+void GeometryWidget::setDrawStatistics(bool drawStatistics) {
+	m_drawStatistics = drawStatistics;
+	m_statisticsButton->setChecked(drawStatistics);
+	update();
+}
+
 void GeometryWidget::setMinZoom(double minZoom) {
 	m_minZoom = minZoom;
 }
@@ -716,4 +853,16 @@ void GeometryWidget::setGridMode(GridMode mode) {
 	update();
 }
 
+void GeometryWidget::setLodPixelTolerance(double pixels) {
+	m_lodPixelTolerance = pixels;
+	invalidate();
+}
+
+void GeometryWidget::invalidate() {
+	for (auto& painting : m_paintings) {
+		painting.m_scene = nullptr;
+	}
+	update();
+}
+
 } // namespace cartocrow::renderer
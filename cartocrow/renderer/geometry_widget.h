@@ -36,23 +36,11 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 #include "geometry_painting.h"
 #include "geometry_renderer.h"
+#include "render_statistics.h"
+#include "retained_scene.h"
 
 namespace cartocrow::renderer {
 
-/// The style for a GeometryWidget.
-struct GeometryWidgetStyle {
-	/// The draw mode.
-	int m_mode = GeometryRenderer::stroke;
-	/// The diameter of points.
-	double m_pointSize = 15;
-	/// The color of points and lines.
-	QColor m_strokeColor = QColor(0, 0, 0);
-	/// The width of lines.
-	double m_strokeWidth = 1;
-	/// The color of filled shapes.
-	QColor m_fillColor = QColor(0, 102, 203);
-};
-
 /// \ref QWidget specialization of the GeometryRenderer.
 ///
 /// A GeometryWidget renders the GeometryPainting using a \ref QPainter. It is
@@ -67,6 +55,12 @@ struct GeometryWidgetStyle {
 /// layers can be named (see \ref addPainting()) and if there is more than one,
 /// the user is able to toggle the visibility of each one individually.
 ///
+/// Each painting is recorded once into a \ref RetainedScene, which is redrawn
+/// on every repaint; only the objects that intersect the viewport are drawn.
+/// Hence a painting that draws something different after its underlying data
+/// changed is only shown correctly after calling \ref invalidate(). This
+/// happens automatically when the user edits an editable.
+///
 /// It is very simple to create a GeometryWidget for a given painting and use it
 /// for debugging, for example like this:
 ///
@@ -168,6 +162,10 @@ class GeometryWidget : public QWidget, public GeometryRenderer {
 	void draw(const Ray<Inexact>& r) override;
 	void draw(const Polyline<Inexact>& p) override;
 	void draw(const CircularArc& a) override;
+	void drawPoints(std::span<const Point<Inexact>> points) override;
+	void drawSegments(std::span<const Segment<Inexact>> segments) override;
+	void drawPolygons(std::span<const Polygon<Inexact>> polygons) override;
+	void drawCircles(std::span<const Circle<Inexact>> circles) override;
 	void drawText(const Point<Inexact>& p, const std::string& text) override;
 
 	void pushStyle() override;
@@ -186,6 +184,11 @@ class GeometryWidget : public QWidget, public GeometryRenderer {
 	/// Returns the current zoom factor, in pixels per unit.
 	Number<Inexact> zoomFactor() const;
 
+	/// Returns statistics about each visible painting. The time is the time
+	/// spent on the painting during the last repaint, including recording it if
+	/// that was necessary.
+	std::vector<RenderStatistics> statistics() const;
+
 	/// Adds an editable point.
 	void registerEditable(std::shared_ptr<Point<Inexact>> point);
 	/// Adds an editable polygon.
@@ -194,6 +197,9 @@ class GeometryWidget : public QWidget, public GeometryRenderer {
   public slots:
 	/// Determines whether to draw the axes and gridlines in the background.
 	void setDrawAxes(bool drawAxes);
+	/// Determines whether to draw an overlay with the \ref statistics() of
+	/// each painting.
+	void setDrawStatistics(bool drawStatistics);
 	/// Sets the minimum zoom level, in pixels per unit. If the current zoom
 	/// level violates the minimum, it is not automatically adjusted.
 	void setMinZoom(double minZoom);
@@ -206,6 +212,15 @@ class GeometryWidget : public QWidget, public GeometryRenderer {
 	void zoomOut();
 	/// Sets the type of grid.
 	void setGridMode(GridMode mode);
+	/// Discards the recorded paintings, so that they are painted again on the
+	/// next repaint, and schedules a repaint.
+	void invalidate();
+	/// Sets the level-of-detail tolerance in pixels, with which the paintings
+	/// are simplified when they are recorded (see \ref setLodTolerance()). A
+	/// painting is recorded again when the zoom level changed by more than a
+	/// factor two since it was recorded. The default tolerance 0 disables
+	/// simplification.
+	void setLodPixelTolerance(double pixels);
 
   signals:
 	/// Emitted when the user clicks on the widget.
@@ -240,8 +255,12 @@ class GeometryWidget : public QWidget, public GeometryRenderer {
 	Box inverseConvertBox(QRectF r) const;
 
   private:
-	/// Converts the polygon to Qt coordinates and adds it to the QPainterPath.
-	void addPolygonToPath(QPainterPath& path, const Polygon<Inexact>& p);
+	/// Returns the transform from drawing coordinates to Qt coordinates, as
+	/// applied by \ref convertPoint().
+	QTransform sceneTransform() const;
+	/// Returns the part of the drawing visible in the widget, in drawing
+	/// coordinates.
+	Box viewport() const;
 
 	/// Sets the pen and brush on \ref m_painter corresponding to \link m_style.
 	void setupPainter();
@@ -251,6 +270,8 @@ class GeometryWidget : public QWidget, public GeometryRenderer {
 	void drawAxes();
 	/// Draws the coordinate hovered by the mouse.
 	void drawCoordinates();
+	/// Draws the statistics of each visible painting in the top-left corner.
+	void drawStatistics();
 	/// Moves the zoom slider knob to the currently set zoom level.
 	void updateZoomSlider();
 	/// Puts the layers currently in this GeometryWidget into the layer list.
@@ -263,6 +284,10 @@ class GeometryWidget : public QWidget, public GeometryRenderer {
 		std::string name;
 		/// Whether the painting is currently visible.
 		bool visible;
+		/// The recorded painting, or `nullptr` if it still needs to be recorded.
+		std::unique_ptr<RetainedScene> m_scene;
+		/// Statistics about drawing the painting.
+		RenderStatistics m_statistics;
 	};
 	/// The set of layer names that were invisible. This set doesn't get cleared
 	/// when paintings are removed; when a new painting is added its name is
@@ -291,6 +316,10 @@ class GeometryWidget : public QWidget, public GeometryRenderer {
 	bool m_mouseButtonDown = false;
 	/// Whether to draw the background axes.
 	bool m_drawAxes = false;
+	/// Whether to draw the statistics overlay.
+	bool m_drawStatistics = false;
+	/// The level-of-detail tolerance for recording paintings, in pixels.
+	double m_lodPixelTolerance = 0;
 	/// The grid mode.
 	GridMode m_gridMode = GridMode::CARTESIAN;
 	/// The registered editables.
@@ -314,6 +343,8 @@ class GeometryWidget : public QWidget, public GeometryRenderer {
 	QSlider* m_zoomSlider;
 	/// The zoom in button in the toolbar.
 	QToolButton* m_zoomInButton;
+	/// The button in the toolbar that toggles the statistics overlay.
+	QToolButton* m_statisticsButton;
 };
 
 } // namespace cartocrow::renderer
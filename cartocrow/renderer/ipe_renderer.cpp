@@ -20,20 +20,83 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include "ipe_renderer.h"
 
 #include "cartocrow/renderer/geometry_renderer.h"
-#include <ipeattributes.h>
-#include <ipebase.h>
-#include <ipedoc.h>
-#include <ipegeo.h>
-#include <ipeiml.h>
-#include <ipereference.h>
-#include <ipestyle.h>
-#include <ipetext.h>
-
-#include <fstream>
+#include "cartocrow/core/timer.h"
+
+#include <charconv>
+#include <cmath>
+#include <stdexcept>
 #include <string>
+#include <system_error>
 
 namespace cartocrow::renderer {
 
+namespace {
+
+/// Definition of the disk mark used to draw points.
+constexpr std::string_view DISK_MARK_DEFINITION =
+    "<ipestyle name=\"marks\">\n"
+    "<symbol name=\"mark/disk(sx)\" transformations=\"translations\">\n"
+    "<path fill=\"sym-stroke\">\n"
+    "0.6 0 0 0.6 0 0 e\n"
+    "</path>\n"
+    "</symbol>\n"
+    "<symbol name=\"mark/fdisk(sfx)\" transformations=\"translations\">\n"
+    "<group>\n"
+    "<path fill=\"sym-fill\">\n"
+    "0.5 0 0 0.5 0 0 e\n"
+    "</path>\n"
+    "<path fill=\"sym-stroke\" fillrule=\"eofill\">\n"
+    "0.6 0 0 0.6 0 0 e\n"
+    "0.4 0 0 0.4 0 0 e\n"
+    "</path>\n"
+    "</group>\n"
+    "</symbol>\n"
+    "</ipestyle>\n";
+
+/// Formats a color as Ipe's three RGB components between 0 and 1.
+std::string formatColor(const Color& color) {
+	std::string result;
+	char buffer[32];
+	for (int component : {color.r, color.g, color.b}) {
+		auto [end, error] = std::to_chars(buffer, buffer + sizeof(buffer), component / 255.0,
+		                                  std::chars_format::general, 3);
+		if (!result.empty()) {
+			result += ' ';
+		}
+		result.append(buffer, end);
+	}
+	return result;
+}
+
+/// A temporary file that is written through a stream. The stream is closed
+/// and the file is removed when this goes out of scope, also when an exception
+/// is thrown.
+class TemporaryFile {
+  public:
+	TemporaryFile(std::filesystem::path path, std::ofstream& out) : m_path(std::move(path)), m_out(out) {}
+	~TemporaryFile() {
+		if (m_out.is_open()) {
+			m_out.close();
+		}
+		std::error_code error;
+		std::filesystem::remove(m_path, error);
+	}
+	TemporaryFile(const TemporaryFile&) = delete;
+	TemporaryFile& operator=(const TemporaryFile&) = delete;
+
+  private:
+	std::filesystem::path m_path;
+	std::ofstream& m_out;
+};
+
+/// Style sheet setting the paper size.
+constexpr std::string_view PAPER_SIZE_DEFINITION =
+    "<ipestyle name=\"paper-size\">\n"
+    "<layout paper=\"1000 1000\" origin=\"0 0\" frame=\"1000 1000\" crop=\"yes\"/>\n"
+    "</ipestyle>\n";
+
+} // namespace
+
 IpeRenderer::IpeRenderer(const std::shared_ptr<GeometryPainting>& painting) {
 	m_paintings.push_back(DrawnPainting{painting});
 }
@@ -43,81 +106,179 @@ IpeRenderer::IpeRenderer(const std::shared_ptr<GeometryPainting>& painting, cons
 }
 
 void IpeRenderer::save(const std::filesystem::path& file) {
-	ipe::Platform::initLib(ipe::IPELIB_VERSION);
-	ipe::Document document;
-	ipe::Layout layout;
-	layout.iOrigin = ipe::Vector(0, 0);
-	layout.iPaperSize = ipe::Vector(1000, 1000);
-	layout.iFrameSize = ipe::Vector(1000, 1000);
-	layout.iCrop = true;
-
-	std::string diskMarkDefinition =
-	    "<ipestyle name=\"marks\">\n"
-	    "<symbol name=\"mark/disk(sx)\" transformations=\"translations\">\n"
-	    "<path fill=\"sym-stroke\">\n"
-	    "0.6 0 0 0.6 0 0 e\n"
-	    "</path>\n"
-	    "</symbol>\n"
-	    "<symbol name=\"mark/fdisk(sfx)\" transformations=\"translations\">\n"
-	    "<group>\n"
-	    "<path fill=\"sym-fill\">\n"
-	    "0.5 0 0 0.5 0 0 e\n"
-	    "</path>\n"
-	    "<path fill=\"sym-stroke\" fillrule=\"eofill\">\n"
-	    "0.6 0 0 0.6 0 0 e\n"
-	    "0.4 0 0 0.4 0 0 e\n"
-	    "</path>"
-	    "</group>"
-	    "</symbol>"
-	    "</ipestyle>";
-	ipe::Buffer styleBuffer(diskMarkDefinition.data(), diskMarkDefinition.size());
-	ipe::BufferSource styleSource(styleBuffer);
-	ipe::ImlParser styleParser(styleSource);
-	ipe::StyleSheet* diskSheet = styleParser.parseStyleSheet();
-	document.cascade()->insert(0, diskSheet);
-
-	ipe::StyleSheet* sizeSheet = new ipe::StyleSheet();
-	sizeSheet->setName("paper-size");
-	sizeSheet->setLayout(layout);
-	document.cascade()->insert(1, sizeSheet);
-
-	m_alphaSheet = new ipe::StyleSheet();
-	m_alphaSheet->setName("alpha-values");
-	document.cascade()->insert(2, m_alphaSheet);
-	setFillOpacity(255); // add default alpha to style sheet
-
-	m_page = new ipe::Page();
-	for (auto painting : m_paintings) {
+	std::filesystem::path pageFile = file;
+	pageFile += ".page";
+	m_out.clear();
+	m_out.open(pageFile, std::ios::binary);
+	TemporaryFile pageGuard(pageFile, m_out);
+	if (!m_out) {
+		throw std::runtime_error("Could not open " + pageFile.string() + " for writing");
+	}
+	m_opacities = {255};
+	m_style.m_fillOpacity = 255;
+	m_statistics.clear();
+
+	std::vector<std::string> layers;
+	for (const auto& painting : m_paintings) {
 		pushStyle();
-		if (auto name = painting.name) {
-			m_page->addLayer(name->c_str());
-		} else {
-			m_page->addLayer();
-		}
-		m_layer = m_page->countLayers() - 1;
-		painting.m_painting->paint(*this);
+		// Ipe layers need a name.
+		m_layer = painting.name ? *painting.name : "layer" + std::to_string(layers.size() + 1);
+		layers.push_back(m_layer);
+		m_layerPending = true;
+		RenderStatistics& statistics = m_statistics.emplace_back();
+		statistics.m_name = m_layer;
+		std::streamoff bytes = m_out.tellp();
+		Timer timer;
+		StatisticsRenderer counter(*this, statistics);
+		painting.m_painting->paint(counter);
 		popStyle();
+		statistics.m_time = timer.peek();
+		statistics.m_bytes = static_cast<size_t>(m_out.tellp() - bytes);
+	}
+	m_out.close();
+	if (!m_out) {
+		throw std::runtime_error("Could not write " + pageFile.string());
+	}
+
+	std::ofstream out(file, std::ios::binary);
+	if (!out) {
+		throw std::runtime_error("Could not open " + file.string() + " for writing");
+	}
+	out << "<?xml version=\"1.0\"?>\n"
+	       "<!DOCTYPE ipe SYSTEM \"ipe.dtd\">\n"
+	       "<ipe version=\"70206\" creator=\"CartoCrow\">\n";
+	out << DISK_MARK_DEFINITION << PAPER_SIZE_DEFINITION;
+	out << "<ipestyle name=\"alpha-values\">\n";
+	for (int alpha : m_opacities) {
+		char value[32];
+		auto [end, error] = std::to_chars(value, value + sizeof(value), alpha / 255.0,
+		                                  std::chars_format::fixed, 3);
+		out << "<opacity name=\"" << alpha << "\" value=\"" << std::string_view(value, end - value)
+		    << "\"/>\n";
+	}
+	out << "</ipestyle>\n";
+	out << "<page>\n";
+	for (const std::string& layer : layers) {
+		out << "<layer name=\"" << escapeForXml(layer) << "\"/>\n";
+	}
+	if (!layers.empty()) {
+		out << "<view layers=\"";
+		for (size_t i = 0; i < layers.size(); ++i) {
+			out << (i > 0 ? " " : "") << escapeForXml(layers[i]);
+		}
+		out << "\" active=\"" << escapeForXml(layers.front()) << "\"/>\n";
+	}
+	{
+		std::ifstream page(pageFile, std::ios::binary);
+		if (page.peek() != std::ifstream::traits_type::eof()) {
+			out << page.rdbuf();
+		}
+	}
+	out << "</page>\n"
+	       "</ipe>\n";
+	out.close();
+	if (!out) {
+		throw std::runtime_error("Could not write " + file.string());
+	}
+}
+
+const std::vector<RenderStatistics>& IpeRenderer::statistics() const {
+	return m_statistics;
+}
+
+void IpeRenderer::saveStatistics(const std::filesystem::path& file) const {
+	RenderStatistics::saveJson(file, m_statistics);
+}
+
+void IpeRenderer::writeNumber(double value) {
+	if (value == 0) {
+		value = 0; // avoid writing "-0"
+	}
+	// Ipe does not read exponents, so write in fixed notation, with as many
+	// digits as needed to read back the same value. The buffer is large
+	// enough for any finite double.
+	char buffer[512];
+	auto [end, error] = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::fixed);
+	m_out.write(buffer, end - buffer);
+}
+
+void IpeRenderer::writePoint(const Point<Inexact>& p) {
+	writeNumber(p.x());
+	m_out.put(' ');
+	writeNumber(p.y());
+}
+
+void IpeRenderer::writeColor(const Color& color) {
+	m_out << formatColor(color);
+}
+
+void IpeRenderer::writeLayer() {
+	if (m_layerPending) {
+		m_out << " layer=\"" << escapeForXml(m_layer) << "\"";
+		m_layerPending = false;
 	}
+}
 
-	document.push_back(m_page);
-	document.save(file.string().c_str(), ipe::FileFormat::Xml, 0);
+void IpeRenderer::writeStroke() {
+	m_out << " stroke=\"";
+	writeColor(m_style.m_strokeColor);
+	m_out << "\"";
+}
+
+void IpeRenderer::beginPath(bool filled) {
+	// Ipe derives whether a path is stroked and filled from which of these
+	// attributes are present.
+	filled = filled && (m_style.m_mode & GeometryRenderer::fill);
+	m_out << "<path";
+	writeLayer();
+	if (!filled || (m_style.m_mode & GeometryRenderer::stroke)) {
+		writeStroke();
+	}
+	if (filled) {
+		m_out << " fill=\"";
+		writeColor(m_style.m_fillColor);
+		m_out << "\"";
+	}
+	m_out << " pen=\"";
+	writeNumber(m_style.m_strokeWidth);
+	m_out << "\" opacity=\"" << m_style.m_fillOpacity << "\">\n";
+}
+
+void IpeRenderer::endPath() {
+	m_out << "</path>\n";
+}
+
+template <class InputIterator>
+void IpeRenderer::writeCurve(InputIterator begin, InputIterator end, bool closed) {
+	bool first = true;
+	for (auto v = begin; v != end; ++v) {
+		writePoint(*v);
+		m_out << (first ? " m\n" : " l\n");
+		first = false;
+	}
+	if (closed && !first) {
+		m_out << "h\n";
+	}
 }
 
 void IpeRenderer::draw(const Point<Inexact>& p) {
-	ipe::Vector vector(p.x(), p.y());
-	ipe::Attribute name = ipe::Attribute(true, "mark/fdisk(sfx)");
-	ipe::Reference* reference = new ipe::Reference(getAttributesForStyle(), name, vector);
-	m_page->append(ipe::TSelect::ENotSelected, m_layer, reference);
+	m_out << "<use";
+	writeLayer();
+	writeStroke();
+	m_out << " name=\"mark/fdisk(sfx)\" pos=\"";
+	writePoint(p);
+	m_out << "\" fill=\"";
+	writeColor(m_style.m_fillColor);
+	m_out << "\"/>\n";
 }
 
 void IpeRenderer::draw(const Segment<Inexact>& s) {
-	ipe::Curve* curve = new ipe::Curve();
-	curve->appendSegment(ipe::Vector(s.start().x(), s.start().y()),
-	                     ipe::Vector(s.end().x(), s.end().y()));
-	ipe::Shape* shape = new ipe::Shape();
-	shape->appendSubPath(curve);
-	ipe::Path* path = new ipe::Path(getAttributesForStyle(), *shape);
-	m_page->append(ipe::TSelect::ENotSelected, m_layer, path);
+	beginPath();
+	writePoint(s.start());
+	m_out << " m\n";
+	writePoint(s.end());
+	m_out << " l\n";
+	endPath();
 
 	if (m_style.m_mode & vertices) {
 		draw(s.start());
@@ -156,12 +317,12 @@ void IpeRenderer::draw(const Ray<Inexact>& r) {
 	}
 }
 
-void IpeRenderer::draw(const Polyline<Inexact>& p) {
-	ipe::Curve* curve = convertPolylineToCurve(p);
-	ipe::Shape* shape = new ipe::Shape();
-	shape->appendSubPath(curve);
-	ipe::Path* path = new ipe::Path(getAttributesForStyle(), *shape);
-	m_page->append(ipe::TSelect::ENotSelected, m_layer, path);
+void IpeRenderer::draw(const Polyline<Inexact>& polyline) {
+	Polyline<Inexact> simplified;
+	const Polyline<Inexact>& p = *applyLod(polyline, simplified);
+	beginPath();
+	writeCurve(p.vertices_begin(), p.vertices_end(), false);
+	endPath();
 
 	if (m_style.m_mode & vertices) {
 		for (auto v = p.vertices_begin(); v != p.vertices_end(); v++) {
@@ -170,36 +331,41 @@ void IpeRenderer::draw(const Polyline<Inexact>& p) {
 	}
 }
 
-void IpeRenderer::draw(const Polygon<Inexact>& p) {
-	ipe::Curve* curve = convertPolygonToCurve(p);
-	ipe::Shape* shape = new ipe::Shape();
-	shape->appendSubPath(curve);
-	ipe::Path* path = new ipe::Path(getAttributesForStyle(), *shape);
-	m_page->append(ipe::TSelect::ENotSelected, m_layer, path);
+void IpeRenderer::draw(const Polygon<Inexact>& polygon) {
+	Polygon<Inexact> simplified;
+	const Polygon<Inexact>* p = applyLod(polygon, simplified);
+	if (!p) {
+		return;
+	}
+	beginPath();
+	writeCurve(p->vertices_begin(), p->vertices_end(), true);
+	endPath();
 
 	if (m_style.m_mode & vertices) {
-		for (auto v = p.vertices_begin(); v != p.vertices_end(); v++) {
+		for (auto v = p->vertices_begin(); v != p->vertices_end(); v++) {
 			draw(*v);
 		}
 	}
 }
 
-void IpeRenderer::draw(const PolygonWithHoles<Inexact>& p) {
-	ipe::Curve* curve = convertPolygonToCurve(p.outer_boundary());
-	ipe::Shape* shape = new ipe::Shape();
-	shape->appendSubPath(curve);
-	for (auto hole : p.holes()) {
-		ipe::Curve* holeCurve = convertPolygonToCurve(hole);
-		shape->appendSubPath(holeCurve);
+void IpeRenderer::draw(const PolygonWithHoles<Inexact>& polygon) {
+	PolygonWithHoles<Inexact> simplified;
+	const PolygonWithHoles<Inexact>* p = applyLod(polygon, simplified);
+	if (!p) {
+		return;
+	}
+	beginPath();
+	writeCurve(p->outer_boundary().vertices_begin(), p->outer_boundary().vertices_end(), true);
+	for (const auto& hole : p->holes()) {
+		writeCurve(hole.vertices_begin(), hole.vertices_end(), true);
 	}
-	ipe::Path* path = new ipe::Path(getAttributesForStyle(), *shape);
-	m_page->append(ipe::TSelect::ENotSelected, m_layer, path);
+	endPath();
 
 	if (m_style.m_mode & vertices) {
-		for (auto v = p.outer_boundary().vertices_begin(); v != p.outer_boundary().vertices_end(); v++) {
+		for (auto v = p->outer_boundary().vertices_begin(); v != p->outer_boundary().vertices_end(); v++) {
 			draw(*v);
 		}
-		for (auto h = p.holes_begin(); h != p.holes_end(); h++) {
+		for (auto h = p->holes_begin(); h != p->holes_end(); h++) {
 			for (auto v = h->vertices_begin(); v != h->vertices_end(); v++) {
 				draw(*v);
 			}
@@ -209,32 +375,35 @@ void IpeRenderer::draw(const PolygonWithHoles<Inexact>& p) {
 
 void IpeRenderer::draw(const Circle<Inexact>& c) {
 	double r = sqrt(c.squared_radius());
-	ipe::Matrix matrix =
-	    ipe::Matrix(ipe::Vector(c.center().x(), c.center().y())) * ipe::Linear(r, 0, 0, r);
-	ipe::Ellipse* ellipse = new ipe::Ellipse(matrix);
-	ipe::Shape* shape = new ipe::Shape();
-	shape->appendSubPath(ellipse);
-	ipe::Path* path = new ipe::Path(getAttributesForStyle(), *shape);
-	m_page->append(ipe::TSelect::ENotSelected, m_layer, path);
+	beginPath();
+	writeNumber(r);
+	m_out << " 0 0 ";
+	writeNumber(r);
+	m_out << ' ';
+	writePoint(c.center());
+	m_out << " e\n";
+	endPath();
 }
 
 void IpeRenderer::draw(const BezierSpline& s) {
-	ipe::Curve* curve = new ipe::Curve();
-	for (BezierCurve c : s.curves()) {
-		std::vector<ipe::Vector> coords;
-		coords.emplace_back(c.source().x(), c.source().y());
-		coords.emplace_back(c.sourceControl().x(), c.sourceControl().y());
-		coords.emplace_back(c.targetControl().x(), c.targetControl().y());
-		coords.emplace_back(c.target().x(), c.target().y());
-		curve->appendSpline(coords);
-	}
-	ipe::Shape* shape = new ipe::Shape();
-	shape->appendSubPath(curve);
-	ipe::Path* path = new ipe::Path(getAttributesForStyle(), *shape);
-	m_page->append(ipe::TSelect::ENotSelected, m_layer, path);
+	if (s.curves().empty()) {
+		return;
+	}
+	beginPath();
+	writePoint(s.curves().front().source());
+	m_out << " m\n";
+	for (const BezierCurve& c : s.curves()) {
+		writePoint(c.sourceControl());
+		m_out << ' ';
+		writePoint(c.targetControl());
+		m_out << ' ';
+		writePoint(c.target());
+		m_out << " c\n";
+	}
+	endPath();
 
 	if (m_style.m_mode & vertices) {
-		for (BezierCurve c : s.curves()) {
+		for (const BezierCurve& c : s.curves()) {
 			draw(c.source());
 		}
 		draw(s.curves().back().target());
@@ -244,27 +413,127 @@ void IpeRenderer::draw(const BezierSpline& s) {
 void IpeRenderer::draw(const CircularArc& a) {
 	// Extract data from the CircularArc
 	const Circle<Inexact>& circle = a.circle();
-	const double cx = circle.center().x();
-	const double cy = circle.center().y();
+	const Point<Inexact> center = circle.center();
 	const double r = sqrt(circle.squared_radius());
 	const double startAngle = a.startAngle();
 	const double endAngle = startAngle + a.spanAngle();
 
-	ipe::Shape* shape = new ipe::Shape(ipe::Vector(cx, cy), r, startAngle, endAngle);
-	ipe::Path* path = new ipe::Path(getAttributesForStyle(), *shape);
+	beginPath(false);
+	if (std::abs(a.spanAngle()) >= 2 * M_PI) {
+		writeNumber(r);
+		m_out << " 0 0 ";
+		writeNumber(r);
+		m_out << ' ';
+		writePoint(center);
+		m_out << " e\n";
+	} else {
+		// Ipe arcs run counter-clockwise in the coordinate system of their
+		// matrix, so clockwise arcs use a mirrored matrix.
+		const double mirror = a.spanAngle() < 0 ? -1 : 1;
+		writePoint(Point<Inexact>(center.x() + r * cos(startAngle), center.y() + r * sin(startAngle)));
+		m_out << " m\n";
+		writeNumber(r);
+		m_out << " 0 0 ";
+		writeNumber(mirror * r);
+		m_out << ' ';
+		writePoint(center);
+		m_out << ' ';
+		writePoint(Point<Inexact>(center.x() + r * cos(endAngle), center.y() + r * sin(endAngle)));
+		m_out << " a\n";
+	}
+	endPath();
+}
+
+void IpeRenderer::drawPoints(std::span<const Point<Inexact>> points) {
+	if (points.empty()) {
+		return;
+	}
+	// Ipe has no way to share a mark between points, so every point gets the
+	// same mark as in draw(const Point<Inexact>&); only the colors are
+	// formatted once. The first point writes the layer, if needed.
+	draw(points.front());
+	const std::string stroke = formatColor(m_style.m_strokeColor);
+	const std::string fill = formatColor(m_style.m_fillColor);
+	for (const Point<Inexact>& p : points.subspan(1)) {
+		m_out << "<use stroke=\"" << stroke << "\" name=\"mark/fdisk(sfx)\" pos=\"";
+		writePoint(p);
+		m_out << "\" fill=\"" << fill << "\"/>\n";
+	}
+}
 
-	// Add the arc to the current page
-	m_page->append(ipe::TSelect::ENotSelected, m_layer, path);
+void IpeRenderer::drawSegments(std::span<const Segment<Inexact>> segments) {
+	if (segments.empty()) {
+		return;
+	}
+	beginPath();
+	for (const Segment<Inexact>& s : segments) {
+		writePoint(s.start());
+		m_out << " m\n";
+		writePoint(s.end());
+		m_out << " l\n";
+	}
+	endPath();
 
+	if (m_style.m_mode & vertices) {
+		std::vector<Point<Inexact>> points;
+		points.reserve(2 * segments.size());
+		for (const Segment<Inexact>& s : segments) {
+			points.push_back(s.start());
+			points.push_back(s.end());
+		}
+		drawPoints(points);
+	}
+}
+
+void IpeRenderer::drawPolygons(std::span<const Polygon<Inexact>> polygons) {
+	if (polygons.empty()) {
+		return;
+	}
+	beginPath();
+	Polygon<Inexact> simplified;
+	for (const Polygon<Inexact>& polygon : polygons) {
+		if (const Polygon<Inexact>* p = applyLod(polygon, simplified)) {
+			writeCurve(p->vertices_begin(), p->vertices_end(), true);
+		}
+	}
+	endPath();
+
+	if (m_style.m_mode & vertices) {
+		std::vector<Point<Inexact>> points;
+		for (const Polygon<Inexact>& polygon : polygons) {
+			if (const Polygon<Inexact>* p = applyLod(polygon, simplified)) {
+				points.insert(points.end(), p->vertices_begin(), p->vertices_end());
+			}
+		}
+		drawPoints(points);
+	}
+}
+
+void IpeRenderer::drawCircles(std::span<const Circle<Inexact>> circles) {
+	if (circles.empty()) {
+		return;
+	}
+	beginPath();
+	for (const Circle<Inexact>& c : circles) {
+		double r = sqrt(c.squared_radius());
+		writeNumber(r);
+		m_out << " 0 0 ";
+		writeNumber(r);
+		m_out << ' ';
+		writePoint(c.center());
+		m_out << " e\n";
+	}
+	endPath();
 }
 
 void IpeRenderer::drawText(const Point<Inexact>& p, const std::string& text) {
-	ipe::String labelText = escapeForLaTeX(text).data();
-	ipe::Text* label = new ipe::Text(getAttributesForStyle(), labelText,
-	                                 ipe::Vector(p.x(), p.y()), ipe::Text::TextType::ELabel);
-	label->setHorizontalAlignment(ipe::THorizontalAlignment::EAlignHCenter);
-	label->setVerticalAlignment(ipe::TVerticalAlignment::EAlignVCenter);
-	m_page->append(ipe::TSelect::ENotSelected, m_layer, label);
+	m_out << "<text";
+	writeLayer();
+	writeStroke();
+	m_out << " transformations=\"translations\" pos=\"";
+	writePoint(p);
+	m_out << "\" type=\"label\" halign=\"center\" valign=\"center\">"
+	      << escapeForXml(escapeForLaTeX(text)) << "</text>\n";
 }
 
 void IpeRenderer::pushStyle() {
@@ -281,72 +550,25 @@ void IpeRenderer::setMode(int mode) {
 }
 
 void IpeRenderer::setStroke(Color color, double width) {
-	const double factor = 1000.0 / 255.0;
-	m_style.m_strokeColor = ipe::Color(color.r * factor, color.g * factor, color.b * factor);
+	m_style.m_strokeColor = color;
 	m_style.m_strokeWidth = width;
 }
 
-ipe::Attribute IpeRenderer::opacity_attribute(int alpha) {
-	// Ipe does not allow arbitrary opacity values; it only allows symbolic
-	// references to alpha values from the stylesheet.
-	// Therefore, we check if the requested opacity value already exists. If
-	// not, we add it to the stylesheet.
-	ipe::Attribute name = ipe::Attribute(true, std::to_string(alpha).data());
-	if (!m_alphaSheet->has(ipe::Kind::EOpacity, name)) {
-		m_alphaSheet->add(ipe::Kind::EOpacity, name,
-		                  ipe::Attribute(ipe::Fixed::fromDouble(alpha / 255.0)));
-	}
-	return name;
-}
-
 void IpeRenderer::setStrokeOpacity(int alpha) {
-	auto name = opacity_attribute(alpha);
-	m_style.m_strokeOpacity = name;
+	// Ipe does not allow arbitrary opacity values; it only allows symbolic
+	// references to alpha values from the stylesheet. Therefore, we record
+	// every opacity value used, and add them to the stylesheet when saving.
+	m_opacities.insert(alpha);
+	m_style.m_strokeOpacity = alpha;
 }
 
 void IpeRenderer::setFill(Color color) {
-	const double factor = 1000.0 / 255.0;
-	m_style.m_fillColor = ipe::Color(color.r * factor, color.g * factor, color.b * factor);
+	m_style.m_fillColor = color;
 }
 
 void IpeRenderer::setFillOpacity(int alpha) {
-	auto name = opacity_attribute(alpha);
-	m_style.m_fillOpacity = name;
-}
-
-ipe::Curve* IpeRenderer::convertPolygonToCurve(const Polygon<Inexact>& p) const {
-	ipe::Curve* curve = new ipe::Curve();
-	for (auto edge = p.edges_begin(); edge != p.edges_end(); edge++) {
-		curve->appendSegment(ipe::Vector(edge->start().x(), edge->start().y()),
-		                     ipe::Vector(edge->end().x(), edge->end().y()));
-	}
-	curve->setClosed(true);
-	return curve;
-}
-
-ipe::Curve* IpeRenderer::convertPolylineToCurve(const Polyline<Inexact>& p) const {
-	ipe::Curve* curve = new ipe::Curve();
-	for (auto edge = p.edges_begin(); edge != p.edges_end(); edge++) {
-		curve->appendSegment(ipe::Vector(edge->start().x(), edge->start().y()),
-		                     ipe::Vector(edge->end().x(), edge->end().y()));
-	}
-	return curve;
-}
-
-ipe::AllAttributes IpeRenderer::getAttributesForStyle() const {
-	ipe::AllAttributes attributes;
-	if ((m_style.m_mode & GeometryRenderer::fill) && (m_style.m_mode & GeometryRenderer::stroke)) {
-		attributes.iPathMode = ipe::TPathMode::EStrokedAndFilled;
-	} else if (m_style.m_mode & GeometryRenderer::fill) {
-		attributes.iPathMode = ipe::TPathMode::EFilledOnly;
-	} else {
-		attributes.iPathMode = ipe::TPathMode::EStrokedOnly;
-	}
-	attributes.iPen = ipe::Attribute(ipe::Fixed::fromDouble(m_style.m_strokeWidth));
-	attributes.iStroke = ipe::Attribute(ipe::Color(m_style.m_strokeColor));
-	attributes.iFill = ipe::Attribute(ipe::Color(m_style.m_fillColor));
-	attributes.iOpacity = m_style.m_fillOpacity;
-	return attributes;
+	m_opacities.insert(alpha);
+	m_style.m_fillOpacity = alpha;
 }
 
 void IpeRenderer::addPainting(const std::shared_ptr<GeometryPainting>& painting) {
@@ -391,4 +613,28 @@ std::string IpeRenderer::escapeForLaTeX(const std::string& text) const {
 	return result;
 }
 
+std::string IpeRenderer::escapeForXml(std::string_view text) const {
+	std::string result;
+	result.reserve(text.size());
+	for (char c : text) {
+		switch (c) {
+		case '<':
+			result += "&lt;";
+			break;
+		case '>':
+			result += "&gt;";
+			break;
+		case '&':
+			result += "&amp;";
+			break;
+		case '"':
+			result += "&quot;";
+			break;
+		default:
+			result.push_back(c);
+		}
+	}
+	return result;
+}
+
 } // namespace cartocrow::renderer
@@ -20,14 +20,17 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #ifndef CARTOCROW_RENDERER_IPE_RENDERER_H
 #define CARTOCROW_RENDERER_IPE_RENDERER_H
 
-#include <ipeattributes.h>
-#include <ipelib.h>
-
 #include <filesystem>
+#include <fstream>
+#include <optional>
+#include <set>
 #include <stack>
+#include <string>
+#include <string_view>
 
 #include "geometry_painting.h"
 #include "geometry_renderer.h"
+#include "render_statistics.h"
 
 namespace cartocrow::renderer {
 
@@ -38,14 +41,15 @@ struct IpeRendererStyle {
 	/// The diameter of points.
 	double m_pointSize = 10;
 	/// The color of points and lines.
-	ipe::Color m_strokeColor = ipe::Color(0, 0, 0);
+	Color m_strokeColor{0, 0, 0};
 	/// The width of lines.
 	double m_strokeWidth = 1;
 	/// The color of filled shapes.
-	ipe::Color m_fillColor = ipe::Color(0, 102, 203);
-	/// The opacity of filled shapes, as a symbolic Ipe attribute.
-	ipe::Attribute m_fillOpacity;
-	ipe::Attribute m_strokeOpacity;
+	Color m_fillColor{0, 102, 203};
+	/// The opacity of filled shapes, between 0 and 255.
+	int m_fillOpacity = 255;
+	/// The opacity of points and lines, between 0 and 255.
+	int m_strokeOpacity = 255;
 };
 
 /// Ipe specialization of the GeometryRenderer.
@@ -54,14 +58,15 @@ struct IpeRendererStyle {
  * the painting to a file. \ref save() can be called more than one time (for
  * example after changing the painting) if desired.
  *
- * ## Ipelib
+ * ## Streaming
  *
- * Ipelib works with raw pointers a lot. In general, after adding an object to
- * a parent (for example, adding a page to a document), the parent takes
- * possession of the added object. This means that the parent's destructor will
- * also delete the added object. Because of this behavior, IpeRenderer
- * unavoidably has several methods that return raw pointers to newly allocated
- * objects.
+ * IpeRenderer writes Ipe's XML file format itself, rather than building an
+ * `ipe::Document` in memory. Objects are written to the file as soon as they
+ * are drawn, so memory use does not grow with the size of the drawing. Ipe
+ * needs the opacity values used in the drawing to be declared in a style sheet
+ * before the page, and these are only known after drawing, so the page is first
+ * written to a temporary file next to the output, and copied into place at the
+ * end. The temporary file is removed, also if drawing throws an exception.
  *
  * ## Rendering strings
  *
@@ -79,8 +84,16 @@ class IpeRenderer : public GeometryRenderer {
 	IpeRenderer(const std::shared_ptr<GeometryPainting>& painting, const std::string& name);
 
 	/// Saves the painting to an Ipe file with the given name.
+	///
+	/// Throws a `std::runtime_error` if the file cannot be written.
 	void save(const std::filesystem::path& file);
 
+	/// Returns statistics about drawing each painting in the last call to
+	/// \ref save().
+	const std::vector<RenderStatistics>& statistics() const;
+	/// Writes the \ref statistics() to a JSON file.
+	void saveStatistics(const std::filesystem::path& file) const;
+
 	void draw(const Point<Inexact>& p) override;
 	void draw(const Segment<Inexact>& s) override;
 	void draw(const Polygon<Inexact>& p) override;
@@ -91,6 +104,10 @@ class IpeRenderer : public GeometryRenderer {
 	void draw(const Ray<Inexact>& r) override;
 	void draw(const Polyline<Inexact>& p) override;
 	void draw(const CircularArc& a) override;
+	void drawPoints(std::span<const Point<Inexact>> points) override;
+	void drawSegments(std::span<const Segment<Inexact>> segments) override;
+	void drawPolygons(std::span<const Polygon<Inexact>> polygons) override;
+	void drawCircles(std::span<const Circle<Inexact>> circles) override;
 	void drawText(const Point<Inexact>& p, const std::string& text) override;
 
 	void pushStyle() override;
@@ -105,19 +122,32 @@ class IpeRenderer : public GeometryRenderer {
 	void addPainting(const std::shared_ptr<GeometryPainting>& painting, const std::string& name);
 
   private:
-	/// Converts a polygon to an Ipe curve.
-	ipe::Curve* convertPolygonToCurve(const Polygon<Inexact>& p) const;
-	/// Converts a polyline to an Ipe curve.
-	ipe::Curve* convertPolylineToCurve(const Polyline<Inexact>& p) const;
-	/// Returns Ipe attributes to style an Ipe path with the current style.
-	ipe::AllAttributes getAttributesForStyle() const;
+	/// Starts a `<path>` element in the current style, up to and including the
+	/// newline after its opening tag.
+	void beginPath(bool filled = true);
+	/// Ends a `<path>` element started with \ref beginPath().
+	void endPath();
+	/// Writes the path construction operators of the given points to the
+	/// output.
+	template <class InputIterator>
+	void writeCurve(InputIterator begin, InputIterator end, bool closed);
+	/// Writes the layer attribute, if this is the first object in the layer.
+	void writeLayer();
+	/// Writes the stroke attribute of the current style.
+	void writeStroke();
+	/// Writes a number to the output in fixed notation, independent of the
+	/// locale.
+	void writeNumber(double value);
+	/// Writes a point to the output, as two numbers separated by a space.
+	void writePoint(const Point<Inexact>& p);
+	/// Writes a color to the output, as Ipe's three numbers between 0 and 1.
+	void writeColor(const Color& color);
 	/// Escapes LaTeX's [reserved characters](https://latexref.xyz/Reserved-characters.html)
 	/// `# $ % & { } _ ~ ^ \` so that the resulting string can safely be used in
 	/// an Ipe file.
 	std::string escapeForLaTeX(const std::string& text) const;
-	/// Get the attribute for an opacity value.
-	/// If there is not yet an attribute for this opacity then it is created and added to the alpha sheet.
-	ipe::Attribute opacity_attribute(int alpha);
+	/// Escapes XML's reserved characters.
+	std::string escapeForXml(std::string_view text) const;
 
 	struct DrawnPainting {
 		/// The painting itself.
@@ -128,21 +158,25 @@ class IpeRenderer : public GeometryRenderer {
 
 	/// The paintings we're drawing.
 	std::vector<DrawnPainting> m_paintings;
+	/// Statistics about drawing each painting in \ref m_paintings.
+	std::vector<RenderStatistics> m_statistics;
 	/// The current drawing style.
 	IpeRendererStyle m_style;
 	/// A stack of drawing styles, used by \ref pushStyle() and \ref popStyle()
 	/// to store previously pushed styles.
 	std::stack<IpeRendererStyle> m_styleStack;
-	/// The page we are drawing to. Only valid while drawing (in \ref save()).
-	/**
-	 * Ipelib deletes pages when the Document is destructed, so we need to
-     * avoid destructing pages ourselves.
-     */
-	ipe::Page* m_page;
-	/// Ipe style sheet with the alpha values in this drawing.
-	ipe::StyleSheet* m_alphaSheet;
-	/// The index of the Ipe layer we are currently drawing to.
-	int m_layer;
+	/// The temporary file the page is written to. Only open while drawing (in
+	/// \ref save()).
+	std::ofstream m_out;
+	/// The opacity values used in the drawing, which are written to the alpha
+	/// style sheet.
+	std::set<int> m_opacities;
+	/// The name of the Ipe layer we are currently drawing to.
+	std::string m_layer;
+	/// Whether the next object is the first one in \ref m_layer. Ipe objects
+	/// without a layer attribute are put in the layer of the previous object,
+	/// so only the first object in each layer needs one.
+	bool m_layerPending = false;
 };
 
 } // namespace cartocrow::renderer
@@ -0,0 +1,54 @@
+/*
+The CartoCrow library implements algorithmic geo-visualization methods,
+developed at TU Eindhoven.
+Copyright (C) 2021  Netherlands eScience Center and TU Eindhoven
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef CARTOCROW_RENDERER_PAINTER_PATH_H
+#define CARTOCROW_RENDERER_PAINTER_PATH_H
+
+#include <QPainterPath>
+#include <QPointF>
+
+#include "../core/core.h"
+
+namespace cartocrow::renderer {
+
+/// Adds the polygon to the QPainterPath as a closed subpath, converting each
+/// vertex to Qt coordinates with \p convert.
+template <typename Convert>
+void addPolygonToPath(QPainterPath& path, const Polygon<Inexact>& p, Convert convert) {
+	for (auto vertex = p.vertices_begin(); vertex != p.vertices_end(); vertex++) {
+		if (vertex == p.vertices_begin()) {
+			path.moveTo(convert(*vertex));
+		} else {
+			path.lineTo(convert(*vertex));
+		}
+	}
+	path.closeSubpath();
+}
+
+/// Adds the polygon to the QPainterPath as a closed subpath, keeping its
+/// coordinates.
+inline void addPolygonToPath(QPainterPath& path, const Polygon<Inexact>& p) {
+	addPolygonToPath(path, p, [](const Point<Inexact>& vertex) {
+		return QPointF(vertex.x(), vertex.y());
+	});
+}
+
+} // namespace cartocrow::renderer
+
+#endif //CARTOCROW_RENDERER_PAINTER_PATH_H
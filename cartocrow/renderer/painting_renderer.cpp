@@ -19,121 +19,427 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 #include "painting_renderer.h"
 
-#include <variant>
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
 
 namespace cartocrow::renderer {
 
+namespace {
+
+/// Identifies files written by \ref PaintingRenderer::save().
+constexpr char FILE_MAGIC[4] = {'C', 'C', 'P', 'R'};
+/// Version of the file format written by \ref PaintingRenderer::save().
+constexpr uint32_t FILE_VERSION = 1;
+
+template <class T> void write(std::ostream& out, const T& value) {
+	out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <class T> T read(std::istream& in) {
+	T value;
+	in.read(reinterpret_cast<char*>(&value), sizeof(T));
+	if (!in) {
+		throw std::runtime_error("Unexpected end of painting file");
+	}
+	return value;
+}
+
+/// Returns the number of bytes between the read position and the end of the
+/// stream.
+uint64_t bytesLeft(std::istream& in) {
+	std::streampos position = in.tellg();
+	in.seekg(0, std::ios::end);
+	std::streampos end = in.tellg();
+	in.seekg(position);
+	if (!in || position < 0 || end < position) {
+		throw std::runtime_error("Could not determine the size of the painting file");
+	}
+	return static_cast<uint64_t>(end - position);
+}
+
+/// Size of a command in the file: an opcode, an offset and a count.
+constexpr uint64_t COMMAND_SIZE = sizeof(uint8_t) + 2 * sizeof(uint32_t);
+
+} // namespace
+
 PaintingRenderer::PaintingRenderer() {}
 
 void PaintingRenderer::paint(GeometryRenderer& renderer) const {
-	for (auto& object : m_objects) {
-		if (std::holds_alternative<Point<Inexact>>(object)) {
-			renderer.draw(std::get<Point<Inexact>>(object));
-		} else if (std::holds_alternative<Segment<Inexact>>(object)) {
-			renderer.draw(std::get<Segment<Inexact>>(object));
-		} else if (std::holds_alternative<Polygon<Inexact>>(object)) {
-			renderer.draw(std::get<Polygon<Inexact>>(object));
-		} else if (std::holds_alternative<PolygonWithHoles<Inexact>>(object)) {
-			renderer.draw(std::get<PolygonWithHoles<Inexact>>(object));
-		} else if (std::holds_alternative<Circle<Inexact>>(object)) {
-			renderer.draw(std::get<Circle<Inexact>>(object));
-		} else if (std::holds_alternative<BezierSpline>(object)) {
-			renderer.draw(std::get<BezierSpline>(object));
-		} else if (std::holds_alternative<Line<Inexact>>(object)) {
-			renderer.draw(std::get<Line<Inexact>>(object));
-		} else if (std::holds_alternative<Ray<Inexact>>(object)) {
-			renderer.draw(std::get<Ray<Inexact>>(object));
-		} else if (std::holds_alternative<Polyline<Inexact>>(object)) {
-			renderer.draw(std::get<Polyline<Inexact>>(object));
-		} else if (std::holds_alternative<Label>(object)) {
-			renderer.drawText(std::get<Label>(object).first, std::get<Label>(object).second);
-		} else if (std::holds_alternative<Style>(object)) {
-			Style style = std::get<Style>(object);
-			renderer.setFill(style.m_fillColor);
-			renderer.setFillOpacity(style.m_fillOpacity);
-			renderer.setStroke(style.m_strokeColor, style.m_strokeWidth);
-			renderer.setMode(style.m_mode);
+	auto vertices = [this](const Command& command) {
+		std::vector<Point<Inexact>> result;
+		result.reserve(command.m_count);
+		const double* x = m_coordinates.data() + command.m_offset;
+		for (uint32_t i = 0; i < command.m_count; ++i) {
+			result.emplace_back(x[2 * i], x[2 * i + 1]);
+		}
+		return result;
+	};
+	auto ring = [&vertices](const Command& command) {
+		auto points = vertices(command);
+		return Polygon<Inexact>(points.begin(), points.end());
+	};
+
+	// styles that the painting leaves pushed are popped at the end, so that
+	// the style stack of the renderer is left as it was
+	int depth = 0;
+	for (size_t i = 0; i < m_commands.size(); ++i) {
+		const Command& command = m_commands[i];
+		const double* x = m_coordinates.data() + command.m_offset;
+		switch (command.m_opcode) {
+		case Opcode::POINT:
+			renderer.draw(Point<Inexact>(x[0], x[1]));
+			break;
+		case Opcode::SEGMENT:
+			renderer.draw(Segment<Inexact>(Point<Inexact>(x[0], x[1]), Point<Inexact>(x[2], x[3])));
+			break;
+		case Opcode::POLYGON:
+			renderer.draw(ring(command));
+			break;
+		case Opcode::POLYGON_WITH_HOLES: {
+			Polygon<Inexact> outer = ring(m_commands[++i]);
+			std::vector<Polygon<Inexact>> holes;
+			for (uint32_t h = 0; h < command.m_count; ++h) {
+				holes.push_back(ring(m_commands[++i]));
+			}
+			renderer.draw(PolygonWithHoles<Inexact>(outer, holes.begin(), holes.end()));
+			break;
+		}
+		case Opcode::RING:
+			// only occurs after POLYGON_WITH_HOLES, which consumes it
+			break;
+		case Opcode::CIRCLE:
+			renderer.draw(Circle<Inexact>(Point<Inexact>(x[0], x[1]), x[2]));
+			break;
+		case Opcode::BEZIER_SPLINE: {
+			BezierSpline spline;
+			Point<Inexact> source(x[0], x[1]);
+			for (uint32_t c = 0; c < command.m_count; ++c) {
+				const double* curve = x + 2 + 6 * c;
+				Point<Inexact> target(curve[4], curve[5]);
+				spline.appendCurve(source, Point<Inexact>(curve[0], curve[1]),
+				                   Point<Inexact>(curve[2], curve[3]), target);
+				source = target;
+			}
+			renderer.draw(spline);
+			break;
+		}
+		case Opcode::LINE:
+			renderer.draw(Line<Inexact>(x[0], x[1], x[2]));
+			break;
+		case Opcode::RAY:
+			renderer.draw(Ray<Inexact>(Point<Inexact>(x[0], x[1]), Vector<Inexact>(x[2], x[3])));
+			break;
+		case Opcode::POLYLINE:
+			renderer.draw(Polyline<Inexact>(vertices(command)));
+			break;
+		case Opcode::CIRCULAR_ARC:
+			renderer.draw(CircularArc(Circle<Inexact>(Point<Inexact>(x[0], x[1]), x[2]), x[3], x[4]));
+			break;
+		case Opcode::TEXT:
+			renderer.drawText(Point<Inexact>(x[0], x[1]), m_texts[command.m_count]);
+			break;
+		case Opcode::PUSH_STYLE:
+			renderer.pushStyle();
+			++depth;
+			break;
+		case Opcode::POP_STYLE:
+			renderer.popStyle();
+			--depth;
+			break;
+		case Opcode::STYLE:
+			renderer.setMode(command.m_count);
+			renderer.setStroke(Color{static_cast<int>(x[0]), static_cast<int>(x[1]), static_cast<int>(x[2])},
+			                   x[3]);
+			renderer.setStrokeOpacity(static_cast<int>(x[4]));
+			renderer.setFill(Color{static_cast<int>(x[5]), static_cast<int>(x[6]), static_cast<int>(x[7])});
+			renderer.setFillOpacity(static_cast<int>(x[8]));
+			break;
 		}
 	}
+	for (; depth > 0; --depth) {
+		renderer.popStyle();
+	}
+}
+
+void PaintingRenderer::add(Opcode opcode, uint32_t count, std::initializer_list<double> coordinates) {
+	m_commands.push_back(Command{opcode, static_cast<uint32_t>(m_coordinates.size()), count});
+	m_coordinates.insert(m_coordinates.end(), coordinates);
+}
+
+void PaintingRenderer::addStyle() {
+	add(Opcode::STYLE, static_cast<uint32_t>(m_style.m_mode),
+	    {static_cast<double>(m_style.m_strokeColor.r), static_cast<double>(m_style.m_strokeColor.g),
+	     static_cast<double>(m_style.m_strokeColor.b), m_style.m_strokeWidth,
+	     static_cast<double>(m_style.m_strokeOpacity), static_cast<double>(m_style.m_fillColor.r),
+	     static_cast<double>(m_style.m_fillColor.g), static_cast<double>(m_style.m_fillColor.b),
+	     static_cast<double>(m_style.m_fillOpacity)});
+}
+
+template <class InputIterator>
+void PaintingRenderer::addVertices(Opcode opcode, InputIterator begin, InputIterator end) {
+	uint32_t offset = static_cast<uint32_t>(m_coordinates.size());
+	uint32_t count = 0;
+	for (auto v = begin; v != end; ++v, ++count) {
+		m_coordinates.push_back(v->x());
+		m_coordinates.push_back(v->y());
+	}
+	m_commands.push_back(Command{opcode, offset, count});
 }
 
 void PaintingRenderer::draw(const Point<Inexact>& p) {
-	m_objects.push_back(p);
+	add(Opcode::POINT, 0, {p.x(), p.y()});
 }
 
 void PaintingRenderer::draw(const Segment<Inexact>& s) {
-	m_objects.push_back(s);
+	add(Opcode::SEGMENT, 0, {s.source().x(), s.source().y(), s.target().x(), s.target().y()});
 }
 
 void PaintingRenderer::draw(const Polygon<Inexact>& p) {
-	m_objects.push_back(p);
+	addVertices(Opcode::POLYGON, p.vertices_begin(), p.vertices_end());
 }
 
 void PaintingRenderer::draw(const PolygonWithHoles<Inexact>& p) {
-	m_objects.push_back(p);
+	add(Opcode::POLYGON_WITH_HOLES, static_cast<uint32_t>(p.number_of_holes()), {});
+	addVertices(Opcode::RING, p.outer_boundary().vertices_begin(), p.outer_boundary().vertices_end());
+	for (const auto& hole : p.holes()) {
+		addVertices(Opcode::RING, hole.vertices_begin(), hole.vertices_end());
+	}
 }
 
 void PaintingRenderer::draw(const Circle<Inexact>& c) {
-	m_objects.push_back(c);
+	add(Opcode::CIRCLE, 0, {c.center().x(), c.center().y(), c.squared_radius()});
 }
 
 void PaintingRenderer::draw(const BezierSpline& s) {
-	m_objects.push_back(s);
+	if (s.curves().empty()) {
+		return;
+	}
+	uint32_t offset = static_cast<uint32_t>(m_coordinates.size());
+	m_coordinates.push_back(s.curves().front().source().x());
+	m_coordinates.push_back(s.curves().front().source().y());
+	for (const BezierCurve& c : s.curves()) {
+		for (const Point<Inexact>& p : {c.sourceControl(), c.targetControl(), c.target()}) {
+			m_coordinates.push_back(p.x());
+			m_coordinates.push_back(p.y());
+		}
+	}
+	m_commands.push_back(Command{Opcode::BEZIER_SPLINE, offset, static_cast<uint32_t>(s.curves().size())});
 }
 
 void PaintingRenderer::draw(const Line<Inexact>& l) {
-	m_objects.push_back(l);
+	add(Opcode::LINE, 0, {l.a(), l.b(), l.c()});
 }
 
 void PaintingRenderer::draw(const Ray<Inexact>& r) {
-	m_objects.push_back(r);
+	Vector<Inexact> direction = r.to_vector();
+	add(Opcode::RAY, 0, {r.source().x(), r.source().y(), direction.x(), direction.y()});
 }
 
 void PaintingRenderer::draw(const Polyline<Inexact>& p) {
-	m_objects.push_back(p);
+	addVertices(Opcode::POLYLINE, p.vertices_begin(), p.vertices_end());
 }
 
 void PaintingRenderer::draw(const CircularArc& a) {
-	m_objects.push_back(a);
+	Circle<Inexact> circle = a.circle();
+	add(Opcode::CIRCULAR_ARC, 0, {circle.center().x(), circle.center().y(), circle.squared_radius(),
+	                              a.startAngle(), a.spanAngle()});
 }
 
 void PaintingRenderer::drawText(const Point<Inexact>& p, const std::string& text) {
-	m_objects.push_back(Label(p, text));
+	add(Opcode::TEXT, static_cast<uint32_t>(m_texts.size()), {p.x(), p.y()});
+	m_texts.push_back(text);
 }
 
 void PaintingRenderer::pushStyle() {
-	//m_styleStack.push(m_style);
+	m_styleStack.push(m_style);
+	add(Opcode::PUSH_STYLE, 0, {});
 }
 
 void PaintingRenderer::popStyle() {
-	//m_style = m_styleStack.top();
-	//m_styleStack.pop();
+	if (m_styleStack.empty()) {
+		return;
+	}
+	m_style = m_styleStack.top();
+	m_styleStack.pop();
+	add(Opcode::POP_STYLE, 0, {});
 }
 
 void PaintingRenderer::setMode(int mode) {
 	m_style.m_mode = mode;
-	m_objects.push_back(m_style);
+	addStyle();
 }
 
 void PaintingRenderer::setStroke(Color color, double width) {
 	m_style.m_strokeColor = color;
 	m_style.m_strokeWidth = width;
-	m_objects.push_back(m_style);
+	addStyle();
 }
 
 void PaintingRenderer::setStrokeOpacity(int alpha) {
 	m_style.m_strokeOpacity = alpha;
-	m_objects.push_back(m_style);
+	addStyle();
 }
 
 void PaintingRenderer::setFill(Color color) {
 	m_style.m_fillColor = color;
-	m_objects.push_back(m_style);
+	addStyle();
 }
 
 void PaintingRenderer::setFillOpacity(int alpha) {
 	m_style.m_fillOpacity = alpha;
-	m_objects.push_back(m_style);
+	addStyle();
+}
+
+void PaintingRenderer::clear() {
+	m_commands.clear();
+	m_coordinates.clear();
+	m_texts.clear();
+	m_style = Style();
+	m_styleStack = std::stack<Style>();
+}
+
+size_t PaintingRenderer::commandCount() const {
+	return m_commands.size();
+}
+
+void PaintingRenderer::save(const std::filesystem::path& file) const {
+	std::ofstream out(file, std::ios::binary);
+	if (!out) {
+		throw std::runtime_error("Could not open " + file.string() + " for writing");
+	}
+	out.write(FILE_MAGIC, sizeof(FILE_MAGIC));
+	write(out, FILE_VERSION);
+	write<uint64_t>(out, m_commands.size() + m_styleStack.size());
+	write<uint64_t>(out, m_coordinates.size());
+	write<uint64_t>(out, m_texts.size());
+	for (const Command& command : m_commands) {
+		write(out, command.m_opcode);
+		write(out, command.m_offset);
+		write(out, command.m_count);
+	}
+	// close the styles that are still pushed, as popStyle() would
+	for (size_t i = 0; i < m_styleStack.size(); ++i) {
+		write(out, Opcode::POP_STYLE);
+		write(out, static_cast<uint32_t>(m_coordinates.size()));
+		write<uint32_t>(out, 0);
+	}
+	out.write(reinterpret_cast<const char*>(m_coordinates.data()),
+	          m_coordinates.size() * sizeof(double));
+	for (const std::string& text : m_texts) {
+		write<uint64_t>(out, text.size());
+		out.write(text.data(), text.size());
+	}
+}
+
+std::shared_ptr<PaintingRenderer> PaintingRenderer::load(const std::filesystem::path& file) {
+	std::ifstream in(file, std::ios::binary);
+	if (!in) {
+		throw std::runtime_error("Could not open " + file.string() + " for reading");
+	}
+	char magic[sizeof(FILE_MAGIC)];
+	in.read(magic, sizeof(magic));
+	if (!in || !std::equal(std::begin(magic), std::end(magic), std::begin(FILE_MAGIC)) ||
+	    read<uint32_t>(in) != FILE_VERSION) {
+		throw std::runtime_error(file.string() + " is not a painting file");
+	}
+
+	auto painting = std::make_shared<PaintingRenderer>();
+	auto commandCount = read<uint64_t>(in);
+	auto coordinateCount = read<uint64_t>(in);
+	auto textCount = read<uint64_t>(in);
+	// Check the counts against the size of the file before allocating
+	// anything, so that a corrupt count does not lead to a huge allocation.
+	uint64_t left = bytesLeft(in);
+	if (commandCount > left / COMMAND_SIZE || coordinateCount > (left - commandCount * COMMAND_SIZE) / sizeof(double) ||
+	    textCount > (left - commandCount * COMMAND_SIZE - coordinateCount * sizeof(double)) / sizeof(uint64_t)) {
+		throw std::runtime_error("Unexpected end of painting file");
+	}
+	painting->m_commands.reserve(commandCount);
+	for (uint64_t i = 0; i < commandCount; ++i) {
+		Command command;
+		command.m_opcode = read<Opcode>(in);
+		command.m_offset = read<uint32_t>(in);
+		command.m_count = read<uint32_t>(in);
+		painting->m_commands.push_back(command);
+	}
+	painting->m_coordinates.resize(coordinateCount);
+	in.read(reinterpret_cast<char*>(painting->m_coordinates.data()), coordinateCount * sizeof(double));
+	for (uint64_t i = 0; i < textCount; ++i) {
+		auto length = read<uint64_t>(in);
+		if (!in || length > bytesLeft(in)) {
+			throw std::runtime_error("Unexpected end of painting file");
+		}
+		std::string text(length, '\0');
+		in.read(text.data(), text.size());
+		painting->m_texts.push_back(std::move(text));
+	}
+	if (!in) {
+		throw std::runtime_error("Unexpected end of painting file");
+	}
+
+	// check that replaying the commands stays within the arrays, and that the
+	// style pushes and pops are balanced
+	const auto& commands = painting->m_commands;
+	uint64_t depth = 0;
+	for (size_t i = 0; i < commands.size(); ++i) {
+		const Command& command = commands[i];
+		uint64_t used = 0;
+		switch (command.m_opcode) {
+		case Opcode::POINT:
+		case Opcode::TEXT:
+			used = 2;
+			break;
+		case Opcode::SEGMENT:
+		case Opcode::RAY:
+			used = 4;
+			break;
+		case Opcode::POLYGON:
+		case Opcode::RING:
+		case Opcode::POLYLINE:
+			used = 2 * uint64_t(command.m_count);
+			break;
+		case Opcode::POLYGON_WITH_HOLES:
+			if (i + 1 + command.m_count >= commands.size() ||
+			    std::any_of(commands.begin() + i + 1, commands.begin() + i + 2 + command.m_count,
+			                [](const Command& c) { return c.m_opcode != Opcode::RING; })) {
+				throw std::runtime_error("Malformed polygon with holes in painting file");
+			}
+			break;
+		case Opcode::CIRCLE:
+		case Opcode::LINE:
+			used = 3;
+			break;
+		case Opcode::BEZIER_SPLINE:
+			used = 2 + 6 * uint64_t(command.m_count);
+			break;
+		case Opcode::CIRCULAR_ARC:
+			used = 5;
+			break;
+		case Opcode::STYLE:
+			used = 9;
+			break;
+		case Opcode::PUSH_STYLE:
+			++depth;
+			break;
+		case Opcode::POP_STYLE:
+			if (depth == 0) {
+				throw std::runtime_error("Style popped without a matching push in painting file");
+			}
+			--depth;
+			break;
+		default:
+			throw std::runtime_error("Unknown command in painting file");
+		}
+		if (command.m_offset + used > coordinateCount ||
+		    (command.m_opcode == Opcode::TEXT && command.m_count >= textCount)) {
+			throw std::runtime_error("Command out of range in painting file");
+		}
+	}
+	if (depth != 0) {
+		throw std::runtime_error("Style pushed without a matching pop in painting file");
+	}
+	return painting;
 }
 
 } // namespace cartocrow::renderer
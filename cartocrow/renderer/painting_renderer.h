@@ -23,11 +23,24 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include "geometry_painting.h"
 #include "geometry_renderer.h"
 
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <stack>
+
 namespace cartocrow::renderer {
 
 /// Renderer that does not actually render, but instead serves as a painting
 /// that stores the render commands executed, so that they can later be rendered
 /// by another renderer. This is meant to be used for debug drawing and so on.
+///
+/// The commands are stored compactly in a command buffer: each command
+/// consists of an opcode and a range in a flat array of coordinates that is
+/// shared by all commands. Each style change stores a copy of the full style,
+/// so that objects are replayed with the style they were recorded with,
+/// regardless of the style of the renderer they are replayed on. The buffer can
+/// be saved to disk with \ref save() and loaded again with \ref load(), for
+/// example to inspect the debug output of an algorithm offline.
 class PaintingRenderer : public GeometryPainting, public GeometryRenderer {
 
   public:
@@ -49,6 +62,8 @@ class PaintingRenderer : public GeometryPainting, public GeometryRenderer {
 	void draw(const CircularArc& a) override;
 
 	void pushStyle() override;
+	/// Restores the style saved by the matching \ref pushStyle(). Calls
+	/// without a matching \ref pushStyle() are ignored.
 	void popStyle() override;
 	void setMode(int mode) override;
 	void setStroke(Color color, double width) override;
@@ -56,29 +71,86 @@ class PaintingRenderer : public GeometryPainting, public GeometryRenderer {
 	void setFill(Color color) override;
 	void setFillOpacity(int alpha) override;
 
+	/// Removes all recorded commands.
+	void clear();
+	/// Returns the number of recorded commands.
+	size_t commandCount() const;
+
+	/// Writes the recorded commands to a binary file. Styles that are still
+	/// pushed are popped at the end of the file.
+	void save(const std::filesystem::path& file) const;
+	/// Reads commands written by \ref save() from a file.
+	/// \throws std::runtime_error if the file cannot be read or is not a
+	/// painting written by \ref save(), for example if its style pushes and
+	/// pops are unbalanced.
+	static std::shared_ptr<PaintingRenderer> load(const std::filesystem::path& file);
+
   private:
+	/// The type of a command.
+	enum class Opcode : uint8_t {
+		POINT,
+		SEGMENT,
+		POLYGON,
+		/// Followed by one RING command for the outer boundary and one for each hole.
+		POLYGON_WITH_HOLES,
+		RING,
+		CIRCLE,
+		BEZIER_SPLINE,
+		LINE,
+		RAY,
+		POLYLINE,
+		CIRCULAR_ARC,
+		TEXT,
+		PUSH_STYLE,
+		POP_STYLE,
+		/// Sets the full style: the mode is stored in the count, the stroke
+		/// color, width and opacity and the fill color and opacity in the
+		/// coordinates.
+		STYLE,
+	};
+	/// A recorded command. Its coordinates start at \ref m_offset in \ref
+	/// m_coordinates. The meaning of \ref m_count depends on the opcode: for
+	/// instance it is the number of vertices of a polygon, the number of holes
+	/// of a polygon with holes, or the mode of a style change.
+	struct Command {
+		Opcode m_opcode;
+		uint32_t m_offset;
+		uint32_t m_count;
+	};
+	/// The style that is recorded on every style change.
 	struct Style {
 		/// The draw mode.
 		int m_mode = GeometryRenderer::stroke;
-		/// The diameter of points.
-		double m_pointSize = 10;
-		/// The color of points and lines.
+		/// The stroke color.
 		Color m_strokeColor = Color{0, 0, 0};
-		/// The width of lines.
+		/// The stroke width.
 		double m_strokeWidth = 1;
-		/// The opacity of lines.
-		double m_strokeOpacity = 255;
-		/// The color of filled shapes.
+		/// The stroke opacity, from 0 to 255.
+		int m_strokeOpacity = 255;
+		/// The fill color.
 		Color m_fillColor = Color{0, 102, 203};
-		/// The opacity of filled shapes.
-		double m_fillOpacity = 255;
+		/// The fill opacity, from 0 to 255.
+		int m_fillOpacity = 255;
 	};
-	using Label = std::pair<Point<Inexact>, std::string>;
-	using DrawableObject = std::variant<Point<Inexact>, Segment<Inexact>, Polygon<Inexact>,
-	                                    PolygonWithHoles<Inexact>, Circle<Inexact>, BezierSpline,
-	                                    Line<Inexact>, Ray<Inexact>, Polyline<Inexact>, CircularArc, Label, Style>;
-	std::vector<DrawableObject> m_objects;
+
+	/// Adds a command whose coordinates are the given values.
+	void add(Opcode opcode, uint32_t count, std::initializer_list<double> coordinates);
+	/// Adds a command with the coordinates of the given vertices.
+	template <class InputIterator>
+	void addVertices(Opcode opcode, InputIterator begin, InputIterator end);
+	/// Adds a command that sets the current style.
+	void addStyle();
+
+	/// The recorded commands.
+	std::vector<Command> m_commands;
+	/// The coordinates of all commands.
+	std::vector<double> m_coordinates;
+	/// The strings of the text commands.
+	std::vector<std::string> m_texts;
+	/// The current style.
 	Style m_style;
+	/// The styles saved by \ref pushStyle().
+	std::stack<Style> m_styleStack;
 };
 
 } // namespace cartocrow::renderer
@@ -0,0 +1,81 @@
+/*
+The CartoCrow library implements algorithmic geo-visualization methods,
+developed at TU Eindhoven.
+Copyright (C) 2021  Netherlands eScience Center and TU Eindhoven
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "raster_renderer.h"
+
+#include <QPainter>
+#include <QTransform>
+
+#include <cmath>
+#include <stdexcept>
+
+namespace cartocrow::renderer {
+
+RasterRenderer::RasterRenderer(const std::shared_ptr<GeometryPainting>& painting) {
+	m_paintings.push_back(painting);
+}
+
+QImage RasterRenderer::render(const Box& bounds, int width, int height) const {
+	QImage image(width, height, QImage::Format_ARGB32_Premultiplied);
+	image.fill(m_background);
+
+	double drawingWidth = bounds.xmax() - bounds.xmin();
+	double drawingHeight = bounds.ymax() - bounds.ymin();
+	double zoom = std::min(width / drawingWidth, height / drawingHeight);
+	if (!std::isfinite(zoom) || zoom <= 0) {
+		return image;
+	}
+	// Flip the y-axis, and put the center of the bounds in the center of the image.
+	QTransform transform = QTransform::fromTranslate(-0.5 * (bounds.xmin() + bounds.xmax()),
+	                                                 -0.5 * (bounds.ymin() + bounds.ymax())) *
+	                       QTransform::fromScale(zoom, -zoom) *
+	                       QTransform::fromTranslate(0.5 * width, 0.5 * height);
+	QRectF visible = transform.inverted().mapRect(QRectF(0, 0, width, height));
+	Box viewport(visible.left(), visible.top(), visible.right(), visible.bottom());
+
+	QPainter painter(&image);
+	painter.setRenderHint(QPainter::Antialiasing);
+	for (const auto& painting : m_paintings) {
+		RetainedScene scene(*painting, GeometryWidgetStyle(), m_lodTolerance);
+		scene.paint(painter, transform, viewport);
+	}
+	return image;
+}
+
+void RasterRenderer::save(const std::filesystem::path& file, const Box& bounds, int width, int height) const {
+	QImage image = render(bounds, width, height);
+	if (!image.save(QString::fromStdString(file.string()))) {
+		throw std::runtime_error("Could not write " + file.string());
+	}
+}
+
+void RasterRenderer::setBackground(const QColor& color) {
+	m_background = color;
+}
+
+void RasterRenderer::setLodTolerance(Number<Inexact> tolerance) {
+	m_lodTolerance = tolerance;
+}
+
+void RasterRenderer::addPainting(const std::shared_ptr<GeometryPainting>& painting) {
+	m_paintings.push_back(painting);
+}
+
+} // namespace cartocrow::renderer
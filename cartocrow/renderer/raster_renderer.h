@@ -0,0 +1,86 @@
+/*
+The CartoCrow library implements algorithmic geo-visualization methods,
+developed at TU Eindhoven.
+Copyright (C) 2021  Netherlands eScience Center and TU Eindhoven
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef CARTOCROW_RENDERER_RASTER_RENDERER_H
+#define CARTOCROW_RENDERER_RASTER_RENDERER_H
+
+#include <QColor>
+#include <QImage>
+
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+#include "geometry_painting.h"
+#include "retained_scene.h"
+
+namespace cartocrow::renderer {
+
+/// Renders paintings into raster images.
+///
+/// Construct the RasterRenderer with a painting, and call \ref render() to
+/// draw the painting into an offscreen \ref QImage, or \ref save() to write
+/// that image to a file. Each painting is recorded into a \ref RetainedScene,
+/// which is then painted into the image, so the image looks exactly like the
+/// painting in a \ref GeometryWidget. This does not need a window system; it
+/// only needs a \ref QGuiApplication if the painting draws text, for access to
+/// fonts.
+///
+/// Like in a \ref GeometryWidget, line widths and point sizes are in pixels,
+/// independent of the scale at which the painting is drawn.
+class RasterRenderer {
+
+  public:
+	RasterRenderer() = default;
+
+	/// Constructs a RasterRenderer for the given painting.
+	RasterRenderer(const std::shared_ptr<GeometryPainting>& painting);
+
+	/// Draws the part of the paintings inside \p bounds into an image of the
+	/// given size. The painting is scaled uniformly to fit and centered in the
+	/// image.
+	QImage render(const Box& bounds, int width, int height) const;
+	/// Draws the paintings like \ref render() and saves the result to an image
+	/// file, whose format is determined by its extension.
+	///
+	/// Throws a `std::runtime_error` if the file cannot be written.
+	void save(const std::filesystem::path& file, const Box& bounds, int width, int height) const;
+
+	/// Sets the color the image is filled with before drawing. The default is
+	/// transparent.
+	void setBackground(const QColor& color);
+	/// Sets the level-of-detail tolerance with which the paintings are recorded
+	/// (see \ref GeometryRenderer::setLodTolerance()).
+	void setLodTolerance(Number<Inexact> tolerance);
+
+	void addPainting(const std::shared_ptr<GeometryPainting>& painting);
+
+  private:
+	/// The paintings we're drawing.
+	std::vector<std::shared_ptr<GeometryPainting>> m_paintings;
+	/// The color of the background.
+	QColor m_background = Qt::transparent;
+	/// The level-of-detail tolerance.
+	Number<Inexact> m_lodTolerance = 0;
+};
+
+} // namespace cartocrow::renderer
+
+#endif //CARTOCROW_RENDERER_RASTER_RENDERER_H
@@ -0,0 +1,208 @@
+/*
+The CartoCrow library implements algorithmic geo-visualization methods,
+developed at TU Eindhoven.
+Copyright (C) 2021  Netherlands eScience Center and TU Eindhoven
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "render_statistics.h"
+
+#include <fstream>
+#include <stdexcept>
+
+namespace cartocrow::renderer {
+
+namespace {
+std::string escapeForJson(const std::string& text) {
+	std::string result;
+	result.reserve(text.size());
+	for (char c : text) {
+		switch (c) {
+		case '"':
+			result += "\\\"";
+			break;
+		case '\\':
+			result += "\\\\";
+			break;
+		case '\n':
+			result += "\\n";
+			break;
+		default:
+			result += c;
+		}
+	}
+	return result;
+}
+} // namespace
+
+size_t RenderStatistics::objectCount() const {
+	return m_points + m_segments + m_polygons + m_circles + m_curves + m_lines + m_polylines + m_texts;
+}
+
+void RenderStatistics::writeJson(std::ostream& out, const std::vector<RenderStatistics>& statistics) {
+	out << "[\n";
+	for (size_t i = 0; i < statistics.size(); ++i) {
+		const RenderStatistics& s = statistics[i];
+		out << "  {\"name\": \"" << escapeForJson(s.m_name) << "\", \"time\": " << s.m_time
+		    << ", \"objects\": {\"points\": " << s.m_points << ", \"segments\": " << s.m_segments
+		    << ", \"polygons\": " << s.m_polygons << ", \"circles\": " << s.m_circles
+		    << ", \"curves\": " << s.m_curves << ", \"lines\": " << s.m_lines
+		    << ", \"polylines\": " << s.m_polylines << ", \"texts\": " << s.m_texts
+		    << "}, \"vertices\": " << s.m_vertices << ", \"bytes\": " << s.m_bytes << "}"
+		    << (i + 1 < statistics.size() ? ",\n" : "\n");
+	}
+	out << "]\n";
+}
+
+void RenderStatistics::saveJson(const std::filesystem::path& file,
+                                const std::vector<RenderStatistics>& statistics) {
+	std::ofstream out(file);
+	if (!out) {
+		throw std::runtime_error("Could not open " + file.string() + " for writing");
+	}
+	writeJson(out, statistics);
+	if (!out) {
+		throw std::runtime_error("Could not write " + file.string());
+	}
+}
+
+StatisticsRenderer::StatisticsRenderer(GeometryRenderer& target, RenderStatistics& statistics)
+    : m_target(target), m_statistics(statistics) {}
+
+void StatisticsRenderer::draw(const Point<Inexact>& p) {
+	++m_statistics.m_points;
+	++m_statistics.m_vertices;
+	m_target.draw(p);
+}
+
+void StatisticsRenderer::draw(const Segment<Inexact>& s) {
+	++m_statistics.m_segments;
+	m_statistics.m_vertices += 2;
+	m_target.draw(s);
+}
+
+void StatisticsRenderer::draw(const Polygon<Inexact>& p) {
+	++m_statistics.m_polygons;
+	m_statistics.m_vertices += p.size();
+	m_target.draw(p);
+}
+
+void StatisticsRenderer::draw(const PolygonWithHoles<Inexact>& p) {
+	++m_statistics.m_polygons;
+	m_statistics.m_vertices += p.outer_boundary().size();
+	for (const auto& hole : p.holes()) {
+		m_statistics.m_vertices += hole.size();
+	}
+	m_target.draw(p);
+}
+
+void StatisticsRenderer::draw(const Circle<Inexact>& c) {
+	++m_statistics.m_circles;
+	++m_statistics.m_vertices;
+	m_target.draw(c);
+}
+
+void StatisticsRenderer::draw(const BezierSpline& s) {
+	++m_statistics.m_curves;
+	if (!s.curves().empty()) {
+		m_statistics.m_vertices += 3 * s.curves().size() + 1;
+	}
+	m_target.draw(s);
+}
+
+void StatisticsRenderer::draw(const Line<Inexact>& l) {
+	++m_statistics.m_lines;
+	m_target.draw(l);
+}
+
+void StatisticsRenderer::draw(const Ray<Inexact>& r) {
+	++m_statistics.m_lines;
+	++m_statistics.m_vertices;
+	m_target.draw(r);
+}
+
+void StatisticsRenderer::draw(const Polyline<Inexact>& p) {
+	++m_statistics.m_polylines;
+	m_statistics.m_vertices += p.num_vertices();
+	m_target.draw(p);
+}
+
+void StatisticsRenderer::draw(const CircularArc& a) {
+	++m_statistics.m_curves;
+	m_statistics.m_vertices += 2;
+	m_target.draw(a);
+}
+
+void StatisticsRenderer::drawPoints(std::span<const Point<Inexact>> points) {
+	m_statistics.m_points += points.size();
+	m_statistics.m_vertices += points.size();
+	m_target.drawPoints(points);
+}
+
+void StatisticsRenderer::drawSegments(std::span<const Segment<Inexact>> segments) {
+	m_statistics.m_segments += segments.size();
+	m_statistics.m_vertices += 2 * segments.size();
+	m_target.drawSegments(segments);
+}
+
+void StatisticsRenderer::drawPolygons(std::span<const Polygon<Inexact>> polygons) {
+	m_statistics.m_polygons += polygons.size();
+	for (const Polygon<Inexact>& p : polygons) {
+		m_statistics.m_vertices += p.size();
+	}
+	m_target.drawPolygons(polygons);
+}
+
+void StatisticsRenderer::drawCircles(std::span<const Circle<Inexact>> circles) {
+	m_statistics.m_circles += circles.size();
+	m_statistics.m_vertices += circles.size();
+	m_target.drawCircles(circles);
+}
+
+void StatisticsRenderer::drawText(const Point<Inexact>& p, const std::string& text) {
+	++m_statistics.m_texts;
+	m_target.drawText(p, text);
+}
+
+void StatisticsRenderer::pushStyle() {
+	m_target.pushStyle();
+}
+
+void StatisticsRenderer::popStyle() {
+	m_target.popStyle();
+}
+
+void StatisticsRenderer::setMode(int mode) {
+	m_target.setMode(mode);
+}
+
+void StatisticsRenderer::setStroke(Color color, double width) {
+	m_target.setStroke(color, width);
+}
+
+void StatisticsRenderer::setStrokeOpacity(int alpha) {
+	m_target.setStrokeOpacity(alpha);
+}
+
+void StatisticsRenderer::setFill(Color color) {
+	m_target.setFill(color);
+}
+
+void StatisticsRenderer::setFillOpacity(int alpha) {
+	m_target.setFillOpacity(alpha);
+}
+
+} // namespace cartocrow::renderer
@@ -0,0 +1,130 @@
+/*
+The CartoCrow library implements algorithmic geo-visualization methods,
+developed at TU Eindhoven.
+Copyright (C) 2021  Netherlands eScience Center and TU Eindhoven
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef CARTOCROW_RENDERER_RENDER_STATISTICS_H
+#define CARTOCROW_RENDERER_RENDER_STATISTICS_H
+
+#include <filesystem>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "geometry_renderer.h"
+
+namespace cartocrow::renderer {
+
+/// Statistics about drawing one painting.
+/**
+ * The renderers collect these for every painting they draw, so that it is
+ * possible to find out which painting is responsible for slow drawing or large
+ * output. Objects are counted by a \ref StatisticsRenderer.
+ */
+struct RenderStatistics {
+	/// The name of the painting.
+	std::string m_name;
+	/// The wall-clock time spent drawing the painting, in seconds.
+	double m_time = 0;
+
+	/// The number of points drawn.
+	size_t m_points = 0;
+	/// The number of segments drawn.
+	size_t m_segments = 0;
+	/// The number of polygons drawn, with or without holes.
+	size_t m_polygons = 0;
+	/// The number of circles drawn.
+	size_t m_circles = 0;
+	/// The number of Bézier splines and circular arcs drawn.
+	size_t m_curves = 0;
+	/// The number of lines and rays drawn.
+	size_t m_lines = 0;
+	/// The number of polylines drawn.
+	size_t m_polylines = 0;
+	/// The number of texts drawn.
+	size_t m_texts = 0;
+
+	/// The number of vertices (including control points) of the objects drawn,
+	/// before level-of-detail simplification.
+	size_t m_vertices = 0;
+	/// The number of bytes written to the output, if the renderer writes a file.
+	size_t m_bytes = 0;
+
+	/// Returns the total number of objects drawn.
+	size_t objectCount() const;
+
+	/// Writes the statistics of several paintings as a JSON array.
+	static void writeJson(std::ostream& out, const std::vector<RenderStatistics>& statistics);
+	/// Writes the statistics of several paintings as a JSON array to a file.
+	///
+	/// Throws a `std::runtime_error` if the file cannot be written.
+	static void saveJson(const std::filesystem::path& file,
+	                     const std::vector<RenderStatistics>& statistics);
+};
+
+/// A GeometryRenderer that counts the objects drawn and passes them on to
+/// another renderer.
+/**
+ * To collect statistics on a painting, paint it on a StatisticsRenderer
+ * wrapping the renderer it should be drawn with:
+ * ```
+ * RenderStatistics statistics{"name"};
+ * StatisticsRenderer counter(renderer, statistics);
+ * painting.paint(counter);
+ * ```
+ */
+class StatisticsRenderer : public GeometryRenderer {
+  public:
+	/// Constructs a StatisticsRenderer that draws on \p target and adds its
+	/// counts to \p statistics.
+	StatisticsRenderer(GeometryRenderer& target, RenderStatistics& statistics);
+
+	void draw(const Point<Inexact>& p) override;
+	void draw(const Segment<Inexact>& s) override;
+	void draw(const Polygon<Inexact>& p) override;
+	void draw(const PolygonWithHoles<Inexact>& p) override;
+	void draw(const Circle<Inexact>& c) override;
+	void draw(const BezierSpline& s) override;
+	void draw(const Line<Inexact>& l) override;
+	void draw(const Ray<Inexact>& r) override;
+	void draw(const Polyline<Inexact>& p) override;
+	void draw(const CircularArc& a) override;
+	void drawPoints(std::span<const Point<Inexact>> points) override;
+	void drawSegments(std::span<const Segment<Inexact>> segments) override;
+	void drawPolygons(std::span<const Polygon<Inexact>> polygons) override;
+	void drawCircles(std::span<const Circle<Inexact>> circles) override;
+	void drawText(const Point<Inexact>& p, const std::string& text) override;
+
+	void pushStyle() override;
+	void popStyle() override;
+	void setMode(int mode) override;
+	void setStroke(Color color, double width) override;
+	void setStrokeOpacity(int alpha) override;
+	void setFill(Color color) override;
+	void setFillOpacity(int alpha) override;
+
+  private:
+	/// The renderer we pass the objects on to.
+	GeometryRenderer& m_target;
+	/// The statistics we add to.
+	RenderStatistics& m_statistics;
+};
+
+} // namespace cartocrow::renderer
+
+#endif //CARTOCROW_RENDERER_RENDER_STATISTICS_H
@@ -0,0 +1,427 @@
+/*
+The CartoCrow library implements algorithmic geo-visualization methods,
+developed at TU Eindhoven.
+Copyright (C) 2021  Netherlands eScience Center and TU Eindhoven
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "retained_scene.h"
+#include "painter_path.h"
+
+#include <algorithm>
+#include <cmath>
+#include <optional>
+
+namespace cartocrow::renderer {
+
+namespace bgi = boost::geometry::index;
+
+/// Labels are drawn centered in a box of 1000 × 500 pixels around their anchor.
+constexpr double LABEL_PADDING = 500;
+
+RetainedScene::RetainedScene(const GeometryPainting& painting, const GeometryWidgetStyle& style,
+                             Number<Inexact> lodTolerance, RenderStatistics* statistics)
+    : m_style(style) {
+	setLodTolerance(lodTolerance);
+	if (statistics) {
+		StatisticsRenderer counter(*this, *statistics);
+		painting.paint(counter);
+	} else {
+		painting.paint(*this);
+	}
+	m_rtree = RTree(m_bounds.begin(), m_bounds.end());
+	m_labelTree = RTree(m_labelBounds.begin(), m_labelBounds.end());
+	m_bounds = {};
+	m_labelBounds = {};
+}
+
+void RetainedScene::paint(QPainter& painter, const QTransform& transform, const Box& viewport,
+                          bool copyPaths) const {
+	double zoom = std::sqrt(std::abs(transform.determinant()));
+
+	std::vector<int> visible = m_unbounded;
+	auto query = [&](const RTree& tree, double padding) {
+		double margin = padding / zoom;
+		IndexBox box(IndexPoint(viewport.xmin() - margin, viewport.ymin() - margin),
+		             IndexPoint(viewport.xmax() + margin, viewport.ymax() + margin));
+		for (auto it = tree.qbegin(bgi::intersects(box)); it != tree.qend(); ++it) {
+			visible.push_back(it->second);
+		}
+	};
+	query(m_rtree, m_maxPadding);
+	query(m_labelTree, LABEL_PADDING);
+	std::sort(visible.begin(), visible.end());
+
+	CGAL::Iso_rectangle_2<Inexact> clipRect(Point<Inexact>(viewport.xmin(), viewport.ymin()),
+	                                        Point<Inexact>(viewport.xmax(), viewport.ymax()));
+
+	painter.save();
+	painter.setTransform(transform);
+	bool screenSpace = false;
+	auto setScreenSpace = [&](bool value) {
+		if (value != screenSpace) {
+			painter.setTransform(value ? QTransform() : transform);
+			screenSpace = value;
+		}
+	};
+
+	for (int i : visible) {
+		const Item& item = m_items[i];
+		if (auto path = std::get_if<PathItem>(&item)) {
+			setScreenSpace(false);
+			painter.setPen(path->m_pen);
+			painter.setBrush(path->m_brush);
+			if (copyPaths) {
+				// a plain copy would share its data with the recorded path
+				QPainterPath copy;
+				copy.setFillRule(path->m_path.fillRule());
+				copy.addPath(path->m_path);
+				painter.drawPath(copy);
+			} else {
+				painter.drawPath(path->m_path);
+			}
+		} else if (auto point = std::get_if<PointItem>(&item)) {
+			setScreenSpace(false);
+			painter.setPen(Qt::NoPen);
+			painter.setBrush(point->m_color);
+			double radius = 0.5 * point->m_size / zoom;
+			painter.drawEllipse(QPointF(point->m_position.x(), point->m_position.y()), radius, radius);
+		} else if (auto points = std::get_if<PointSetItem>(&item)) {
+			setScreenSpace(false);
+			painter.setPen(Qt::NoPen);
+			painter.setBrush(points->m_color);
+			double radius = 0.5 * points->m_size / zoom;
+			for (const Point<Inexact>& p : points->m_positions) {
+				painter.drawEllipse(QPointF(p.x(), p.y()), radius, radius);
+			}
+		} else if (auto label = std::get_if<LabelItem>(&item)) {
+			setScreenSpace(true);
+			painter.setPen(label->m_pen);
+			QPointF p = transform.map(QPointF(label->m_position.x(), label->m_position.y()));
+			painter.drawText(QRectF(p - QPointF{500, 250}, p + QPointF{500, 250}), Qt::AlignCenter,
+			                 label->m_text);
+		} else if (auto unbounded = std::get_if<UnboundedItem>(&item)) {
+			std::optional<Segment<Inexact>> clipped;
+			std::visit([&clipRect, &clipped](const auto& object) {
+				auto result = intersection(object, clipRect);
+				if (result) {
+					if (const Segment<Inexact>* s = boost::get<Segment<Inexact>>(&*result)) {
+						clipped = *s;
+					}
+				}
+			}, unbounded->m_object);
+			if (clipped) {
+				setScreenSpace(false);
+				painter.setPen(unbounded->m_pen);
+				painter.drawLine(QPointF(clipped->start().x(), clipped->start().y()),
+				                 QPointF(clipped->end().x(), clipped->end().y()));
+			}
+		}
+	}
+	painter.restore();
+}
+
+size_t RetainedScene::size() const {
+	return m_items.size();
+}
+
+void RetainedScene::add(Item item, const QRectF& bounds, double padding) {
+	int index = static_cast<int>(m_items.size());
+	IndexBox box(IndexPoint(bounds.left(), bounds.top()), IndexPoint(bounds.right(), bounds.bottom()));
+	if (std::holds_alternative<LabelItem>(item)) {
+		m_labelBounds.emplace_back(box, index);
+	} else {
+		m_bounds.emplace_back(box, index);
+		m_maxPadding = std::max(m_maxPadding, padding);
+	}
+	m_items.push_back(std::move(item));
+}
+
+void RetainedScene::addPath(QPainterPath path) {
+	QRectF bounds = path.controlPointRect();
+	// Half the stroke width, and a pixel for antialiasing.
+	double padding = (m_style.m_mode & stroke ? m_style.m_strokeWidth / 2 : 0) + 1;
+	add(PathItem{std::move(path), pen(), brush()}, bounds, padding);
+}
+
+QPainterPath RetainedScene::flattenedPath() const {
+	QPainterPath path;
+	for (size_t i = 0; i < m_flattened.size(); ++i) {
+		if (i == 0) {
+			path.moveTo(m_flattened[i].x(), m_flattened[i].y());
+		} else {
+			path.lineTo(m_flattened[i].x(), m_flattened[i].y());
+		}
+	}
+	return path;
+}
+
+QPen RetainedScene::pen() const {
+	if (!(m_style.m_mode & stroke)) {
+		return Qt::NoPen;
+	}
+	// Paths are drawn in drawing coordinates, so the pen needs to be cosmetic
+	// to keep its width in pixels.
+	QPen pen(m_style.m_strokeColor, m_style.m_strokeWidth, Qt::SolidLine, Qt::FlatCap, Qt::RoundJoin);
+	pen.setCosmetic(true);
+	return pen;
+}
+
+QBrush RetainedScene::brush() const {
+	if (!(m_style.m_mode & fill)) {
+		return Qt::NoBrush;
+	}
+	return QBrush(m_style.m_fillColor);
+}
+
+void RetainedScene::draw(const Point<Inexact>& p) {
+	QRectF bounds(QPointF(p.x(), p.y()), QSizeF(0, 0));
+	add(PointItem{p, m_style.m_pointSize, m_style.m_strokeColor}, bounds, m_style.m_pointSize / 2);
+}
+
+void RetainedScene::draw(const Segment<Inexact>& s) {
+	QPainterPath path;
+	path.moveTo(s.start().x(), s.start().y());
+	path.lineTo(s.end().x(), s.end().y());
+	addPath(std::move(path));
+	if (m_style.m_mode & vertices) {
+		draw(s.start());
+		draw(s.end());
+	}
+}
+
+void RetainedScene::draw(const Polygon<Inexact>& polygon) {
+	Polygon<Inexact> simplified;
+	const Polygon<Inexact>* p = applyLod(polygon, simplified);
+	if (!p) {
+		return;
+	}
+	QPainterPath path;
+	addPolygonToPath(path, *p);
+	addPath(std::move(path));
+	if (m_style.m_mode & vertices) {
+		for (auto v = p->vertices_begin(); v != p->vertices_end(); v++) {
+			draw(*v);
+		}
+	}
+}
+
+void RetainedScene::draw(const PolygonWithHoles<Inexact>& polygon) {
+	PolygonWithHoles<Inexact> simplified;
+	const PolygonWithHoles<Inexact>* p = applyLod(polygon, simplified);
+	if (!p) {
+		return;
+	}
+	QPainterPath path;
+	addPolygonToPath(path, p->outer_boundary());
+	for (const auto& hole : p->holes()) {
+		addPolygonToPath(path, hole);
+	}
+	addPath(std::move(path));
+	if (m_style.m_mode & vertices) {
+		for (auto v = p->outer_boundary().vertices_begin(); v != p->outer_boundary().vertices_end(); v++) {
+			draw(*v);
+		}
+		for (auto h = p->holes_begin(); h != p->holes_end(); h++) {
+			for (auto v = h->vertices_begin(); v != h->vertices_end(); v++) {
+				draw(*v);
+			}
+		}
+	}
+}
+
+void RetainedScene::draw(const Circle<Inexact>& c) {
+	QPainterPath path;
+	double r = std::sqrt(c.squared_radius());
+	path.addEllipse(QPointF(c.center().x(), c.center().y()), r, r);
+	addPath(std::move(path));
+}
+
+void RetainedScene::draw(const CircularArc& a) {
+	QPainterPath path;
+	if (lodTolerance() > 0 && a.flatten(lodTolerance(), m_flattened)) {
+		path = flattenedPath();
+	} else {
+		Box bbox = a.circle().bbox();
+		QRectF rect(QPointF(bbox.xmin(), bbox.ymin()), QPointF(bbox.xmax(), bbox.ymax()));
+		// Qt measures angles clockwise in drawing coordinates, because its y-axis
+		// points down; the view transform flips it back.
+		double start = -a.startAngle() * (180 / M_PI);
+		double span = -a.spanAngle() * (180 / M_PI);
+		path.arcMoveTo(rect, start);
+		path.arcTo(rect, start, span);
+	}
+	// Arcs are only stroked, like QPainter::drawArc does.
+	QRectF bounds = path.controlPointRect();
+	add(PathItem{std::move(path), pen(), Qt::NoBrush}, bounds,
+	    (m_style.m_mode & stroke ? m_style.m_strokeWidth / 2 : 0) + 1);
+}
+
+void RetainedScene::draw(const BezierSpline& s) {
+	if (s.curves().empty()) {
+		return;
+	}
+	QPainterPath path;
+	if (lodTolerance() > 0 && s.flatten(lodTolerance(), m_flattened)) {
+		path = flattenedPath();
+	} else {
+		path.moveTo(s.curves()[0].source().x(), s.curves()[0].source().y());
+		for (const BezierCurve& c : s.curves()) {
+			path.cubicTo(c.sourceControl().x(), c.sourceControl().y(), c.targetControl().x(),
+			             c.targetControl().y(), c.target().x(), c.target().y());
+		}
+	}
+	addPath(std::move(path));
+	if (m_style.m_mode & vertices) {
+		for (const BezierCurve& c : s.curves()) {
+			draw(c.source());
+		}
+		draw(s.curves().back().target());
+	}
+}
+
+void RetainedScene::draw(const Line<Inexact>& l) {
+	m_unbounded.push_back(static_cast<int>(m_items.size()));
+	m_items.push_back(UnboundedItem{l, pen()});
+}
+
+void RetainedScene::draw(const Ray<Inexact>& r) {
+	m_unbounded.push_back(static_cast<int>(m_items.size()));
+	m_items.push_back(UnboundedItem{r, pen()});
+	if (m_style.m_mode & vertices) {
+		draw(r.source());
+	}
+}
+
+void RetainedScene::draw(const Polyline<Inexact>& polyline) {
+	Polyline<Inexact> simplified;
+	const Polyline<Inexact>& p = *applyLod(polyline, simplified);
+	QPainterPath path;
+	for (auto v = p.vertices_begin(); v != p.vertices_end(); v++) {
+		if (v == p.vertices_begin()) {
+			path.moveTo(v->x(), v->y());
+		} else {
+			path.lineTo(v->x(), v->y());
+		}
+	}
+	addPath(std::move(path));
+	if (m_style.m_mode & vertices) {
+		for (auto v = p.vertices_begin(); v != p.vertices_end(); v++) {
+			draw(*v);
+		}
+	}
+}
+
+void RetainedScene::drawPoints(std::span<const Point<Inexact>> points) {
+	if (points.empty()) {
+		return;
+	}
+	Box bbox = CGAL::bbox_2(points.begin(), points.end());
+	QRectF bounds(QPointF(bbox.xmin(), bbox.ymin()), QPointF(bbox.xmax(), bbox.ymax()));
+	add(PointSetItem{std::vector<Point<Inexact>>(points.begin(), points.end()), m_style.m_pointSize,
+	                 m_style.m_strokeColor},
+	    bounds, m_style.m_pointSize / 2);
+}
+
+void RetainedScene::drawSegments(std::span<const Segment<Inexact>> segments) {
+	if (segments.empty()) {
+		return;
+	}
+	QPainterPath path;
+	for (const Segment<Inexact>& s : segments) {
+		path.moveTo(s.start().x(), s.start().y());
+		path.lineTo(s.end().x(), s.end().y());
+	}
+	addPath(std::move(path));
+	if (m_style.m_mode & vertices) {
+		std::vector<Point<Inexact>> points;
+		points.reserve(2 * segments.size());
+		for (const Segment<Inexact>& s : segments) {
+			points.push_back(s.start());
+			points.push_back(s.end());
+		}
+		drawPoints(points);
+	}
+}
+
+void RetainedScene::drawPolygons(std::span<const Polygon<Inexact>> polygons) {
+	QPainterPath path;
+	std::vector<Point<Inexact>> points;
+	Polygon<Inexact> simplified;
+	for (const Polygon<Inexact>& polygon : polygons) {
+		if (const Polygon<Inexact>* p = applyLod(polygon, simplified)) {
+			addPolygonToPath(path, *p);
+			if (m_style.m_mode & vertices) {
+				points.insert(points.end(), p->vertices_begin(), p->vertices_end());
+			}
+		}
+	}
+	if (path.isEmpty()) {
+		return;
+	}
+	addPath(std::move(path));
+	drawPoints(points);
+}
+
+void RetainedScene::drawCircles(std::span<const Circle<Inexact>> circles) {
+	if (circles.empty()) {
+		return;
+	}
+	QPainterPath path;
+	// Qt adds all ellipses in the same direction, so this draws their union.
+	path.setFillRule(Qt::WindingFill);
+	for (const Circle<Inexact>& c : circles) {
+		double r = std::sqrt(c.squared_radius());
+		path.addEllipse(QPointF(c.center().x(), c.center().y()), r, r);
+	}
+	addPath(std::move(path));
+}
+
+void RetainedScene::drawText(const Point<Inexact>& p, const std::string& text) {
+	QRectF bounds(QPointF(p.x(), p.y()), QSizeF(0, 0));
+	add(LabelItem{p, QString::fromStdString(text), pen()}, bounds, LABEL_PADDING);
+}
+
+void RetainedScene::pushStyle() {
+	m_styleStack.push(m_style);
+}
+
+void RetainedScene::popStyle() {
+	m_style = m_styleStack.top();
+	m_styleStack.pop();
+}
+
+void RetainedScene::setMode(int mode) {
+	m_style.m_mode = mode;
+}
+
+void RetainedScene::setStroke(Color color, double width) {
+	m_style.m_strokeColor = QColor(color.r, color.g, color.b);
+	m_style.m_strokeWidth = width;
+}
+
+void RetainedScene::setStrokeOpacity(int alpha) {
+	m_style.m_strokeColor.setAlpha(alpha);
+}
+
+void RetainedScene::setFill(Color color) {
+	m_style.m_fillColor.setRgb(color.r, color.g, color.b, m_style.m_fillColor.alpha());
+}
+
+void RetainedScene::setFillOpacity(int alpha) {
+	m_style.m_fillColor.setAlpha(alpha);
+}
+
+} // namespace cartocrow::renderer
@@ -0,0 +1,196 @@
+/*
+The CartoCrow library implements algorithmic geo-visualization methods,
+developed at TU Eindhoven.
+Copyright (C) 2021  Netherlands eScience Center and TU Eindhoven
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef CARTOCROW_RENDERER_RETAINED_SCENE_H
+#define CARTOCROW_RENDERER_RETAINED_SCENE_H
+
+#include <QBrush>
+#include <QColor>
+#include <QPainter>
+#include <QPainterPath>
+#include <QPen>
+#include <QString>
+#include <QTransform>
+
+#include <boost/geometry.hpp>
+#include <boost/geometry/index/rtree.hpp>
+
+#include <stack>
+#include <variant>
+
+#include "geometry_painting.h"
+#include "geometry_renderer.h"
+#include "render_statistics.h"
+
+namespace cartocrow::renderer {
+
+/// The style for a GeometryWidget.
+struct GeometryWidgetStyle {
+	/// The draw mode.
+	int m_mode = GeometryRenderer::stroke;
+	/// The diameter of points.
+	double m_pointSize = 15;
+	/// The color of points and lines.
+	QColor m_strokeColor = QColor(0, 0, 0);
+	/// The width of lines.
+	double m_strokeWidth = 1;
+	/// The color of filled shapes.
+	QColor m_fillColor = QColor(0, 102, 203);
+};
+
+/// A painting recorded once as Qt paths, to be redrawn quickly by a \ref GeometryWidget.
+///
+/// Constructing a RetainedScene paints the painting into it. Every object is
+/// converted to a \ref QPainterPath in drawing coordinates (or to a point or
+/// label, which are sized in pixels), together with the pen and brush it is
+/// drawn with. Because nothing depends on the view transform, the scene stays
+/// valid while the user pans and zooms; it needs to be recorded again only when
+/// the painting itself changes.
+///
+/// The bounding boxes of the recorded items are stored in an R-tree, so that
+/// \ref paint() only draws the items that intersect the viewport, in the order
+/// in which they were recorded. Lines and rays are unbounded, so they are clipped
+/// to the viewport and drawn on every repaint.
+///
+/// If the level-of-detail tolerance is positive, Bézier splines and circular
+/// arcs are flattened to polylines within that tolerance while recording, so
+/// that Qt does not have to flatten them again on every repaint. Curves that
+/// would need more than \ref MAX_FLATTENING_SEGMENTS segments per curve are
+/// recorded as curves instead.
+class RetainedScene : public GeometryRenderer {
+  public:
+	/// Records the given painting, starting from the given style. Polygons and
+	/// polylines are simplified with the given level-of-detail tolerance (see
+	/// \ref setLodTolerance()). If \p statistics is given, the objects drawn
+	/// by the painting are counted in it.
+	RetainedScene(const GeometryPainting& painting, const GeometryWidgetStyle& style,
+	              Number<Inexact> lodTolerance = 0, RenderStatistics* statistics = nullptr);
+
+	/// Draws the items intersecting \p viewport, which is given in drawing
+	/// coordinates. \p transform maps drawing coordinates to Qt coordinates; it
+	/// is assumed to scale uniformly.
+	///
+	/// Qt caches data in a path when it is drawn, so the scene cannot be drawn
+	/// from several threads at once unless \p copyPaths is set: then each path
+	/// is drawn from a copy of its own, and the scene itself is only read.
+	void paint(QPainter& painter, const QTransform& transform, const Box& viewport,
+	           bool copyPaths = false) const;
+	/// Returns the number of recorded items.
+	size_t size() const;
+
+	void draw(const Point<Inexact>& p) override;
+	void draw(const Segment<Inexact>& s) override;
+	void draw(const Polygon<Inexact>& p) override;
+	void draw(const PolygonWithHoles<Inexact>& p) override;
+	void draw(const Circle<Inexact>& c) override;
+	void draw(const BezierSpline& s) override;
+	void draw(const Line<Inexact>& l) override;
+	void draw(const Ray<Inexact>& r) override;
+	void draw(const Polyline<Inexact>& p) override;
+	void draw(const CircularArc& a) override;
+	void drawPoints(std::span<const Point<Inexact>> points) override;
+	void drawSegments(std::span<const Segment<Inexact>> segments) override;
+	void drawPolygons(std::span<const Polygon<Inexact>> polygons) override;
+	void drawCircles(std::span<const Circle<Inexact>> circles) override;
+	void drawText(const Point<Inexact>& p, const std::string& text) override;
+
+	void pushStyle() override;
+	void popStyle() override;
+	void setMode(int mode) override;
+	void setStroke(Color color, double width) override;
+	void setStrokeOpacity(int alpha) override;
+	void setFill(Color color) override;
+	void setFillOpacity(int alpha) override;
+
+  private:
+	/// A path in drawing coordinates.
+	struct PathItem {
+		QPainterPath m_path;
+		QPen m_pen;
+		QBrush m_brush;
+	};
+	/// A point, drawn as a disk with a diameter in pixels.
+	struct PointItem {
+		Point<Inexact> m_position;
+		double m_size;
+		QColor m_color;
+	};
+	/// Several points drawn in the same style, as disks with a diameter in pixels.
+	struct PointSetItem {
+		std::vector<Point<Inexact>> m_positions;
+		double m_size;
+		QColor m_color;
+	};
+	/// A label, centered around a point.
+	struct LabelItem {
+		Point<Inexact> m_position;
+		QString m_text;
+		QPen m_pen;
+	};
+	/// A line or ray, clipped to the viewport when it is drawn.
+	struct UnboundedItem {
+		std::variant<Line<Inexact>, Ray<Inexact>> m_object;
+		QPen m_pen;
+	};
+	using Item = std::variant<PathItem, PointItem, PointSetItem, LabelItem, UnboundedItem>;
+
+	typedef boost::geometry::model::point<double, 2, boost::geometry::cs::cartesian> IndexPoint;
+	typedef boost::geometry::model::box<IndexPoint> IndexBox;
+	typedef std::pair<IndexBox, int> Value;
+	typedef boost::geometry::index::rtree<Value, boost::geometry::index::quadratic<16>> RTree;
+
+	/// Adds an item with the given bounding box in drawing coordinates. The item
+	/// may extend \p padding pixels beyond its bounding box.
+	void add(Item item, const QRectF& bounds, double padding);
+	/// Adds a path, stroked and filled according to the current style.
+	void addPath(QPainterPath path);
+	/// Returns a path through the points in \ref m_flattened.
+	QPainterPath flattenedPath() const;
+	/// Returns the pen corresponding to the current style.
+	QPen pen() const;
+	/// Returns the brush corresponding to the current style.
+	QBrush brush() const;
+
+	/// The recorded items, in drawing order.
+	std::vector<Item> m_items;
+	/// Indices of the lines and rays in \ref m_items.
+	std::vector<int> m_unbounded;
+	/// Bounding boxes of the items and of the labels, collected while recording
+	/// and bulk loaded into \ref m_rtree and \ref m_labelTree afterwards.
+	std::vector<Value> m_bounds;
+	std::vector<Value> m_labelBounds;
+	/// R-tree on the bounding boxes of the items, except labels.
+	RTree m_rtree;
+	/// R-tree on the anchor points of the labels, which have a much larger padding.
+	RTree m_labelTree;
+	/// The largest padding of any item in \ref m_rtree, in pixels.
+	double m_maxPadding = 0;
+
+	/// Buffer for flattening curves, reused to avoid reallocating for every curve.
+	std::vector<Point<Inexact>> m_flattened;
+
+	/// The current drawing style while recording.
+	GeometryWidgetStyle m_style;
+	/// A stack of drawing styles, used by \ref pushStyle() and \ref popStyle().
+	std::stack<GeometryWidgetStyle> m_styleStack;
+};
+
+} // namespace cartocrow::renderer
+
+#endif //CARTOCROW_RENDERER_RETAINED_SCENE_H
@@ -20,22 +20,183 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include "svg_renderer.h"
 
 #include "geometry_renderer.h"
+#include "../core/timer.h"
 
-#include <CGAL/enum.h>
-#include <QFileDialog>
-#include <QGuiApplication>
-#include <QPainterPath>
-#include <QPen>
-#include <QPoint>
-#include <QPolygon>
-#include <QSlider>
-#include <QToolButton>
+#ifdef CARTOCROW_HAVE_ZLIB
+#include <zlib.h>
+#endif
 
+#include <algorithm>
+#include <charconv>
 #include <cmath>
+#include <fstream>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 
 namespace cartocrow::renderer {
 
+namespace {
+
+/// Formats a number with the given number of significant digits, independent
+/// of the locale.
+std::string_view formatNumber(double value, int precision, char* buffer, size_t size) {
+	if (value == 0) {
+		value = 0; // avoid writing "-0"
+	}
+	auto [end, error] = std::to_chars(buffer, buffer + size, value, std::chars_format::general, precision);
+	return std::string_view(buffer, end - buffer);
+}
+
+std::string formatNumber(double value, int precision) {
+	char buffer[32];
+	return std::string(formatNumber(value, precision, buffer, sizeof(buffer)));
+}
+
+std::string formatColor(const Color& color) {
+	const char* digits = "0123456789abcdef";
+	std::string result = "#";
+	for (int component : {color.r, color.g, color.b}) {
+		component = std::clamp(component, 0, 255);
+		result += digits[component / 16];
+		result += digits[component % 16];
+	}
+	return result;
+}
+
+} // namespace
+
+/// Buffered writer for an SVG file, optionally compressed with gzip.
+class SvgRenderer::Output {
+  public:
+	Output(const std::filesystem::path& file, bool compress, int precision)
+	    : m_file(file), m_precision(precision) {
+		m_buffer.reserve(BUFFER_SIZE);
+		if (compress) {
+#ifdef CARTOCROW_HAVE_ZLIB
+			m_gzip = gzopen(file.string().c_str(), "wb");
+			if (!m_gzip) {
+				throw std::runtime_error("Could not open " + file.string() + " for writing");
+			}
+#else
+			throw std::runtime_error("Cannot write " + file.string() + ": compression is not supported in this build");
+#endif
+		} else {
+			m_stream.open(file, std::ios::binary);
+			if (!m_stream) {
+				throw std::runtime_error("Could not open " + file.string() + " for writing");
+			}
+		}
+	}
+
+	~Output() {
+#ifdef CARTOCROW_HAVE_ZLIB
+		if (m_gzip) {
+			gzclose(m_gzip);
+		}
+#endif
+	}
+
+	Output& operator<<(std::string_view text) {
+		if (m_buffer.size() + text.size() > BUFFER_SIZE) {
+			flush();
+		}
+		m_buffer.append(text);
+		return *this;
+	}
+
+	Output& operator<<(char c) {
+		if (m_buffer.size() + 1 > BUFFER_SIZE) {
+			flush();
+		}
+		m_buffer.push_back(c);
+		return *this;
+	}
+
+	Output& operator<<(int value) {
+		char buffer[16];
+		auto [end, error] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+		return *this << std::string_view(buffer, end - buffer);
+	}
+
+	Output& operator<<(double value) {
+		char buffer[32];
+		return *this << formatNumber(value, m_precision, buffer, sizeof(buffer));
+	}
+
+	/// Writes the coordinates of a point, with the y-axis pointing down as in SVG.
+	Output& operator<<(const Point<Inexact>& p) {
+		return *this << p.x() << ' ' << -p.y();
+	}
+
+	/// Returns the number of bytes written so far, before compression.
+	size_t bytes() const {
+		return m_written + m_buffer.size();
+	}
+
+	/// Writes the remaining buffer and closes the file.
+	void close() {
+		flush();
+#ifdef CARTOCROW_HAVE_ZLIB
+		if (m_gzip) {
+			int result = gzclose(m_gzip);
+			m_gzip = nullptr;
+			if (result != Z_OK) {
+				throw std::runtime_error("Could not write " + m_file.string());
+			}
+			return;
+		}
+#endif
+		m_stream.close();
+		if (!m_stream) {
+			throw std::runtime_error("Could not write " + m_file.string());
+		}
+	}
+
+  private:
+	void flush() {
+		if (m_buffer.empty()) {
+			return;
+		}
+		bool success;
+#ifdef CARTOCROW_HAVE_ZLIB
+		if (m_gzip) {
+			success = gzwrite(m_gzip, m_buffer.data(), static_cast<unsigned>(m_buffer.size())) ==
+			          static_cast<int>(m_buffer.size());
+		} else {
+			success = static_cast<bool>(m_stream.write(m_buffer.data(), m_buffer.size()));
+		}
+#else
+		success = static_cast<bool>(m_stream.write(m_buffer.data(), m_buffer.size()));
+#endif
+		if (!success) {
+			throw std::runtime_error("Could not write " + m_file.string());
+		}
+		m_written += m_buffer.size();
+		m_buffer.clear();
+	}
+
+	/// The number of bytes collected before they are written to the file.
+	static constexpr size_t BUFFER_SIZE = 1 << 16;
+
+	/// The file we're writing to.
+	std::filesystem::path m_file;
+	/// The uncompressed output stream, if not compressing.
+	std::ofstream m_stream;
+#ifdef CARTOCROW_HAVE_ZLIB
+	/// The compressed output stream, if compressing.
+	gzFile m_gzip = nullptr;
+#endif
+	/// Output that has not been written to the file yet.
+	std::string m_buffer;
+	/// The number of bytes written to the file, before compression.
+	size_t m_written = 0;
+	/// The number of significant digits of numbers.
+	int m_precision;
+};
+
+SvgRenderer::SvgRenderer() {}
+
 SvgRenderer::SvgRenderer(const std::shared_ptr<GeometryPainting>& painting) {
 	m_paintings.push_back(DrawnPainting{painting});
 }
@@ -44,31 +205,109 @@ SvgRenderer::SvgRenderer(const std::shared_ptr<GeometryPainting>& painting, cons
 	m_paintings.push_back(DrawnPainting{painting, name});
 }
 
-void SvgRenderer::save(const std::filesystem::path& file) {
-	std::locale::global(std::locale("C"));
-	m_out.open(file);
-	m_out << "<svg version=\"1.1\" xmlns:inkscape=\"http://www.inkscape.org/namespaces/inkscape\" xmlns=\"http://www.w3.org/2000/svg\">\n";
-	m_out << "<defs><circle id=\"vertex\" cx=\"0\" cy=\"0\" r=\"4\"/></defs>\n";
+SvgRenderer::~SvgRenderer() {}
+
+bool SvgRenderer::supportsCompression() {
+#ifdef CARTOCROW_HAVE_ZLIB
+	return true;
+#else
+	return false;
+#endif
+}
+
+void SvgRenderer::setPrecision(int digits) {
+	m_precision = std::clamp(digits, 1, 17);
+}
 
-	for (auto painting : m_paintings) {
-		m_out << "<g inkscape:groupmode=\"layer\"";
+void SvgRenderer::save(const std::filesystem::path& file) {
+	m_out = std::make_unique<Output>(file, file.extension() == ".svgz", m_precision);
+	m_classes.clear();
+	m_classIndex.clear();
+	m_style.m_class = -1;
+	m_style.m_vertexClass = -1;
+	m_statistics.clear();
+
+	*m_out << "<svg version=\"1.1\" xmlns=\"http://www.w3.org/2000/svg\" "
+	          "xmlns:xlink=\"http://www.w3.org/1999/xlink\" "
+	          "xmlns:inkscape=\"http://www.inkscape.org/namespaces/inkscape\">\n";
+	*m_out << "<defs><circle id=\"vertex\" cx=\"0\" cy=\"0\" r=\"4\"/></defs>\n";
+
+	for (const auto& painting : m_paintings) {
+		*m_out << "<g inkscape:groupmode=\"layer\"";
 		if (painting.name) {
-			m_out << " inkscape:label=\"" << *painting.name << "\"";
+			*m_out << " inkscape:label=\"" << escapeForSvg(*painting.name) << "\"";
 		}
-		m_out << ">\n";
+		*m_out << ">\n";
+		RenderStatistics& statistics = m_statistics.emplace_back();
+		statistics.m_name = painting.name.value_or("");
+		size_t bytes = m_out->bytes();
+		Timer timer;
 		pushStyle();
-		painting.m_painting->paint(*this);
+		StatisticsRenderer counter(*this, statistics);
+		painting.m_painting->paint(counter);
 		popStyle();
-		m_out << "</g>\n";
+		*m_out << "</g>\n";
+		statistics.m_time = timer.peek();
+		statistics.m_bytes = m_out->bytes() - bytes;
+	}
+
+	*m_out << "<style>\n";
+	for (size_t i = 0; i < m_classes.size(); ++i) {
+		*m_out << ".s" << static_cast<int>(i) << '{' << m_classes[i] << "}\n";
 	}
+	*m_out << "</style>\n";
+	*m_out << "</svg>\n";
+	m_out->close();
+	m_out.reset();
+}
+
+const std::vector<RenderStatistics>& SvgRenderer::statistics() const {
+	return m_statistics;
+}
+
+void SvgRenderer::saveStatistics(const std::filesystem::path& file) const {
+	RenderStatistics::saveJson(file, m_statistics);
+}
 
-	m_out << "</svg>\n";
-	m_out.close();
+void SvgRenderer::beginPath() {
+	*m_out << "<path class=\"s" << styleClass() << "\" d=\"";
+}
+
+void SvgRenderer::endPath() {
+	*m_out << "\"/>\n";
+}
+
+template <class InputIterator>
+void SvgRenderer::writeCurve(InputIterator begin, InputIterator end, bool closed) {
+	if (begin == end) {
+		return;
+	}
+	*m_out << 'M' << *begin;
+	if (++begin != end) {
+		*m_out << 'L' << *begin;
+		while (++begin != end) {
+			*m_out << ' ' << *begin;
+		}
+	}
+	if (closed) {
+		*m_out << 'Z';
+	}
 }
 
 void SvgRenderer::draw(const Point<Inexact>& p) {
-	m_out << "<use xlink:href=\"#vertex\" " << getVertexStyle() << " x=\"" << p.x() << "\" y=\""
-	      << -p.y() << "\"/>\n";
+	*m_out << "<use xlink:href=\"#vertex\" class=\"s" << vertexClass() << "\" x=\"" << p.x()
+	       << "\" y=\"" << -p.y() << "\"/>\n";
+}
+
+void SvgRenderer::draw(const Segment<Inexact>& s) {
+	beginPath();
+	*m_out << 'M' << s.source() << 'L' << s.target();
+	endPath();
+
+	if (m_style.m_mode & vertices) {
+		draw(s.source());
+		draw(s.target());
+	}
 }
 
 void SvgRenderer::draw(const Line<Inexact>& l) {
@@ -79,7 +318,7 @@ void SvgRenderer::draw(const Line<Inexact>& l) {
 		if (const Segment<Inexact>* s = boost::get<Segment<Inexact>>(&*result)) {
 			int oldMode = m_style.m_mode;
 			setMode(oldMode & ~vertices);
-			GeometryRenderer::draw(*s);
+			draw(*s);
 			setMode(oldMode);
 		}
 	}
@@ -93,7 +332,7 @@ void SvgRenderer::draw(const Ray<Inexact>& r) {
 		if (const Segment<Inexact>* s = boost::get<Segment<Inexact>>(&*result)) {
 			int oldMode = m_style.m_mode;
 			setMode(oldMode & ~vertices);
-			GeometryRenderer::draw(*s);
+			draw(*s);
 			setMode(oldMode);
 		}
 		if (m_style.m_mode & vertices) {
@@ -102,19 +341,55 @@ void SvgRenderer::draw(const Ray<Inexact>& r) {
 	}
 }
 
-void SvgRenderer::draw(const PolygonWithHoles<Inexact>& p) {
-	m_out << "<path " << getStyle() << " d=\"";
-	m_out << convertPolygonToCurve(p.outer_boundary());
-	for (auto hole : p.holes()) {
-		m_out << " " << convertPolygonToCurve(hole);
+void SvgRenderer::draw(const Polyline<Inexact>& polyline) {
+	Polyline<Inexact> simplified;
+	const Polyline<Inexact>& p = *applyLod(polyline, simplified);
+	beginPath();
+	writeCurve(p.vertices_begin(), p.vertices_end(), false);
+	endPath();
+
+	if (m_style.m_mode & vertices) {
+		for (auto v = p.vertices_begin(); v != p.vertices_end(); v++) {
+			draw(*v);
+		}
+	}
+}
+
+void SvgRenderer::draw(const Polygon<Inexact>& polygon) {
+	Polygon<Inexact> simplified;
+	const Polygon<Inexact>* p = applyLod(polygon, simplified);
+	if (!p) {
+		return;
 	}
-	m_out << "\"/>\n";
+	beginPath();
+	writeCurve(p->vertices_begin(), p->vertices_end(), true);
+	endPath();
 
 	if (m_style.m_mode & vertices) {
-		for (auto v = p.outer_boundary().vertices_begin(); v != p.outer_boundary().vertices_end(); v++) {
+		for (auto v = p->vertices_begin(); v != p->vertices_end(); v++) {
 			draw(*v);
 		}
-		for (auto h = p.holes_begin(); h != p.holes_end(); h++) {
+	}
+}
+
+void SvgRenderer::draw(const PolygonWithHoles<Inexact>& polygon) {
+	PolygonWithHoles<Inexact> simplified;
+	const PolygonWithHoles<Inexact>* p = applyLod(polygon, simplified);
+	if (!p) {
+		return;
+	}
+	beginPath();
+	writeCurve(p->outer_boundary().vertices_begin(), p->outer_boundary().vertices_end(), true);
+	for (const auto& hole : p->holes()) {
+		writeCurve(hole.vertices_begin(), hole.vertices_end(), true);
+	}
+	endPath();
+
+	if (m_style.m_mode & vertices) {
+		for (auto v = p->outer_boundary().vertices_begin(); v != p->outer_boundary().vertices_end(); v++) {
+			draw(*v);
+		}
+		for (auto h = p->holes_begin(); h != p->holes_end(); h++) {
 			for (auto v = h->vertices_begin(); v != h->vertices_end(); v++) {
 				draw(*v);
 			}
@@ -124,62 +399,126 @@ void SvgRenderer::draw(const PolygonWithHoles<Inexact>& p) {
 
 void SvgRenderer::draw(const Circle<Inexact>& c) {
 	double r = sqrt(c.squared_radius());
-	m_out << "<circle " << getStyle() << " r=\"" << r << "\" cx=\"" << c.center().x() << "\" cy=\""
-	      << -c.center().y() << "\"/>\n";
+	*m_out << "<circle class=\"s" << styleClass() << "\" r=\"" << r << "\" cx=\"" << c.center().x()
+	       << "\" cy=\"" << -c.center().y() << "\"/>\n";
 }
 
 void SvgRenderer::draw(const BezierSpline& s) {
-	// TODO
-	std::cerr << "The SVG renderer does not support BezierSplines; ignoring\n";
-}
-
-void SvgRenderer::draw(const RenderPath& p) {
-	m_out << "<path " << getStyle() << " d=\"";
-	std::vector<Point<Inexact>> verticesToDraw;
-	Point<Inexact> from;
-	for (RenderPath::Command c : p.commands()) {
-		if (std::holds_alternative<RenderPath::MoveTo>(c)) {
-			Point<Inexact> to = std::get<RenderPath::MoveTo>(c).m_to;
-			m_out << "M " << to.x() << " " << -to.y() << " ";
-			verticesToDraw.push_back(to);
-			from = to;
-
-		} else if (std::holds_alternative<RenderPath::LineTo>(c)) {
-			Point<Inexact> to = std::get<RenderPath::LineTo>(c).m_to;
-			m_out << "L " << to.x() << " " << -to.y() << " ";
-			verticesToDraw.push_back(to);
-			from = to;
-
-		} else if (std::holds_alternative<RenderPath::ArcTo>(c)) {
-			Point<Inexact> center = std::get<RenderPath::ArcTo>(c).m_center;
-			Point<Inexact> to = std::get<RenderPath::ArcTo>(c).m_to;
-			bool clockwise = std::get<RenderPath::ArcTo>(c).m_clockwise;
-			double radius = sqrt((center - to).squared_length());
-			bool centerOnLeft = CGAL::orientation(from, to, center) == CGAL::LEFT_TURN;
-			double rotation = 0;  // ellipse rotation; irrelevant because we draw circles only
-			int largeArc = (centerOnLeft == clockwise) ? 1 : 0;
-			int sweep = clockwise ? 1 : 0;
-			m_out << "A " << radius << " " << radius << " " << rotation << " " << largeArc << " "
-			      << sweep << " " << to.x() << " " << -to.y() << " ";
-			verticesToDraw.push_back(to);
-			from = to;
-
-		} else if (std::holds_alternative<RenderPath::Close>(c)) {
-			m_out << "Z ";
+	if (s.curves().empty()) {
+		return;
+	}
+	beginPath();
+	*m_out << 'M' << s.curves().front().source() << 'C';
+	bool first = true;
+	for (const BezierCurve& c : s.curves()) {
+		if (!first) {
+			*m_out << ' ';
 		}
+		*m_out << c.sourceControl() << ' ' << c.targetControl() << ' ' << c.target();
+		first = false;
+	}
+	endPath();
+
+	if (m_style.m_mode & vertices) {
+		for (const BezierCurve& c : s.curves()) {
+			draw(c.source());
+		}
+		draw(s.curves().back().target());
+	}
+}
+
+void SvgRenderer::draw(const CircularArc& a) {
+	const Circle<Inexact>& circle = a.circle();
+	const Point<Inexact> center = circle.center();
+	const double r = sqrt(circle.squared_radius());
+	auto pointAt = [&center, r](double angle) {
+		return Point<Inexact>(center.x() + r * cos(angle), center.y() + r * sin(angle));
+	};
+
+	// SVG arcs are specified by their endpoints, so arcs of (almost) a full
+	// circle are split into pieces of at most half a circle
+	const int pieces = std::max(1, static_cast<int>(std::ceil(std::abs(a.spanAngle()) / M_PI)));
+	const double step = a.spanAngle() / pieces;
+	// the y-axis is flipped, so counter-clockwise arcs have a positive sweep in SVG
+	const int sweep = a.spanAngle() > 0 ? 1 : 0;
+	beginPath();
+	*m_out << 'M' << pointAt(a.startAngle());
+	for (int i = 1; i <= pieces; ++i) {
+		*m_out << 'A' << r << ' ' << r << " 0 0 " << sweep << ' ' << pointAt(a.startAngle() + i * step);
+	}
+	endPath();
+}
+
+void SvgRenderer::drawPoints(std::span<const Point<Inexact>> points) {
+	if (points.empty()) {
+		return;
+	}
+	// one path with a disk for every point, of the same size as the vertex marker
+	*m_out << "<path class=\"s" << vertexClass() << "\" d=\"";
+	for (const Point<Inexact>& p : points) {
+		*m_out << 'M' << Point<Inexact>(p.x() - 4, p.y()) << "a4 4 0 1 0 8 0a4 4 0 1 0-8 0";
+	}
+	endPath();
+}
+
+void SvgRenderer::drawSegments(std::span<const Segment<Inexact>> segments) {
+	if (segments.empty()) {
+		return;
 	}
-	m_out << "\"/>\n";
+	beginPath();
+	for (const Segment<Inexact>& s : segments) {
+		*m_out << 'M' << s.source() << 'L' << s.target();
+	}
+	endPath();
 
 	if (m_style.m_mode & vertices) {
-		for (const Point<Inexact>& vertex : verticesToDraw) {
-			draw(vertex);
+		std::vector<Point<Inexact>> points;
+		points.reserve(2 * segments.size());
+		for (const Segment<Inexact>& s : segments) {
+			points.push_back(s.source());
+			points.push_back(s.target());
+		}
+		drawPoints(points);
+	}
+}
+
+void SvgRenderer::drawPolygons(std::span<const Polygon<Inexact>> polygons) {
+	if (polygons.empty()) {
+		return;
+	}
+	beginPath();
+	std::vector<Point<Inexact>> points;
+	Polygon<Inexact> simplified;
+	for (const Polygon<Inexact>& polygon : polygons) {
+		if (const Polygon<Inexact>* p = applyLod(polygon, simplified)) {
+			writeCurve(p->vertices_begin(), p->vertices_end(), true);
+			if (m_style.m_mode & vertices) {
+				points.insert(points.end(), p->vertices_begin(), p->vertices_end());
+			}
 		}
 	}
+	endPath();
+	drawPoints(points);
+}
+
+void SvgRenderer::drawCircles(std::span<const Circle<Inexact>> circles) {
+	if (circles.empty()) {
+		return;
+	}
+	// every circle as two half-circle arcs, in the same direction so that
+	// overlapping circles do not cancel out
+	beginPath();
+	for (const Circle<Inexact>& c : circles) {
+		double r = sqrt(c.squared_radius());
+		*m_out << 'M' << Point<Inexact>(c.center().x() - r, c.center().y()) << 'a' << r << ' ' << r
+		       << " 0 1 0 " << 2 * r << " 0a" << r << ' ' << r << " 0 1 0 " << -2 * r << " 0";
+	}
+	endPath();
 }
 
 void SvgRenderer::drawText(const Point<Inexact>& p, const std::string& text) {
-	m_out << "<text text-anchor=\"middle\" dominant-baseline=\"middle\" x=\"" << p.x() << "\" y=\""
-	      << -p.y() << "\">" << escapeForSvg(text) << "</text>\n";
+	*m_out << "<text text-anchor=\"middle\" dominant-baseline=\"middle\" x=\"" << p.x() << "\" y=\""
+	       << -p.y() << "\">" << escapeForSvg(text) << "</text>\n";
 }
 
 void SvgRenderer::pushStyle() {
@@ -193,66 +532,75 @@ void SvgRenderer::popStyle() {
 
 void SvgRenderer::setMode(int mode) {
 	m_style.m_mode = mode;
+	m_style.m_class = -1;
 }
 
-void SvgRenderer::setStroke(Color color, double width, [[maybe_unused]] bool absoluteWidth) {
-	m_style.m_strokeColor = "rgb(" + std::to_string(color.r) + ", " + std::to_string(color.g) +
-	                        ", " + std::to_string(color.b) + ")";
+void SvgRenderer::setStroke(Color color, double width) {
+	m_style.m_strokeColor = color;
 	m_style.m_strokeWidth = width;
+	m_style.m_class = -1;
+	m_style.m_vertexClass = -1;
 }
 
 void SvgRenderer::setStrokeOpacity(int alpha) {
 	m_style.m_strokeOpacity = alpha / 255.0;
+	m_style.m_class = -1;
+	m_style.m_vertexClass = -1;
 }
 
 void SvgRenderer::setFill(Color color) {
-	m_style.m_fillColor = "rgb(" + std::to_string(color.r) + ", " + std::to_string(color.g) + ", " +
-	                      std::to_string(color.b) + ")";
+	m_style.m_fillColor = color;
+	m_style.m_class = -1;
 }
 
 void SvgRenderer::setFillOpacity(int alpha) {
 	m_style.m_fillOpacity = alpha / 255.0;
+	m_style.m_class = -1;
 }
 
-std::string SvgRenderer::convertPolygonToCurve(const Polygon<Inexact>& p) const {
-	std::stringstream result;
-	bool first = true;
-	for (auto& vertex : p) {
-		result << (first ? "M " : "L ") << vertex.x() << " " << -vertex.y() << " ";
-		first = false;
+int SvgRenderer::styleClass() {
+	if (m_style.m_class >= 0) {
+		return m_style.m_class;
 	}
-	result << "Z";
-	return result.str();
-}
-
-std::string SvgRenderer::getStyle() const {
-	if ((m_style.m_mode & GeometryRenderer::fill) && (m_style.m_mode & GeometryRenderer::stroke)) {
-		return "fill=\"" + m_style.m_fillColor +
-		       "\" fill-opacity=\"" + std::to_string(m_style.m_fillOpacity) +
-		       "\" stroke=\"" + m_style.m_strokeColor +
-		       "\" stroke-linecap=\"round" +
-		       "\" stroke-linejoin=\"round" +
-		       "\" stroke-opacity=\"" + std::to_string(m_style.m_strokeOpacity) +
-		       "\" stroke-width=\"" + std::to_string(m_style.m_strokeWidth) + "\"";
-	} else if (m_style.m_mode & GeometryRenderer::fill) {
-		return "fill=\"" + m_style.m_fillColor +
-		       "\" fill-opacity=\"" + std::to_string(m_style.m_fillOpacity) + "\"";
+	std::string declarations;
+	if (m_style.m_mode & GeometryRenderer::fill) {
+		declarations += "fill:" + formatColor(m_style.m_fillColor) + ";";
+		if (m_style.m_fillOpacity != 1) {
+			declarations += "fill-opacity:" + formatNumber(m_style.m_fillOpacity, 3) + ";";
+		}
 	} else {
-		return "fill=\"none\" stroke=\"" + m_style.m_strokeColor +
-		       "\" stroke-linecap=\"round" +
-		       "\" stroke-linejoin=\"round" +
-		       "\" stroke-opacity=\"" + std::to_string(m_style.m_strokeOpacity) +
-		       "\" stroke-width=\"" + std::to_string(m_style.m_strokeWidth) + "\"";
+		declarations += "fill:none;";
+	}
+	if ((m_style.m_mode & GeometryRenderer::stroke) || !(m_style.m_mode & GeometryRenderer::fill)) {
+		declarations += "stroke:" + formatColor(m_style.m_strokeColor) + ";";
+		if (m_style.m_strokeOpacity != 1) {
+			declarations += "stroke-opacity:" + formatNumber(m_style.m_strokeOpacity, 3) + ";";
+		}
+		declarations += "stroke-width:" + formatNumber(m_style.m_strokeWidth, m_precision) +
+		                ";stroke-linecap:round;stroke-linejoin:round;";
 	}
+	m_style.m_class = lookupClass(std::move(declarations));
+	return m_style.m_class;
 }
 
-std::string SvgRenderer::getVertexStyle() const {
-	if ((m_style.m_mode & GeometryRenderer::vertices)) {
-		return "fill=\"" + m_style.m_strokeColor +
-		       "\" fill-opacity=\"" + std::to_string(m_style.m_strokeOpacity) + "\"";
-	} else {
-		return "";
+int SvgRenderer::vertexClass() {
+	if (m_style.m_vertexClass >= 0) {
+		return m_style.m_vertexClass;
+	}
+	std::string declarations = "fill:" + formatColor(m_style.m_strokeColor) + ";";
+	if (m_style.m_strokeOpacity != 1) {
+		declarations += "fill-opacity:" + formatNumber(m_style.m_strokeOpacity, 3) + ";";
 	}
+	m_style.m_vertexClass = lookupClass(std::move(declarations));
+	return m_style.m_vertexClass;
+}
+
+int SvgRenderer::lookupClass(std::string declarations) {
+	auto [it, inserted] = m_classIndex.try_emplace(declarations, static_cast<int>(m_classes.size()));
+	if (inserted) {
+		m_classes.push_back(std::move(declarations));
+	}
+	return it->second;
 }
 
 void SvgRenderer::addPainting(const std::shared_ptr<GeometryPainting>& painting) {
@@ -266,20 +614,27 @@ void SvgRenderer::addPainting(const std::shared_ptr<GeometryPainting>& painting,
 }
 
 std::string SvgRenderer::escapeForSvg(const std::string& text) const {
-	std::stringstream result;
-	for (int i = 0; i < text.size(); i++) {
-		switch (text[i]) {
+	std::string result;
+	result.reserve(text.size());
+	for (char c : text) {
+		switch (c) {
 		case '<':
-			result << "&lt;";
+			result += "&lt;";
 			break;
 		case '>':
-			result << "&gt;";
+			result += "&gt;";
+			break;
+		case '&':
+			result += "&amp;";
+			break;
+		case '"':
+			result += "&quot;";
 			break;
 		default:
-			result << text[i];
+			result += c;
 		}
 	}
-	return result.str();
+	return result;
 }
 
 } // namespace cartocrow::renderer
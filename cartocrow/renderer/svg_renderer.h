@@ -20,64 +20,98 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #ifndef CARTOCROW_RENDERER_SVG_RENDERER_H
 #define CARTOCROW_RENDERER_SVG_RENDERER_H
 
-#include <QPainter>
-
 #include <filesystem>
-#include <fstream>
+#include <memory>
+#include <optional>
 #include <stack>
+#include <string>
+#include <unordered_map>
 
 #include "geometry_painting.h"
 #include "geometry_renderer.h"
+#include "render_statistics.h"
 
 namespace cartocrow::renderer {
 
-/// The style for a GeometryWidget.
+/// The style for a SvgRenderer.
 struct SvgRendererStyle {
 	/// The draw mode.
 	int m_mode = GeometryRenderer::stroke;
-	/// The diameter of points.
-	double m_pointSize = 10;
 	/// The color of points and lines.
-	std::string m_strokeColor = "#000000";
+	Color m_strokeColor{0, 0, 0};
 	/// The opacity of points and lines.
 	double m_strokeOpacity = 1;
 	/// The width of lines.
 	double m_strokeWidth = 1;
-	/// Whether the width is interpreted as absolute, that is, independent of
-	/// the renderer's zoom factor.
-	bool m_absoluteWidth = false;
 	/// The color of filled shapes.
-	std::string m_fillColor = "#0066cb";
+	Color m_fillColor{0, 102, 203};
 	/// The opacity of filled shapes.
 	double m_fillOpacity = 1;
+	/// The CSS class of shapes drawn in this style, or -1 if it has not been
+	/// looked up yet.
+	int m_class = -1;
+	/// The CSS class of vertices drawn in this style, or -1 if it has not been
+	/// looked up yet.
+	int m_vertexClass = -1;
 };
 
 /// SVG specialization of the GeometryRenderer.
+///
+/// The output is written through a buffer, with numbers formatted by
+/// `std::to_chars`, so it does not depend on the global locale. Every distinct
+/// style is written only once, as a CSS class; elements refer to it by name.
+/// Since the set of styles is only known after painting, the `<style>` element
+/// is written at the end of the document.
 class SvgRenderer : public GeometryRenderer {
 
   public:
-	SvgRenderer() = default;
+	SvgRenderer();
 
 	/// Constructs a SvgRenderer for the given painting.
 	SvgRenderer(const std::shared_ptr<GeometryPainting>& painting);
 	SvgRenderer(const std::shared_ptr<GeometryPainting>& painting, const std::string& name);
+	~SvgRenderer();
 
-	/// Saves the painting to an SVG file with the given name.
+	/// Saves the painting to an SVG file with the given name. If the file name
+	/// has the extension `.svgz`, the output is compressed with gzip.
+	///
+	/// Throws a `std::runtime_error` if the file cannot be written, or if it
+	/// should be compressed and \ref supportsCompression() is false.
 	void save(const std::filesystem::path& file);
+	/// Checks whether this build can write compressed `.svgz` files, which
+	/// needs zlib.
+	static bool supportsCompression();
+
+	/// Returns statistics about drawing each painting in the last call to
+	/// \ref save().
+	const std::vector<RenderStatistics>& statistics() const;
+	/// Writes the \ref statistics() to a JSON file.
+	void saveStatistics(const std::filesystem::path& file) const;
+
+	/// Sets the number of significant digits with which coordinates are
+	/// written. The default is 6.
+	void setPrecision(int digits);
 
 	void draw(const Point<Inexact>& p) override;
+	void draw(const Segment<Inexact>& s) override;
+	void draw(const Polygon<Inexact>& p) override;
 	void draw(const PolygonWithHoles<Inexact>& p) override;
 	void draw(const Circle<Inexact>& c) override;
 	void draw(const BezierSpline& s) override;
 	void draw(const Line<Inexact>& l) override;
 	void draw(const Ray<Inexact>& r) override;
-	void draw(const RenderPath& p) override;
+	void draw(const Polyline<Inexact>& p) override;
+	void draw(const CircularArc& a) override;
+	void drawPoints(std::span<const Point<Inexact>> points) override;
+	void drawSegments(std::span<const Segment<Inexact>> segments) override;
+	void drawPolygons(std::span<const Polygon<Inexact>> polygons) override;
+	void drawCircles(std::span<const Circle<Inexact>> circles) override;
 	void drawText(const Point<Inexact>& p, const std::string& text) override;
 
 	void pushStyle() override;
 	void popStyle() override;
 	void setMode(int mode) override;
-	void setStroke(Color color, double width, bool absoluteWidth = false) override;
+	void setStroke(Color color, double width) override;
 	void setStrokeOpacity(int alpha) override;
 	void setFill(Color color) override;
 	void setFillOpacity(int alpha) override;
@@ -86,14 +120,24 @@ class SvgRenderer : public GeometryRenderer {
 	void addPainting(const std::shared_ptr<GeometryPainting>& painting, const std::string& name);
 
   private:
-	/// The output file we're writing to.
-	std::ofstream m_out;
-	/// Converts a polygon to an SVG path specification.
-	std::string convertPolygonToCurve(const Polygon<Inexact>& p) const;
-	/// Returns the style as a string that can be added to an SVG path element.
-	std::string getStyle() const;
-	/// Returns the style as a string that can be added to an SVG use element.
-	std::string getVertexStyle() const;
+	/// Buffered writer for the output file, defined in the source file.
+	class Output;
+
+	/// Starts a `<path>` element in the current style, up to the opening quote
+	/// of its `d` attribute.
+	void beginPath();
+	/// Ends a `<path>` element started with \ref beginPath().
+	void endPath();
+	/// Writes an SVG path specification of the given points to the output.
+	template <class InputIterator>
+	void writeCurve(InputIterator begin, InputIterator end, bool closed);
+	/// Returns the CSS class for shapes in the current style.
+	int styleClass();
+	/// Returns the CSS class for vertices in the current style.
+	int vertexClass();
+	/// Returns the index of the CSS class with the given declarations, adding
+	/// it if it does not exist yet.
+	int lookupClass(std::string declarations);
 	/// Escapes SVG's reserved characters.
 	std::string escapeForSvg(const std::string& text) const;
 
@@ -108,13 +152,23 @@ class SvgRenderer : public GeometryRenderer {
 		std::optional<std::string> name;
 	};
 
+	/// The output file we're writing to, while saving.
+	std::unique_ptr<Output> m_out;
+	/// The number of significant digits of coordinates.
+	int m_precision = 6;
 	/// The paintings we're drawing.
 	std::vector<DrawnPainting> m_paintings;
+	/// Statistics about drawing each painting in \ref m_paintings.
+	std::vector<RenderStatistics> m_statistics;
 	/// The current drawing style.
 	SvgRendererStyle m_style;
 	/// A stack of drawing styles, used by \ref pushStyle() and \ref popStyle()
 	/// to store previously pushed styles.
 	std::stack<SvgRendererStyle> m_styleStack;
+	/// The declarations of every CSS class, indexed by class.
+	std::vector<std::string> m_classes;
+	/// Maps CSS declarations to the index of their class in \ref m_classes.
+	std::unordered_map<std::string, int> m_classIndex;
 };
 
 } // namespace cartocrow::renderer
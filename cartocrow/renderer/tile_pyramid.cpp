@@ -0,0 +1,141 @@
+/*
+The CartoCrow library implements algorithmic geo-visualization methods,
+developed at TU Eindhoven.
+Copyright (C) 2021  Netherlands eScience Center and TU Eindhoven
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "tile_pyramid.h"
+
+#include <QPainter>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace cartocrow::renderer {
+
+TilePyramid::TilePyramid(const std::shared_ptr<GeometryPainting>& painting, const Box& bounds,
+                         int tileSize)
+    : m_scene(*painting, GeometryWidgetStyle()), m_tileSize(tileSize) {
+	m_size = std::max(bounds.xmax() - bounds.xmin(), bounds.ymax() - bounds.ymin());
+	m_left = 0.5 * (bounds.xmin() + bounds.xmax() - m_size);
+	m_top = 0.5 * (bounds.ymin() + bounds.ymax() + m_size);
+}
+
+void TilePyramid::setBackground(const QColor& color) {
+	m_background = color;
+}
+
+QImage TilePyramid::renderTile(int z, int x, int y) const {
+	return renderTile(z, x, y, false);
+}
+
+QImage TilePyramid::renderTile(int z, int x, int y, bool copyPaths) const {
+	QImage image(m_tileSize, m_tileSize, QImage::Format_ARGB32_Premultiplied);
+	image.fill(m_background);
+
+	double side = std::ldexp(m_size, -z);
+	double left = m_left + x * side;
+	double top = m_top - y * side;
+	double zoom = m_tileSize / side;
+	// Flip the y-axis, and put the top-left corner of the tile at the origin.
+	QTransform transform(zoom, 0, 0, -zoom, -left * zoom, top * zoom);
+
+	QPainter painter(&image);
+	painter.setRenderHint(QPainter::Antialiasing);
+	m_scene.paint(painter, transform, Box(left, top - side, left + side, top), copyPaths);
+	return image;
+}
+
+int TilePyramid::save(const std::filesystem::path& directory, int minZoom, int maxZoom, int threads) const {
+	struct Tile {
+		int z;
+		int x;
+		int y;
+	};
+	if (minZoom < 0 || maxZoom > MAX_ZOOM) {
+		throw std::runtime_error("Zoom levels must be between 0 and " + std::to_string(MAX_ZOOM));
+	}
+	std::vector<Tile> tiles;
+	for (int z = minZoom; z <= maxZoom; ++z) {
+		int n = 1 << z;
+		for (int x = 0; x < n; ++x) {
+			std::filesystem::create_directories(directory / std::to_string(z) / std::to_string(x));
+			for (int y = 0; y < n; ++y) {
+				tiles.push_back({z, x, y});
+			}
+		}
+	}
+
+	auto renderAndSave = [this, &directory, &tiles](int i, bool copyPaths) {
+		const Tile& tile = tiles[i];
+		std::filesystem::path file = directory / std::to_string(tile.z) / std::to_string(tile.x) /
+		                             (std::to_string(tile.y) + ".png");
+		if (!renderTile(tile.z, tile.x, tile.y, copyPaths).save(QString::fromStdString(file.string()), "PNG")) {
+			throw std::runtime_error("Could not write " + file.string());
+		}
+	};
+
+	// Render the tiles on a pool of workers that each take the next unrendered tile.
+	int nThreads = threads > 0 ? threads : static_cast<int>(std::thread::hardware_concurrency());
+	nThreads = std::max(1, std::min(nThreads, static_cast<int>(tiles.size())));
+	if (nThreads == 1) {
+		for (int i = 0; i < tiles.size(); ++i) {
+			renderAndSave(i, false);
+		}
+	} else {
+		int tileCount = static_cast<int>(tiles.size());
+		std::atomic<int> next = 0;
+		std::vector<std::future<void>> workers;
+		for (int w = 0; w < nThreads; ++w) {
+			workers.push_back(std::async(std::launch::async, [&next, tileCount, &renderAndSave]() {
+				for (int i = next++; i < tileCount; i = next++) {
+					try {
+						renderAndSave(i, true);
+					} catch (...) {
+						// Let the other workers stop after their current tile.
+						next = tileCount;
+						throw;
+					}
+				}
+			}));
+		}
+		// Wait for all workers before rethrowing the first error, as they
+		// refer to our local variables.
+		std::exception_ptr error;
+		for (auto& worker : workers) {
+			try {
+				worker.get();
+			} catch (...) {
+				if (!error) {
+					error = std::current_exception();
+				}
+			}
+		}
+		if (error) {
+			std::rethrow_exception(error);
+		}
+	}
+	return static_cast<int>(tiles.size());
+}
+
+} // namespace cartocrow::renderer
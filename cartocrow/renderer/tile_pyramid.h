@@ -0,0 +1,99 @@
+/*
+The CartoCrow library implements algorithmic geo-visualization methods,
+developed at TU Eindhoven.
+Copyright (C) 2021  Netherlands eScience Center and TU Eindhoven
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef CARTOCROW_RENDERER_TILE_PYRAMID_H
+#define CARTOCROW_RENDERER_TILE_PYRAMID_H
+
+#include <QColor>
+#include <QImage>
+
+#include <filesystem>
+#include <memory>
+
+#include "geometry_painting.h"
+#include "retained_scene.h"
+
+namespace cartocrow::renderer {
+
+/// Renders a painting to a pyramid of raster tiles for a web map.
+///
+/// The painting is recorded into a \ref RetainedScene when the TilePyramid is
+/// constructed. Every tile then only draws the recorded objects that intersect
+/// it, so tiles can be rendered independently. All threads of \ref save() share
+/// the one scene; as Qt caches data in a path when it is drawn, they draw each
+/// path from a copy of their own (see \ref RetainedScene::paint()), so
+/// rendering in parallel does not cost memory for additional scenes. \ref
+/// renderTile() draws the scene directly, and should not be called
+/// concurrently. The painting should not draw text unless a \ref
+/// QGuiApplication exists, which provides the fonts.
+///
+/// The tiles follow the usual z/x/y scheme: at zoom level \f$z\f$, the square
+/// around the given bounds is divided into \f$2^z \times 2^z\f$ tiles, with
+/// tile (0, 0) in the top-left corner. As in a \ref GeometryWidget, line widths
+/// and point sizes are in pixels and hence the same on every zoom level.
+class TilePyramid {
+  public:
+	/// Records the given painting for tiles covering \p bounds, in drawing
+	/// coordinates. If \p bounds is not square, it is extended to a square
+	/// around the same center.
+	TilePyramid(const std::shared_ptr<GeometryPainting>& painting, const Box& bounds,
+	            int tileSize = 256);
+
+	/// Sets the color tiles are filled with before drawing. The default is
+	/// transparent.
+	void setBackground(const QColor& color);
+
+	/// Renders tile (\p x, \p y) on zoom level \p z.
+	QImage renderTile(int z, int x, int y) const;
+	/// The highest zoom level \ref save() accepts; its tiles already number
+	/// \f$2^{30} \times 2^{30}\f$.
+	static constexpr int MAX_ZOOM = 30;
+	/// Renders all tiles on zoom levels \p minZoom up to and including \p
+	/// maxZoom, and writes them to `directory/z/x/y.png`. The tiles are
+	/// rendered by \p threads threads; if this is 0, by as many threads as the
+	/// hardware supports. Returns the number of tiles written.
+	///
+	/// Throws a `std::runtime_error` if the zoom levels are not between 0 and
+	/// \ref MAX_ZOOM, or if a tile cannot be written; in the latter case the
+	/// other threads stop rendering as well.
+	int save(const std::filesystem::path& directory, int minZoom, int maxZoom, int threads = 0) const;
+
+  private:
+	/// Renders tile (\p x, \p y) on zoom level \p z, drawing copies of the
+	/// paths if \p copyPaths is set.
+	QImage renderTile(int z, int x, int y, bool copyPaths) const;
+
+	/// The recorded painting.
+	RetainedScene m_scene;
+	/// The left side of the square covered by the pyramid.
+	double m_left;
+	/// The top side of the square covered by the pyramid.
+	double m_top;
+	/// The side length of the square covered by the pyramid.
+	double m_size;
+	/// The width and height of a tile, in pixels.
+	int m_tileSize;
+	/// The color of the background.
+	QColor m_background = Qt::transparent;
+};
+
+} // namespace cartocrow::renderer
+
+#endif //CARTOCROW_RENDERER_TILE_PYRAMID_H
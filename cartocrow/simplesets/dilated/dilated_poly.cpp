@@ -1,7 +1,9 @@
 #include "dilated_poly.h"
 #include "../helpers/cs_polygon_helpers.h"
 #include "../helpers/arrangement_helpers.h"
+#include "../patterns/single_point.h"
 #include <CGAL/approximated_offset_2.h>
+#include <algorithm>
 
 namespace cartocrow::simplesets {
 CSPolygon dilateSegment(const Segment<Inexact>& segment, const Number<Inexact>& dilationRadius) {
@@ -70,4 +72,41 @@ const std::vector<CatPoint>& Dilated::catPoints() const {
 std::variant<Polyline<Inexact>, Polygon<Inexact>, CSPolygon> Dilated::contour() const {
 	return m_contour;
 }
+
+DilationCache::DilationCache(std::size_t maxPoints) : m_maxPoints(std::max<std::size_t>(maxPoints, 1)) {}
+
+const Dilated& DilationCache::get(const PolyPattern& pattern, const Number<Inexact>& dilationRadius) {
+	auto& dilated = m_patterns[{&pattern, dilationRadius}];
+	if (dilated == nullptr) {
+		dilated = std::make_unique<Dilated>(pattern, dilationRadius);
+	}
+	return *dilated;
+}
+
+const Dilated& DilationCache::get(const CatPoint& point, const Number<Inexact>& dilationRadius) {
+	std::tuple key(point.point.x(), point.point.y(), dilationRadius);
+	if (m_points.size() >= m_maxPoints && !m_points.contains(key)) {
+		// Nearby points are queried together, so start over instead of keeping track of which ones were used last.
+		m_points.clear();
+	}
+	auto& dilated = m_points[key];
+	if (dilated == nullptr) {
+		dilated = std::make_unique<Dilated>(SinglePoint(point), dilationRadius);
+	}
+	return *dilated;
+}
+
+void DilationCache::erase(const PolyPattern& pattern) {
+	auto first = m_patterns.lower_bound({&pattern, -std::numeric_limits<Number<Inexact>>::infinity()});
+	auto last = first;
+	while (last != m_patterns.end() && last->first.first == &pattern) {
+		++last;
+	}
+	m_patterns.erase(first, last);
+}
+
+void DilationCache::clear() {
+	m_patterns.clear();
+	m_points.clear();
+}
 }
@@ -2,6 +2,9 @@
 #define CARTOCROW_DILATED_POLY_H
 
 #include "../patterns/poly_pattern.h"
+#include <map>
+#include <memory>
+#include <tuple>
 
 namespace cartocrow::simplesets {
 class Dilated : public Pattern {
@@ -14,5 +17,27 @@ class Dilated : public Pattern {
   private:
 	std::vector<CatPoint> m_catPoints;
 };
+
+/// Caches dilations of patterns, keyed by pattern identity and dilation radius.
+/// Patterns are identified by their address: a pattern should be erased from the cache before it is destroyed.
+/// Dilations of single points are not tied to a pattern, so at most a fixed number of them is kept.
+class DilationCache {
+  public:
+	/// Creates an empty cache that keeps the dilations of at most \p maxPoints single points.
+	explicit DilationCache(std::size_t maxPoints = 4096);
+	/// Returns the dilation of the pattern, computing it if it is not cached yet.
+	const Dilated& get(const PolyPattern& pattern, const Number<Inexact>& dilationRadius);
+	/// Returns the dilation of a single point, computing it if it is not cached yet.
+	/// The result is valid until the next call of this function.
+	const Dilated& get(const CatPoint& point, const Number<Inexact>& dilationRadius);
+	/// Removes the dilations of the pattern.
+	void erase(const PolyPattern& pattern);
+	void clear();
+
+  private:
+	std::size_t m_maxPoints;
+	std::map<std::pair<const PolyPattern*, Number<Inexact>>, std::unique_ptr<Dilated>> m_patterns;
+	std::map<std::tuple<Number<Inexact>, Number<Inexact>, Number<Inexact>>, std::unique_ptr<Dilated>> m_points;
+};
 }
 #endif //CARTOCROW_DILATED_POLY_H
@@ -7,8 +7,14 @@
 #include "helpers/cs_curve_helpers.h"
 #include "helpers/cs_polygon_helpers.h"
 #include "helpers/cs_polyline_helpers.h"
+#include "helpers/scratch_arena.h"
 #include <CGAL/Boolean_set_operations_2.h>
 #include <CGAL/Boolean_set_operations_2/Gps_polygon_validation.h>
+#include <boost/dynamic_bitset.hpp>
+#include <numeric>
+#include <set>
+#include <tuple>
+#include <unordered_set>
 #include <utility>
 #include "cartocrow/renderer/ipe_renderer.h"
 
@@ -131,79 +137,117 @@ Point<Exact> get_point_in(const Face& face) {
 	return midpoint(Segment<Exact>(approx_source, approx_target));
 }
 
-std::vector<Component>
-connectedComponents(const DilatedPatternArrangement& arr, const std::function<bool(FaceH)>& in_component) {
-	std::vector<FaceH> remaining;
-	for (auto fit = arr.faces_begin(); fit != arr.faces_end(); ++fit) {
-		auto fh = fit.ptr();
-		if (in_component(fh)) {
-			remaining.emplace_back(fh);
+namespace {
+/// Disjoint-set forest over the indices 0, ..., n-1, with union by size and path halving.
+class UnionFind {
+  public:
+	explicit UnionFind(int n) : m_parent(n), m_size(n, 1) {
+		std::iota(m_parent.begin(), m_parent.end(), 0);
+	}
+
+	int find(int x) {
+		while (m_parent[x] != x) {
+			m_parent[x] = m_parent[m_parent[x]];
+			x = m_parent[x];
 		}
+		return x;
 	}
 
-	std::vector<Component> components;
+	void merge(int x, int y) {
+		x = find(x);
+		y = find(y);
+		if (x == y) return;
+		if (m_size[x] < m_size[y]) std::swap(x, y);
+		m_parent[y] = x;
+		m_size[x] += m_size[y];
+	}
 
-	while (!remaining.empty()) {
-		// We do a BFS
-		std::vector<FaceH> compFaces;
-		std::vector<HalfEdgeH> compBoundaryEdges;
-		auto first = remaining.front();
-		std::deque<FaceH> q;
-		q.push_back(first);
-
-		while (!q.empty()) {
-			auto f = q.front();
-			q.pop_front();
-			compFaces.push_back(f);
-
-			// Go through boundaries of this face
-			std::vector<DilatedPatternArrangement::Ccb_halfedge_circulator> ccbs;
-			std::copy(f->outer_ccbs_begin(), f->outer_ccbs_end(), std::back_inserter(ccbs));
-			std::copy(f->inner_ccbs_begin(), f->inner_ccbs_end(), std::back_inserter(ccbs));
-			for (auto ccb_start : ccbs) {
-				auto ccb_it = ccb_start;
-
-				// Go through each neighbouring face
-				do {
-					auto candidate = ccb_it->twin()->face();
-					if (!in_component(candidate)) {
-						compBoundaryEdges.emplace_back(ccb_it.ptr());
-					} else {
-						// If this is one of the provided faces, and not yet added to queue or compFaces, add it to queue.
-						if (std::find(compFaces.begin(), compFaces.end(), candidate) ==
-						        compFaces.end() &&
-						    std::find(q.begin(), q.end(), candidate) == q.end()) {
-							q.push_back(candidate);
-						}
-					}
-				} while (++ccb_it != ccb_start);
-			}
+  private:
+	std::vector<int> m_parent;
+	std::vector<int> m_size;
+};
+}
+
+std::vector<Component>
+connectedComponents(const std::vector<FaceH>& faces, const std::function<bool(FaceH)>& in_component) {
+	std::unordered_map<const Face*, int> index;
+	for (int k = 0; k < faces.size(); ++k) {
+		index.emplace(&*faces[k], k);
+	}
+
+	// Merge each face with its neighbours in the component; the remaining half-edges bound the component.
+	UnionFind uf(faces.size());
+	std::vector<std::vector<HalfEdgeH>> boundaryEdges(faces.size());
+	for (int k = 0; k < faces.size(); ++k) {
+		auto f = faces[k];
+		std::vector<DilatedPatternArrangement::Ccb_halfedge_circulator> ccbs;
+		std::copy(f->outer_ccbs_begin(), f->outer_ccbs_end(), std::back_inserter(ccbs));
+		std::copy(f->inner_ccbs_begin(), f->inner_ccbs_end(), std::back_inserter(ccbs));
+		for (auto ccb_start : ccbs) {
+			auto ccb_it = ccb_start;
+			do {
+				auto neighbor = index.find(&*ccb_it->twin()->face());
+				if (neighbor == index.end()) {
+					boundaryEdges[k].emplace_back(ccb_it.ptr());
+				} else {
+					uf.merge(k, neighbor->second);
+				}
+			} while (++ccb_it != ccb_start);
 		}
+	}
+
+	// Collect the components, in order of their first face.
+	std::unordered_map<int, int> rootToComponent;
+	std::vector<std::vector<FaceH>> compFaces;
+	std::vector<std::vector<HalfEdgeH>> compBoundaryEdges;
+	for (int k = 0; k < faces.size(); ++k) {
+		auto [it, inserted] = rootToComponent.emplace(uf.find(k), compFaces.size());
+		if (inserted) {
+			compFaces.emplace_back();
+			compBoundaryEdges.emplace_back();
+		}
+		compFaces[it->second].push_back(faces[k]);
+		auto& edges = compBoundaryEdges[it->second];
+		edges.insert(edges.end(), boundaryEdges[k].begin(), boundaryEdges[k].end());
+	}
 
-		// Done with this connected component
-		remaining.erase(std::remove_if(remaining.begin(), remaining.end(), [&compFaces](const auto& f) {
-		  return std::find(compFaces.begin(), compFaces.end(), f) != compFaces.end();
-		}), remaining.end());
-		components.emplace_back(std::move(compFaces), std::move(compBoundaryEdges), in_component);
+	std::vector<Component> components;
+	for (int c = 0; c < compFaces.size(); ++c) {
+		components.emplace_back(std::move(compFaces[c]), std::move(compBoundaryEdges[c]), in_component);
 	}
 
 	return components;
 }
 
+std::vector<Component>
+connectedComponents(const DilatedPatternArrangement& arr, const std::function<bool(FaceH)>& in_component) {
+	std::vector<FaceH> faces;
+	for (auto fit = arr.faces_begin(); fit != arr.faces_end(); ++fit) {
+		auto fh = fit.ptr();
+		if (in_component(fh)) {
+			faces.emplace_back(fh);
+		}
+	}
+
+	return connectedComponents(faces, in_component);
+}
+
 Component::Component(std::vector<FaceH> faces, std::vector<HalfEdgeH> boundary_edges, std::function<bool(FaceH)> in_component) :
       m_faces(std::move(faces)), m_in_component(std::move(in_component)) {
-	while (!boundary_edges.empty()) {
-		auto he = boundary_edges.front();
+	// Each boundary edge lies on exactly one boundary cycle; trace a cycle from every edge that is not on a cycle
+	// traced before. Visited edges are looked up by address, so this takes linear time in the number of edges.
+	std::unordered_set<const DilatedPatternArrangement::Halfedge*> visited;
+	visited.reserve(boundary_edges.size());
+	for (const auto& he : boundary_edges) {
+		if (visited.contains(&*he)) continue;
 		auto circ_start = ComponentCcbCirculator(he, m_in_component);
 		auto circ = circ_start;
 
 		std::vector<X_monotone_curve_2> xm_curves;
-		auto last_it = boundary_edges.end();
 		do {
-			last_it = std::remove(boundary_edges.begin(), last_it, circ.handle());
+			visited.insert(&*circ.handle());
 			xm_curves.push_back(circ->curve());
 		} while (++circ != circ_start);
-		boundary_edges.erase(last_it, boundary_edges.end());
 
 		CSPolygon polygon(xm_curves.begin(), xm_curves.end());
 		auto orientation = polygon.orientation();
@@ -235,12 +279,36 @@ bool operator==(const Hyperedge& lhs, const Hyperedge& rhs) {
 	return lhs.relations == rhs.relations && lhs.origins == rhs.origins;
 }
 
+namespace {
+/// Hashes the pair of patterns of a relation.
+struct RelationPairHash {
+	std::size_t operator()(const std::pair<int, int>& pair) const {
+		return std::hash<long long>()((static_cast<long long>(pair.first) << 32) ^ static_cast<unsigned int>(pair.second));
+	}
+};
+}
+
 DilatedPatternDrawing::DilatedPatternDrawing(const Partition& partition, const GeneralSettings& gs, const ComputeDrawingSettings& cds)
 	: m_gs(gs), m_cds(cds) {
 	for (const auto& p : partition) {
 		m_dilated.emplace_back(*p, gs.dilationRadius());
 	}
+	m_timer.stamp("Dilate");
+	compute();
+}
+
+DilatedPatternDrawing::DilatedPatternDrawing(const Partition& partition, const GeneralSettings& gs,
+                                             const ComputeDrawingSettings& cds, DilationCache& dilationCache)
+    : m_gs(gs), m_cds(cds) {
+	for (const auto& p : partition) {
+		m_dilated.push_back(dilationCache.get(*p, gs.dilationRadius()));
+	}
+	m_timer.stamp("Dilate");
+	compute();
+}
 
+void DilatedPatternDrawing::compute() {
+	ScratchArena arena;
 	std::vector<CSTraits::Curve_2> curves;
 	std::vector<std::pair<CSTraits::Curve_2, int>> curves_data;
 	for (int i = 0; i < m_dilated.size(); i++) {
@@ -253,33 +321,68 @@ DilatedPatternDrawing::DilatedPatternDrawing(const Partition& partition, const G
 	}
 
 	CGAL::insert(m_arr, curves.begin(), curves.end());
-	// Set for each face which pattern it is a subset of.
-	for (auto fit = m_arr.faces_begin(); fit != m_arr.faces_end(); ++fit) {
-		if (fit->is_unbounded()) continue;
-		auto pt = get_point_in(*fit);
-		std::vector<int> origins;
-		for (int i = 0; i < m_dilated.size(); i++) {
-			if (on_or_inside(m_dilated[i].m_contour, pt)) {
-				origins.push_back(i);
-				m_iToFaces[i].push_back(fit);
-			}
-		}
-		fit->set_data(FaceData{origins});
-	}
 
 	// Store in each half-edges form which pattern it originates.
-	for (auto cit = m_arr.curves_begin(); cit != m_arr.curves_end(); ++cit) {
+	// The arrangement stores its curves in insertion order, so the pattern of a curve can be read off directly.
+	auto sameCurve = [](const CSTraits::Curve_2& curve, const CSTraits::Curve_2& other) {
+		return curve.source() == other.source() && curve.target() == other.target() &&
+		       (curve.is_linear() && other.is_linear() ||
+		        curve.is_circular() && other.is_circular() && curve.supporting_circle() == other.supporting_circle());
+	};
+	int curveIndex = 0;
+	for (auto cit = m_arr.curves_begin(); cit != m_arr.curves_end(); ++cit, ++curveIndex) {
 		CSTraits::Curve_2 curve = *cit;
-		auto curve_data = std::find_if(curves_data.begin(), curves_data.end(), [&curve](const auto& pair) {
-			auto other = pair.first;
-			return curve.source() == other.source() && curve.target() == other.target() &&
-					(curve.is_linear() && other.is_linear() ||
-			         curve.is_circular() && other.is_circular() && curve.supporting_circle() == other.supporting_circle());
-		});
+		int origin;
+		if (curveIndex < curves_data.size() && sameCurve(curve, curves_data[curveIndex].first)) {
+			origin = curves_data[curveIndex].second;
+		} else {
+			auto curve_data = std::find_if(curves_data.begin(), curves_data.end(), [&curve, &sameCurve](const auto& pair) {
+				return sameCurve(curve, pair.first);
+			});
+			origin = curve_data->second;
+		}
 		for (auto eit = m_arr.induced_edges_begin(cit); eit != m_arr.induced_edges_end(cit); ++eit) {
 			DilatedPatternArrangement::Halfedge_handle eh = *eit;
-			eh->data().origins.push_back(curve_data->second);
-			eh->twin()->data().origins.push_back(curve_data->second);
+			eh->data().origins.push_back(origin);
+			eh->twin()->data().origins.push_back(origin);
+		}
+	}
+
+	// Set for each face which patterns it is a subset of.
+	// The contours of the dilated patterns are closed curves, so crossing a half-edge toggles membership of the
+	// patterns the half-edge originates from. Propagate origins from the unbounded face (which has none) in a BFS.
+	std::set<FaceH> labeled;
+	std::deque<FaceH> queue;
+	FaceH unbounded = m_arr.unbounded_face();
+	unbounded->set_data(FaceData{});
+	labeled.insert(unbounded);
+	queue.push_back(unbounded);
+	while (!queue.empty()) {
+		auto fh = queue.front();
+		queue.pop_front();
+		const auto origins = fh->data().origins;
+
+		std::vector<DilatedPatternArrangement::Ccb_halfedge_circulator> ccbs;
+		std::copy(fh->outer_ccbs_begin(), fh->outer_ccbs_end(), std::back_inserter(ccbs));
+		std::copy(fh->inner_ccbs_begin(), fh->inner_ccbs_end(), std::back_inserter(ccbs));
+		for (auto ccb_start : ccbs) {
+			auto ccb_it = ccb_start;
+			do {
+				auto neighbor = ccb_it->twin()->face();
+				if (!labeled.contains(neighbor)) {
+					auto crossed = ccb_it->data().origins;
+					std::sort(crossed.begin(), crossed.end());
+					std::vector<int> neighborOrigins;
+					std::set_symmetric_difference(origins.begin(), origins.end(), crossed.begin(), crossed.end(),
+					                              std::back_inserter(neighborOrigins));
+					for (int i : neighborOrigins) {
+						m_iToFaces[i].push_back(neighbor);
+					}
+					neighbor->set_data(FaceData{neighborOrigins});
+					labeled.insert(neighbor);
+					queue.push_back(neighbor);
+				}
+			} while (++ccb_it != ccb_start);
 		}
 	}
 
@@ -288,15 +391,14 @@ DilatedPatternDrawing::DilatedPatternDrawing(const Partition& partition, const G
 		auto& facesI = m_iToFaces[i];
 		std::sort(facesI.begin(), facesI.end());
 	}
+	m_timer.stamp("Arrange");
 
-	for (int i = 0; i < m_dilated.size(); i++) {
-		for (int j = i + 1; j < m_dilated.size(); j++) {
-			auto cs = intersectionComponents(i, j);
-			for (auto& c : cs) {
-				auto rel = computePreference(i, j, c);
-				for (auto fit = c.faces_begin(); fit != c.faces_end(); ++fit) {
-					fit->data().relations.push_back(rel);
-				}
+	for (const auto& [pair, cs] : intersectionComponents()) {
+		auto [i, j] = pair;
+		for (auto& c : cs) {
+			auto rel = computePreference(i, j, c);
+			for (auto fit = c.faces_begin(); fit != c.faces_end(); ++fit) {
+				fit->data().relations.push_back(rel);
 			}
 		}
 	}
@@ -315,19 +417,65 @@ DilatedPatternDrawing::DilatedPatternDrawing(const Partition& partition, const G
 		setRelationOrder(*edge, *order);
 	}
 
+	// Compute the stacking order of the patterns in each face.
+	// If the relations of all faces together are acyclic, then restricting a single topological order to the origins
+	// of a face yields an order for that face. Otherwise, compute an order for each distinct combination of origins
+	// and relations, so that faces with the same origins and relations share one computation.
+	std::vector<int> allOrigins(m_dilated.size());
+	std::iota(allOrigins.begin(), allOrigins.end(), 0);
+	std::vector<std::shared_ptr<Relation>> allRelations;
+	std::unordered_set<const Relation*> seenRelations;
+	for (auto fit = m_arr.faces_begin(); fit != m_arr.faces_end(); ++fit) {
+		for (const auto& r : fit->data().relations) {
+			if (seenRelations.insert(r.get()).second) {
+				allRelations.push_back(r);
+			}
+		}
+	}
+	auto globalOrdering = computeTotalOrder(allOrigins, allRelations);
+	std::vector<int> position(m_dilated.size());
+	if (globalOrdering.has_value()) {
+		for (int k = 0; k < globalOrdering->size(); ++k) {
+			position[(*globalOrdering)[k]] = k;
+		}
+	}
+
+	using OrderKey = std::pair<std::vector<int>, std::vector<std::tuple<int, int, Order>>>;
+	std::map<OrderKey, std::optional<std::vector<int>>> orderings;
 	for (auto fit = m_arr.faces_begin(); fit != m_arr.faces_end(); ++fit) {
 		auto& data = fit->data();
 		if (data.origins.empty()) continue;
-		auto ordering = computeTotalOrder(data.origins, data.relations);
-		if (!ordering.has_value()) {
+		if (globalOrdering.has_value()) {
+			data.ordering = data.origins;
+			std::sort(data.ordering.begin(), data.ordering.end(), [&position](int i, int j) {
+				return position[i] < position[j];
+			});
+			continue;
+		}
+		OrderKey key{data.origins, {}};
+		for (const auto& r : data.relations) {
+			key.second.emplace_back(r->left, r->right, r->ordering);
+		}
+		std::sort(key.second.begin(), key.second.end());
+		auto it = orderings.find(key);
+		if (it == orderings.end()) {
+			it = orderings.emplace(std::move(key), computeTotalOrder(data.origins, data.relations)).first;
+		}
+		if (!it->second.has_value()) {
 			throw std::runtime_error("Impossible: no total order in a face");
 		}
-		data.ordering = *ordering;
+		data.ordering = *it->second;
 	}
 
+	m_timer.stamp("Stacking order");
+
+	// Morph each component of the intersection of a pattern with the patterns below it in the stacking order.
+	// The morph reads the lazy exact (Epeck) numbers of the arrangement, which CGAL does not allow to be evaluated
+	// concurrently, so this is done on a single thread.
 	for (int i = 0; i < m_dilated.size(); ++i) {
 		auto cs = intersectionComponents(i);
 		for (auto& c : cs) {
+			ScratchArena arena;
 			std::unordered_set<int> avoidees;
 			for (auto fit = c.faces_begin(); fit != c.faces_end(); ++fit) {
 				for (int j : fit->data().ordering) {
@@ -349,14 +497,19 @@ DilatedPatternDrawing::DilatedPatternDrawing(const Partition& partition, const G
 			auto componentPolygon = ccb_to_polygon<CSTraits>(c.outer_ccb());
 			auto morphedComponentPolygon = morph(bpis, componentPolygon, inclDisks, exclDisks, m_gs, m_cds);
 
+			// The associated boundaries only depend on the component, so compute them once for all its faces.
+			std::vector<CSPolyline> mbs;
+			for (const auto& bp : bpis) {
+				mbs.push_back(associatedBoundary(componentPolygon, morphedComponentPolygon, bp));
+			}
+
 			// Compute the morphed version of the CSPolygon for this component.
 			// Set, for each face in component c, the morphed face to the intersection of this CSPolygon with the face.
 			// Set the morphed edges to the intersection of the boundary of the polygon with the face.
 			for (auto fit = c.faces_begin(); fit != c.faces_end(); ++fit) {
 				auto facePolygon = face_to_polygon(*fit);
 
-				for (const auto& bp : bpis) {
-					CSPolyline mb = associatedBoundary(componentPolygon, morphedComponentPolygon, bp);
+				for (const auto& mb : mbs) {
 					intersection(mb, facePolygon, std::back_inserter(fit->data().morphedEdges[i]), false, true);
 				}
 
@@ -371,6 +524,7 @@ DilatedPatternDrawing::DilatedPatternDrawing(const Partition& partition, const G
 			}
 		}
 	}
+	m_timer.stamp("Morph");
 }
 
 bool overlap(const Circle<Inexact>& c1, const Circle<Inexact>& c2) {
@@ -436,7 +590,7 @@ CSPolygon thinRectangle(const Point<Exact>& p, const OneRootPoint& n, const Numb
 		Curve_2(p4, p1)
 	});
 
-	std::vector<X_monotone_curve_2> xm_curves;
+	auto xm_curves = scratchVector<X_monotone_curve_2>();
 	curvesToXMonotoneCurves(curves.begin(), curves.end(), std::back_inserter(xm_curves));
 
 	return {xm_curves.begin(), xm_curves.end()};
@@ -446,13 +600,14 @@ CSPolygon morph(const std::vector<CSPolyline>& boundaryParts, const CSPolygon& c
 				 const std::vector<Circle<Exact>>& exclDisks, const GeneralSettings& gs, const ComputeDrawingSettings& cds) {
 	if (exclDisks.empty()) return componentShape;
 
-	std::vector<Circle<Exact>> lineCovering;
-	std::vector<Circle<Exact>> arcCovering;
+	auto lineCovering = scratchVector<Circle<Exact>>();
+	auto arcCovering = scratchVector<Circle<Exact>>();
 
 	for (const auto& d : exclDisks) {
-		std::vector<CSPolyline> inter;
+		CSPolygonWithHoles disk(circleToCSPolygon(d));
+		auto inter = scratchVector<CSPolyline>();
 		for (const auto& boundaryPart : boundaryParts) {
-			intersection(boundaryPart, circleToCSPolygon(d), std::back_inserter(inter), false, true);
+			intersection(boundaryPart, disk, std::back_inserter(inter), false, true);
 		}
 		bool coversLine = true;
 		for (const auto& p : inter) {
@@ -492,8 +647,8 @@ CSPolygon morph(const std::vector<CSPolyline>& boundaryParts, const CSPolygon& c
 		return *closest;
 	};
 
-	std::vector<CSPolygon> cuts;
-	std::vector<Circle<Exact>> rectangleCutDisks;
+	auto cuts = scratchVector<CSPolygon>();
+	auto rectangleCutDisks = scratchVector<Circle<Exact>>();
 	for (const auto& comp : diskComponents) {
 		std::vector<Circle<Exact>> disks;
 		for (const auto& [i, _] : comp) {
@@ -563,7 +718,7 @@ CSPolygon morph(const std::vector<CSPolyline>& boundaryParts, const CSPolygon& c
 	for (const auto& d: inclDisks) {
 		polygonSet.difference(circleToCSPolygon(d));
 	}
-	std::vector<CSPolygonWithHoles> modifiedCuts;
+	auto modifiedCuts = scratchVector<CSPolygonWithHoles>();
 	polygonSet.polygons_with_holes(std::back_inserter(modifiedCuts));
 
 	CSPolygonSet polygonSet2(componentShape);
@@ -571,7 +726,7 @@ CSPolygon morph(const std::vector<CSPolyline>& boundaryParts, const CSPolygon& c
 		polygonSet2.difference(modifiedCut);
 	}
 
-	std::vector<CSPolygonWithHoles> polys;
+	auto polys = scratchVector<CSPolygonWithHoles>();
 	polygonSet2.polygons_with_holes(std::back_inserter(polys));
 ;
 	CSPolygonWithHoles poly;
@@ -590,7 +745,8 @@ CSPolygon morph(const std::vector<CSPolyline>& boundaryParts, const CSPolygon& c
 }
 
 CSPolyline associatedBoundary(const CSPolygon& component, const CSPolygon& morphedComponent, const CSPolyline& boundaryPart) {
-	std::vector<X_monotone_curve_2> morphed_xm_curves;
+	auto morphed_xm_curves = scratchVector<X_monotone_curve_2>();
+	morphed_xm_curves.reserve(morphedComponent.size());
 	for (auto cit = morphedComponent.curves_begin(); cit != morphedComponent.curves_end(); ++cit) {
 		morphed_xm_curves.push_back(*cit);
 	}
@@ -602,7 +758,6 @@ CSPolyline associatedBoundary(const CSPolygon& component, const CSPolygon& morph
 	int endIndex = -1;
 
 	for (int i = 0; i < morphed_xm_curves.size(); i++) {
-		auto c = morphed_xm_curves[i];
 		if (morphed_xm_curves[i].source() == boundaryPartStart) {
 			startIndex = i;
 		}
@@ -624,7 +779,7 @@ CSPolyline associatedBoundary(const CSPolygon& component, const CSPolygon& morph
 	assert(startIndex >= 0);
 	assert(endIndex >= 0);
 
-	std::vector<X_monotone_curve_2> xm_curves;
+	auto xm_curves = scratchVector<X_monotone_curve_2>();
 
 	if (endIndex >= startIndex) {
 		for (int i = startIndex; i <= endIndex; ++i) {
@@ -878,12 +1033,13 @@ void DilatedPatternDrawing::drawFaceStroke(FaceH fh, renderer::GeometryRenderer&
 
 std::optional<std::vector<int>> DilatedPatternDrawing::totalStackingOrder() const {
 	std::vector<std::shared_ptr<Relation>> relations;
+	std::unordered_set<std::pair<int, int>, RelationPairHash> seen;
 	std::vector<int> origins;
 	for (int i = 0; i < m_dilated.size(); ++i) {
 		origins.push_back(i);
 		for (const auto& f : m_iToFaces.at(i)) {
 			for (const auto& r : f->data().relations) {
-				if (std::find_if(relations.begin(), relations.end(), [&r](const auto& it) { return it->left == r->left && it->right == r->right; }) == relations.end()) {
+				if (seen.emplace(r->left, r->right).second) {
 					relations.push_back(r);
 				}
 				assert(r->ordering != Order::EQUAL);
@@ -902,6 +1058,33 @@ DilatedPatternDrawing::intersectionComponents(int i, int j) const {
 	});
 }
 
+std::map<std::pair<int, int>, std::vector<Component>>
+DilatedPatternDrawing::intersectionComponents() const {
+	// Group the faces by each pair of patterns they are a subset of.
+	std::map<std::pair<int, int>, std::vector<FaceH>> pairToFaces;
+	for (auto fit = m_arr.faces_begin(); fit != m_arr.faces_end(); ++fit) {
+		const auto& origins = fit->data().origins;
+		for (int a = 0; a < origins.size(); ++a) {
+			for (int b = a + 1; b < origins.size(); ++b) {
+				auto i = std::min(origins[a], origins[b]);
+				auto j = std::max(origins[a], origins[b]);
+				pairToFaces[{i, j}].emplace_back(fit.ptr());
+			}
+		}
+	}
+
+	std::map<std::pair<int, int>, std::vector<Component>> components;
+	for (const auto& [pair, faces] : pairToFaces) {
+		auto [i, j] = pair;
+		components[pair] = connectedComponents(faces, [i, j](FaceH fh) {
+			const auto& origins = fh->data().origins;
+			return std::find(origins.begin(), origins.end(), i) != origins.end() &&
+			       std::find(origins.begin(), origins.end(), j) != origins.end();
+		});
+	}
+	return components;
+}
+
 std::vector<Component>
 DilatedPatternDrawing::intersectionComponents(int i) const {
 	return connectedComponents(m_arr, [i](FaceH fh) {
@@ -923,50 +1106,58 @@ std::vector<std::shared_ptr<Hyperedge>> DilatedPatternDrawing::hyperedges() cons
 		return fh1->data().origins.size() < fh2->data().origins.size();
 	});
 
+	// Index the relations, so that the relations of a hyperedge can be stored as a bitset.
+	std::unordered_map<const Relation*, int> relationIndex;
+	for (const auto& fh : interesting) {
+		for (const auto& r : fh->data().relations) {
+			relationIndex.emplace(r.get(), static_cast<int>(relationIndex.size()));
+		}
+	}
+
 	std::vector<std::vector<std::shared_ptr<Hyperedge>>> hyperedgesGrouped;
+	std::vector<std::vector<boost::dynamic_bitset<>>> relationSetsGrouped;
 
 	std::vector<std::shared_ptr<Hyperedge>> currentGroup;
+	std::vector<boost::dynamic_bitset<>> currentRelationSets;
 	std::optional<int> lastSize;
 	for (const auto& fh : interesting) {
 		if (lastSize.has_value() && fh->data().origins.size() != *lastSize && !currentGroup.empty()) {
-			hyperedgesGrouped.push_back(currentGroup);
+			hyperedgesGrouped.push_back(std::move(currentGroup));
+			relationSetsGrouped.push_back(std::move(currentRelationSets));
 			currentGroup.clear();
+			currentRelationSets.clear();
 		}
 		auto he = std::make_shared<Hyperedge>(fh->data().origins, fh->data().relations);
+		boost::dynamic_bitset<> relationSet(relationIndex.size());
 		for (auto& r : he->relations) {
 			r->hyperedges.push_back(he);
+			relationSet.set(relationIndex.at(r.get()));
 		}
 		currentGroup.push_back(he);
+		currentRelationSets.push_back(std::move(relationSet));
 		lastSize = fh->data().origins.size();
 	}
 	if (!currentGroup.empty()) {
-		hyperedgesGrouped.push_back(currentGroup);
-	}
-
-	std::vector<std::pair<int, std::shared_ptr<Hyperedge>>> trashCan;
-	for (int i = 0; i < hyperedgesGrouped.size(); i++) {
-		if (i + 1 >= hyperedgesGrouped.size()) break;
-		const auto& group = hyperedgesGrouped[i];
-		for (const auto& hyperedge : group) {
-			for (const auto& larger : hyperedgesGrouped[i+1]) {
-				bool fullyContained = true;
-				for (const auto& r : hyperedge->relations) {
-					if (std::find(larger->relations.begin(), larger->relations.end(), r) == larger->relations.end()) {
-						fullyContained = false;
-					}
-				}
-				if (fullyContained) {
-					// store hyperedge for removal
-					trashCan.emplace_back(i, hyperedge);
-					break;
-				}
-			}
-		}
+		hyperedgesGrouped.push_back(std::move(currentGroup));
+		relationSetsGrouped.push_back(std::move(currentRelationSets));
 	}
 
-	for (const auto& [i, r] : trashCan) {
+	// Remove hyperedges whose relations are all contained in a hyperedge of the next group.
+	for (int i = 0; i + 1 < hyperedgesGrouped.size(); i++) {
 		auto& group = hyperedgesGrouped[i];
-		group.erase(std::remove(group.begin(), group.end(), r), group.end());
+		const auto& relationSets = relationSetsGrouped[i];
+		const auto& largerRelationSets = relationSetsGrouped[i + 1];
+		std::vector<std::shared_ptr<Hyperedge>> kept;
+		for (int k = 0; k < group.size(); k++) {
+			bool fullyContained = std::any_of(largerRelationSets.begin(), largerRelationSets.end(),
+			                                  [&relationSets, k](const auto& larger) {
+				                                  return relationSets[k].is_subset_of(larger);
+			                                  });
+			if (!fullyContained) {
+				kept.push_back(group[k]);
+			}
+		}
+		group = std::move(kept);
 	}
 
 	std::vector<std::shared_ptr<Hyperedge>> hyperedges;
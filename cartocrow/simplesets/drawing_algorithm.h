@@ -4,6 +4,7 @@
 #include "partition.h"
 #include "dilated/dilated_poly.h"
 #include "../renderer/geometry_painting.h"
+#include "../core/timer.h"
 #include <CGAL/Arrangement_with_history_2.h>
 
 #include <utility>
@@ -342,9 +343,16 @@ bool isStraight(const CSPolyline& polyline);
 class DilatedPatternDrawing {
   public:
 	DilatedPatternDrawing(const Partition& partition, const GeneralSettings& gs, const ComputeDrawingSettings& cds);
+	// Takes the dilations of the patterns from the cache, so that drawings of a partition history at different
+	// scales can reuse the dilations of patterns they share.
+	DilatedPatternDrawing(const Partition& partition, const GeneralSettings& gs, const ComputeDrawingSettings& cds,
+	                      DilationCache& dilationCache);
 
 	std::vector<Component> intersectionComponents(int i) const;
 	std::vector<Component> intersectionComponents(int i, int j) const;
+	// Returns the connected components of the intersection of each pair of patterns (i, j) with i < j.
+	// Pairs of patterns that do not intersect are omitted.
+	std::map<std::pair<int, int>, std::vector<Component>> intersectionComponents() const;
 	std::shared_ptr<Relation> computePreference(int i, int j, const Component& c);
 
 	IncludeExcludeDisks includeExcludeDisks(int i, int j, const Component& c) const;
@@ -364,8 +372,12 @@ class DilatedPatternDrawing {
 	std::vector<Dilated> m_dilated;
 	const GeneralSettings& m_gs;
 	const ComputeDrawingSettings& m_cds;
+	// Time spent in each stage of the construction: dilation, arrangement, stacking order and morphing.
+	Timer m_timer;
 
   private:
+	// Arranges the dilated patterns and computes the stacking orders and morphed faces.
+	void compute();
 };
 
 class SimpleSetsPainting : public renderer::GeometryPainting {
@@ -1,6 +1,7 @@
 #include "approximate_convex_hull.h"
 #include "cs_curve_helpers.h"
 #include "cs_polygon_helpers.h"
+#include "monotone_chain.h"
 
 namespace cartocrow::simplesets {
 Segment<Inexact> tangent(const Circle<Inexact>& c1, const Circle<Inexact>& c2) {
@@ -244,6 +245,81 @@ std::vector<RationalRadiusCircle> circlesOnConvexHull(const std::vector<Rational
 	return hullCircles;
 }
 
+/// Point on the unit circle with rational coordinates, in the direction of angle \p phi up to floating-point error.
+Vector<Exact> rationalUnitVector(Number<Inexact> phi) {
+	// Rational parametrization of the unit circle by the tangent of the half angle.
+	// Near angle pi the half-angle tangent blows up, so there the opposite direction is parametrized instead.
+	bool flip = std::cos(phi) < 0;
+	Number<Exact> t = std::tan((flip ? phi - M_PI : phi) / 2);
+	Number<Exact> denominator = 1 + t * t;
+	Vector<Exact> v((1 - t * t) / denominator, 2 * t / denominator);
+	return flip ? -v : v;
+}
+
+/// Approximate convex hull of \p circles, which all have the same radius.
+/// This is the convex hull of the centers offset by the radius: each hull edge is translated outwards
+/// to a segment whose endpoints lie on the two circles, and consecutive segments are connected by arcs.
+CSPolygon equalRadiusConvexHull(const std::vector<Circle<Exact>>& circles) {
+	Number<Exact> radius = approximateRadiusCircle(circles.front()).radius;
+	std::vector<Point<Exact>> centers;
+	std::vector<Point<Inexact>> approximateCenters;
+	for (const auto& c : circles) {
+		centers.push_back(c.center());
+		approximateCenters.push_back(approximate(c.center()));
+	}
+	auto hull = monotoneChainHull(approximateCenters,
+	    [&centers](int i, int j) { return CGAL::compare_xy(centers[i], centers[j]); },
+	    [&centers](int i, int j, int k) { return CGAL::orientation(centers[i], centers[j], centers[k]); });
+
+	if (hull.size() == 1) {
+		return circleToCSPolygon(circles[hull[0]]);
+	}
+
+	// Drop hull vertices at which the hull barely turns, so that the rounded edge normals stay in
+	// counter-clockwise order. The circle at such a vertex is still covered up to a negligible error.
+	auto direction = [&approximateCenters](int i, int j) {
+		auto v = approximateCenters[j] - approximateCenters[i];
+		return std::atan2(v.y(), v.x());
+	};
+	bool changed = true;
+	while (changed && hull.size() > 2) {
+		changed = false;
+		for (int i = 0; i < hull.size(); ++i) {
+			int prev = hull[(i + hull.size() - 1) % hull.size()];
+			int next = hull[(i + 1) % hull.size()];
+			auto turn = direction(hull[i], next) - direction(prev, hull[i]);
+			turn = std::remainder(turn, 2 * M_PI);
+			if (std::abs(turn) < 1e-9) {
+				hull.erase(hull.begin() + i);
+				changed = true;
+				break;
+			}
+		}
+	}
+
+	// Outward normal of each hull edge; edge i goes from hull[i] to hull[i + 1].
+	std::vector<Vector<Exact>> offsets;
+	for (int i = 0; i < hull.size(); ++i) {
+		auto phi = direction(hull[i], hull[(i + 1) % hull.size()]) - M_PI / 2;
+		offsets.push_back(rationalUnitVector(phi) * radius);
+	}
+
+	std::vector<X_monotone_curve_2> xm_curves;
+	for (int i = 0; i < hull.size(); ++i) {
+		int j = (i + 1) % hull.size();
+		const auto& c2 = centers[hull[j]];
+		Point<Exact> t1End = c2 + offsets[i];
+		Point<Exact> t2Start = c2 + offsets[j];
+		Curve_2 edge(Segment<Exact>(centers[hull[i]] + offsets[i], t1End));
+		curveToXMonotoneCurves(edge, std::back_inserter(xm_curves));
+		Curve_2 arc(Circle<Exact>(c2, radius * radius), OneRootPoint(t1End.x(), t1End.y()),
+		            OneRootPoint(t2Start.x(), t2Start.y()));
+		curveToXMonotoneCurves(arc, std::back_inserter(xm_curves));
+	}
+
+	return {xm_curves.begin(), xm_curves.end()};
+}
+
 /// Precondition: the circle centers are distinct.
 CSPolygon approximateConvexHull(const std::vector<Circle<Exact>>& circles) {
 	// todo: approximating circle radii may cause problems when two circles overlap in a single point and one is contained in the other.
@@ -251,6 +327,12 @@ CSPolygon approximateConvexHull(const std::vector<Circle<Exact>>& circles) {
 	if (circles.size() == 1) {
 		return circleToCSPolygon(circles.front());
 	}
+	bool equalRadii = std::all_of(circles.begin(), circles.end(), [&circles](const Circle<Exact>& c) {
+		return c.squared_radius() == circles.front().squared_radius();
+	});
+	if (equalRadii) {
+		return equalRadiusConvexHull(circles);
+	}
 	std::vector<RationalRadiusCircle> rrCircles;
 	for (const auto& c : circles) {
 		rrCircles.push_back(approximateRadiusCircle(c));
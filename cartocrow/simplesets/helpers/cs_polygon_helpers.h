@@ -7,7 +7,7 @@
 namespace cartocrow::simplesets {
 //For two circles of radii R and r and centered at (0,0) and (d,0) intersecting
 //in a region shaped like an asymmetric lens.
-constexpr double lens_area(const double r, const double R, const double d);
+double lens_area(const double r, const double R, const double d);
 
 // ------ return signed area under the linear segment (P1, P2)
 Number<Inexact> area(const CSTraits::Point_2& P1, const CSTraits::Point_2& P2);
@@ -0,0 +1,76 @@
+#ifndef CARTOCROW_MONOTONE_CHAIN_H
+#define CARTOCROW_MONOTONE_CHAIN_H
+
+#include "../types.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace cartocrow::simplesets {
+/// Returns the indices of the vertices of the convex hull of \p points in counter-clockwise order,
+/// computed with Andrew's monotone chain algorithm. Points that coincide with an earlier point or lie
+/// in the interior of a hull edge are left out.
+///
+/// The points are floating-point approximations. Ties in the sort are broken by
+/// \c exactCompareXY(i, j), and orientation tests whose floating-point result is too close to zero to
+/// be trusted are delegated to \c exactOrientation(i, j, k). For points that are not approximations,
+/// both may simply evaluate the CGAL predicates on \p points.
+template <class ExactCompareXY, class ExactOrientation>
+std::vector<int> monotoneChainHull(const std::vector<Point<Inexact>>& points,
+                                   const ExactCompareXY& exactCompareXY,
+                                   const ExactOrientation& exactOrientation) {
+	std::vector<int> order(points.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::sort(order.begin(), order.end(), [&](int i, int j) {
+		const auto& p = points[i];
+		const auto& q = points[j];
+		if (p.x() != q.x()) return p.x() < q.x();
+		if (p.y() != q.y()) return p.y() < q.y();
+		return exactCompareXY(i, j) == CGAL::SMALLER;
+	});
+	order.erase(std::unique(order.begin(), order.end(), [&](int i, int j) {
+		return points[i] == points[j] && exactCompareXY(i, j) == CGAL::EQUAL;
+	}), order.end());
+
+	if (order.size() <= 2) {
+		return order;
+	}
+
+	auto leftTurn = [&](int i, int j, int k) {
+		const auto& p = points[i];
+		const auto& q = points[j];
+		const auto& r = points[k];
+		double lhs = (q.x() - p.x()) * (r.y() - p.y());
+		double rhs = (q.y() - p.y()) * (r.x() - p.x());
+		double det = lhs - rhs;
+		// The points themselves may be rounded, so the bound is far looser than the rounding error of
+		// the determinant alone.
+		double bound = 1e-10 * (std::abs(lhs) + std::abs(rhs));
+		if (det > bound) return true;
+		if (det < -bound) return false;
+		return exactOrientation(i, j, k) == CGAL::LEFT_TURN;
+	};
+
+	std::vector<int> hull(2 * order.size());
+	int k = 0;
+	// Lower hull
+	for (int i : order) {
+		while (k >= 2 && !leftTurn(hull[k - 2], hull[k - 1], i)) {
+			--k;
+		}
+		hull[k++] = i;
+	}
+	// Upper hull
+	for (int i = static_cast<int>(order.size()) - 2, lowerSize = k + 1; i >= 0; --i) {
+		while (k >= lowerSize && !leftTurn(hull[k - 2], hull[k - 1], order[i])) {
+			--k;
+		}
+		hull[k++] = order[i];
+	}
+	// The first point is repeated at the end.
+	hull.resize(k - 1);
+	return hull;
+}
+}
+
+#endif //CARTOCROW_MONOTONE_CHAIN_H
@@ -0,0 +1,42 @@
+#include "scratch_arena.h"
+
+#include <atomic>
+
+namespace cartocrow::simplesets {
+namespace {
+thread_local std::pmr::memory_resource* currentResource = nullptr;
+std::atomic<bool> arenasEnabled = true;
+
+std::pmr::pool_options poolOptions() {
+	std::pmr::pool_options options;
+	options.largest_required_pool_block = 1 << 16;
+	return options;
+}
+}
+
+ScratchArena::ScratchArena()
+    : m_buffer(1 << 16), m_pool(poolOptions(), &m_buffer), m_previous(currentResource),
+      m_installed(arenasEnabled) {
+	if (m_installed) {
+		currentResource = &m_pool;
+	}
+}
+
+ScratchArena::~ScratchArena() {
+	if (m_installed) {
+		currentResource = m_previous;
+	}
+}
+
+void ScratchArena::setEnabled(bool enabled) {
+	arenasEnabled = enabled;
+}
+
+bool ScratchArena::enabled() {
+	return arenasEnabled;
+}
+
+std::pmr::memory_resource* scratchResource() {
+	return currentResource != nullptr ? currentResource : std::pmr::get_default_resource();
+}
+}
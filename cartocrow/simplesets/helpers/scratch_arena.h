@@ -0,0 +1,43 @@
+#ifndef CARTOCROW_SCRATCH_ARENA_H
+#define CARTOCROW_SCRATCH_ARENA_H
+
+#include <memory_resource>
+#include <vector>
+
+namespace cartocrow::simplesets {
+/// Scoped arena for short-lived buffers.
+/// While a ScratchArena is alive, scratchResource() on the same thread returns its memory resource. Freed memory is
+/// pooled for reuse within the arena, and all memory is released at once when the arena is destroyed. Arenas can be
+/// nested; the innermost arena is used.
+/// Memory obtained from an arena must not outlive it, so only use scratchResource() for local temporaries.
+class ScratchArena {
+  public:
+	ScratchArena();
+	~ScratchArena();
+	ScratchArena(const ScratchArena&) = delete;
+	ScratchArena& operator=(const ScratchArena&) = delete;
+
+	/// Enables or disables arenas on all threads; when disabled, scratchResource() returns the default resource.
+	/// Only change this while no arena is alive.
+	static void setEnabled(bool enabled);
+	static bool enabled();
+
+  private:
+	std::pmr::monotonic_buffer_resource m_buffer;
+	std::pmr::unsynchronized_pool_resource m_pool;
+	std::pmr::memory_resource* m_previous;
+	bool m_installed;
+};
+
+/// The memory resource of the innermost arena on this thread, or the default resource if there is none.
+std::pmr::memory_resource* scratchResource();
+
+/// A vector whose storage comes from the current scratch arena.
+template <class T> using ScratchVector = std::pmr::vector<T>;
+
+template <class T> ScratchVector<T> scratchVector() {
+	return ScratchVector<T>(scratchResource());
+}
+}
+
+#endif //CARTOCROW_SCRATCH_ARENA_H
@@ -0,0 +1,95 @@
+#include "partition.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace cartocrow::simplesets {
+PartitionHistory::PartitionHistory(const Partition& initial, const std::vector<Merge>& merges) : m_merges(merges) {
+	auto add = [this](const std::shared_ptr<PolyPattern>& pattern, int step) {
+		m_index[pattern.get()] = m_patterns.size();
+		m_patterns.push_back(pattern);
+		m_created.push_back(step);
+		m_merged.push_back(size());
+	};
+	for (const auto& pattern : initial) {
+		add(pattern, 0);
+	}
+	for (int i = 0; i < m_merges.size(); ++i) {
+		const auto& merge = m_merges[i];
+		m_merged[m_index.at(merge.p1.get())] = i + 1;
+		m_merged[m_index.at(merge.p2.get())] = i + 1;
+		add(merge.result, i + 1);
+	}
+
+	m_suffixMinTime.resize(m_merges.size());
+	for (int i = static_cast<int>(m_merges.size()) - 1; i >= 0; --i) {
+		m_suffixMinTime[i] = i + 1 < m_merges.size() ? std::min(m_merges[i].time, m_suffixMinTime[i + 1])
+		                                             : m_merges[i].time;
+	}
+
+	m_checkpointInterval = std::max(1, static_cast<int>(std::sqrt(size())));
+	m_checkpoints.clear();
+	for (int step = 0; step < size(); step += m_checkpointInterval) {
+		std::vector<int> checkpoint;
+		for (int i = 0; i < m_patterns.size(); ++i) {
+			if (m_created[i] <= step && step < m_merged[i]) {
+				checkpoint.push_back(i);
+			}
+		}
+		m_checkpoints.push_back(std::move(checkpoint));
+	}
+}
+
+int PartitionHistory::size() const {
+	return m_merges.size() + 1;
+}
+
+Number<Inexact> PartitionHistory::time(int step) const {
+	return step == 0 ? 0 : m_merges[step - 1].time;
+}
+
+int PartitionHistory::stepAt(Number<Inexact> time) const {
+	// Merge times need not be non-decreasing: an event may be found after a merge with an earlier time than that
+	// merge, for instance when the regularity delay is negative. The last step with a smaller time is the last step
+	// from which on some time is smaller, so binary search the suffix minima instead of the times themselves.
+	return std::lower_bound(m_suffixMinTime.begin(), m_suffixMinTime.end(), time) - m_suffixMinTime.begin();
+}
+
+Partition PartitionHistory::at(int step) const {
+	// Start from the preceding checkpoint, and add the patterns created after it that still exist.
+	int checkpoint = step / m_checkpointInterval;
+	Partition partition;
+	for (int i : m_checkpoints[checkpoint]) {
+		if (step < m_merged[i]) {
+			partition.push_back(m_patterns[i]);
+		}
+	}
+	// The pattern created in step s is the result of merge s - 1, which comes after the initial patterns.
+	int initial = m_patterns.size() - m_merges.size();
+	for (int s = checkpoint * m_checkpointInterval + 1; s <= step; ++s) {
+		int i = initial + s - 1;
+		if (step < m_merged[i]) {
+			partition.push_back(m_patterns[i]);
+		}
+	}
+	return partition;
+}
+
+bool PartitionHistory::exists(const std::shared_ptr<PolyPattern>& pattern, int step) const {
+	auto it = m_index.find(pattern.get());
+	if (it == m_index.end()) return false;
+	return m_created[it->second] <= step && step < m_merged[it->second];
+}
+
+const std::vector<Merge>& PartitionHistory::merges() const {
+	return m_merges;
+}
+
+std::vector<std::pair<Number<Inexact>, Partition>> PartitionHistory::partitions() const {
+	std::vector<std::pair<Number<Inexact>, Partition>> result;
+	for (int step = 0; step < size(); ++step) {
+		result.emplace_back(time(step), at(step));
+	}
+	return result;
+}
+}
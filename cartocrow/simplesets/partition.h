@@ -2,9 +2,61 @@
 #define CARTOCROW_PARTITION_H
 
 #include "patterns/poly_pattern.h"
+#include <unordered_map>
 
 namespace cartocrow::simplesets {
 typedef std::vector<std::shared_ptr<PolyPattern>> Partition;
+
+/// A merge of two patterns into a new pattern.
+struct Merge {
+	Number<Inexact> time;
+	std::shared_ptr<PolyPattern> p1;
+	std::shared_ptr<PolyPattern> p2;
+	std::shared_ptr<PolyPattern> result;
+};
+
+/// The partitions over growing cover radius, stored as the initial partition and the merges that were performed.
+/// Each pattern that ever occurs is stored once, together with the steps at which it is created and merged away.
+/// Step s corresponds to the partition after the first s merges.
+/// To reconstruct partitions quickly, the patterns of every k-th partition are stored as a checkpoint, where k is
+/// about the square root of the number of steps.
+class PartitionHistory {
+  public:
+	PartitionHistory() = default;
+	PartitionHistory(const Partition& initial, const std::vector<Merge>& merges);
+
+	/// Number of partitions in the history, including the initial partition.
+	int size() const;
+	/// The cover radius at which the partition of this step is formed.
+	Number<Inexact> time(int step) const;
+	/// The last step whose time is smaller than \c time, or step 0 if there is no such step.
+	/// Merge times are not necessarily non-decreasing; this takes logarithmic time nonetheless.
+	int stepAt(Number<Inexact> time) const;
+	/// Returns the partition at the given step.
+	/// This takes time linear in the size of the partition plus the distance to the preceding checkpoint.
+	Partition at(int step) const;
+	/// Returns whether pattern \c pattern exists in the partition at the given step.
+	bool exists(const std::shared_ptr<PolyPattern>& pattern, int step) const;
+	const std::vector<Merge>& merges() const;
+	/// Returns the history as a list of full partitions.
+	std::vector<std::pair<Number<Inexact>, Partition>> partitions() const;
+
+  private:
+	std::vector<Merge> m_merges;
+	/// All patterns, in order of creation.
+	std::vector<std::shared_ptr<PolyPattern>> m_patterns;
+	/// Step at which each pattern is created.
+	std::vector<int> m_created;
+	/// Step at which each pattern is merged into another; size() if it is never merged.
+	std::vector<int> m_merged;
+	std::unordered_map<const PolyPattern*, int> m_index;
+	/// For each step s > 0, the smallest time of the steps from s onwards; this is non-decreasing.
+	std::vector<Number<Inexact>> m_suffixMinTime;
+	/// Number of steps between consecutive checkpoints.
+	int m_checkpointInterval = 1;
+	/// For every m_checkpointInterval-th step, the indices in m_patterns of its partition, in increasing order.
+	std::vector<std::vector<int>> m_checkpoints = {{}};
+};
 }
 
 #endif //CARTOCROW_PARTITION_H
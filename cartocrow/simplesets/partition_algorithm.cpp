@@ -1,12 +1,131 @@
 #include "partition_algorithm.h"
 #include "dilated/dilated_poly.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <map>
+#include <mutex>
 #include <queue>
+#include <thread>
+#include <utility>
 
 #include <CGAL/Boolean_set_operations_2.h>
+#include <CGAL/Fuzzy_sphere.h>
+#include <CGAL/Kd_tree.h>
+#include <CGAL/Search_traits_2.h>
 #include "helpers/cs_polygon_helpers.h"
+#include "helpers/scratch_arena.h"
+#include "../core/profiler.h"
 
 namespace cartocrow::simplesets {
+namespace {
+using KdTree = CGAL::Kd_tree<CGAL::Search_traits_2<Inexact>>;
+using FuzzySphere = CGAL::Fuzzy_sphere<CGAL::Search_traits_2<Inexact>>;
+
+/// A fixed set of threads that run loops of independent iterations.
+/// The threads are started once and wait for work in between loops, so that the many small loops of the partition
+/// algorithm (one per merge) do not each pay for starting threads. The calling thread takes part in every loop.
+class WorkerPool {
+  public:
+	explicit WorkerPool(int nThreads) {
+		for (int t = 1; t < nThreads; ++t) {
+			m_threads.emplace_back([this]() { work(); });
+		}
+	}
+
+	~WorkerPool() {
+		{
+			std::lock_guard lock(m_mutex);
+			m_stop = true;
+		}
+		m_wake.notify_all();
+		for (auto& thread : m_threads) {
+			thread.join();
+		}
+	}
+
+	WorkerPool(const WorkerPool&) = delete;
+	WorkerPool& operator=(const WorkerPool&) = delete;
+
+	/// Calls \c f(i) for each i in [0, n), distributed over the threads, and returns when all calls are done.
+	/// Small amounts of work are done on the calling thread. If a call throws, the first exception is rethrown.
+	template <class F> void parallelFor(int n, const F& f) {
+		if (m_threads.empty() || n < 64) {
+			for (int i = 0; i < n; ++i) {
+				f(i);
+			}
+			return;
+		}
+		std::function<void(int)> task = f;
+		{
+			std::lock_guard lock(m_mutex);
+			m_task = &task;
+			m_n = n;
+			m_next = 0;
+			m_busy = static_cast<int>(m_threads.size());
+			++m_generation;
+		}
+		m_wake.notify_all();
+		runTask();
+		std::unique_lock lock(m_mutex);
+		m_done.wait(lock, [this]() { return m_busy == 0; });
+		m_task = nullptr;
+		if (m_exception) {
+			std::rethrow_exception(std::exchange(m_exception, nullptr));
+		}
+	}
+
+  private:
+	void work() {
+		long long generation = 0;
+		while (true) {
+			{
+				std::unique_lock lock(m_mutex);
+				m_wake.wait(lock, [&]() { return m_stop || m_generation != generation; });
+				if (m_stop) return;
+				generation = m_generation;
+			}
+			runTask();
+			std::lock_guard lock(m_mutex);
+			if (--m_busy == 0) {
+				m_done.notify_one();
+			}
+		}
+	}
+
+	void runTask() {
+		for (int i = m_next++; i < m_n; i = m_next++) {
+			try {
+				(*m_task)(i);
+			} catch (...) {
+				std::lock_guard lock(m_mutex);
+				if (!m_exception) {
+					m_exception = std::current_exception();
+				}
+			}
+		}
+	}
+
+	std::vector<std::thread> m_threads;
+	std::mutex m_mutex;
+	std::condition_variable m_wake;
+	std::condition_variable m_done;
+	bool m_stop = false;
+	/// Incremented for every loop, so that waiting threads can tell a new loop from a spurious wake-up.
+	long long m_generation = 0;
+	/// The current loop; written under \ref m_mutex before the threads are woken.
+	const std::function<void(int)>* m_task = nullptr;
+	int m_n = 0;
+	std::atomic<int> m_next = 0;
+	/// The number of pool threads still working on the current loop.
+	int m_busy = 0;
+	std::exception_ptr m_exception;
+};
+}
+}
+
 
 std::variant<Bank, Island> to_bank_or_island(PolyPattern* polyPattern) {
 	if (auto bp = dynamic_cast<Bank*>(polyPattern)) {
@@ -66,33 +185,72 @@ bool do_intersect(
 	}, cont1);
 }
 
+/// Estimates the area of the intersection of the dilation of a point with the dilation of a pattern.
+/// The estimate is exact (up to the approximation of the dilation) when the dilated point is disjoint from or
+/// contained in the dilated pattern, or when the pattern is a single point; otherwise no estimate is returned.
+std::optional<Number<Inexact>> estimateIntersectionArea(const CatPoint& pt, const PolyPattern& pattern,
+                                                        const Number<Inexact>& dilationRadius) {
+	auto diskArea = M_PI * squared(dilationRadius);
+	if (pattern.catPoints().size() == 1) {
+		auto d = sqrt(CGAL::squared_distance(pattern.catPoints()[0].point, pt.point));
+		if (d >= 2 * dilationRadius) return 0;
+		if (d <= 0) return diskArea;
+		return lens_area(dilationRadius, dilationRadius, d);
+	}
+	auto poly = pattern.poly();
+	if (std::visit([&pt](const auto& p) { return is_inside(pt.point, p); }, poly)) {
+		return diskArea;
+	}
+	if (squared_distance(poly, pt.point) >= squared(2 * dilationRadius)) {
+		return 0;
+	}
+	return std::nullopt;
+}
+
 Number<Inexact> intersectionDelay(const std::vector<CatPoint>& points, const PolyPattern& p1, const PolyPattern& p2,
                                   const PolyPattern& result, const GeneralSettings& gs, const PartitionSettings& ps) {
+	DilationCache cache;
+	return intersectionDelay(points, p1, p2, result, gs, ps, cache);
+}
+
+Number<Inexact> intersectionDelay(const std::vector<CatPoint>& points, const PolyPattern& p1, const PolyPattern& p2,
+                                  const PolyPattern& result, const GeneralSettings& gs, const PartitionSettings& ps,
+                                  DilationCache& cache) {
 	// todo: check consistency with paper
 	if (!ps.intersectionDelay) return 0;
+	auto dilationRadius = gs.dilationRadius();
+	// The result is not in the cache: it is only needed for this event.
+	std::optional<CSPolygon> rShape;
+
+	// Area of the intersection of the dilation of a point with the dilation of a pattern.
+	// Only computes the exact intersection when the estimate is inconclusive.
+	auto dilatedIntersectionArea = [&](const CatPoint& pt, const PolyPattern& pattern, bool cached) {
+		auto estimate = estimateIntersectionArea(pt, pattern, dilationRadius);
+		if (estimate.has_value()) {
+			return *estimate;
+		}
+		if (!cached && !rShape.has_value()) {
+			rShape = Dilated(pattern, dilationRadius).m_contour;
+		}
+		const CSPolygon& shape = cached ? cache.get(pattern, dilationRadius).m_contour : *rShape;
+		const CSPolygon& ptShape = cache.get(pt, dilationRadius).m_contour;
+		auto inters = scratchVector<CSPolygonWithHoles>();
+		CGAL::intersection(shape, ptShape, std::back_inserter(inters));
+		Number<Inexact> total = 0;
+		for (const auto& gp : inters) {
+			total += abs(area(gp));
+		}
+		return total;
+	};
+
 	Number<Inexact> intersectionArea = 0;
 	auto& resultPts = result.catPoints();
 	auto resultPoly = result.poly();
 	for (const auto& pt : points) {
 		if (std::find(resultPts.begin(), resultPts.end(), pt) == resultPts.end() &&
-		    squared_distance(resultPoly, pt.point) < squared(2 * gs.dilationRadius())) {
-			CSPolygon ptShape = Dilated(SinglePoint(pt), gs.dilationRadius()).m_contour;
-			CSPolygon rShape = Dilated(result, gs.dilationRadius()).m_contour;
-			std::vector<CSPolygonWithHoles> inters;
-			CGAL::intersection(rShape, ptShape, std::back_inserter(inters));
-			Number<Inexact> newArea = 0;
-			for (const auto& gp : inters) {
-				newArea += abs(area(gp));
-			}
-			inters.clear();
-			CSPolygon p1Shape = Dilated(p1, gs.dilationRadius()).m_contour;
-			CSPolygon p2Shape = Dilated(p2, gs.dilationRadius()).m_contour;
-			CGAL::intersection(p1Shape, ptShape, std::back_inserter(inters));
-			CGAL::intersection(p2Shape, ptShape, std::back_inserter(inters));
-			Number<Inexact> oldArea = 0;
-			for (const auto& gp : inters) {
-				oldArea += abs(area(gp));
-			}
+		    squared_distance(resultPoly, pt.point) < squared(2 * dilationRadius)) {
+			Number<Inexact> newArea = dilatedIntersectionArea(pt, result, false);
+			Number<Inexact> oldArea = dilatedIntersectionArea(pt, p1, true) + dilatedIntersectionArea(pt, p2, true);
 			intersectionArea += newArea - oldArea;
 		}
 	}
@@ -105,23 +263,66 @@ Number<Inexact> intersectionDelay(const std::vector<CatPoint>& points, const Pol
 
 std::vector<std::pair<Number<Inexact>, Partition>>
 partition(const std::vector<CatPoint>& points, const GeneralSettings& gs, const PartitionSettings& ps, Number<Inexact> maxTime) {
+	return partitionHistory(points, gs, ps, maxTime).partitions();
+}
+
+PartitionHistory
+partitionHistory(const std::vector<CatPoint>& points, const GeneralSettings& gs, const PartitionSettings& ps, Number<Inexact> maxTime) {
+	ProfileZone zone("simplesets::partition");
+	ScratchArena arena;
 	// Create initial partition consisting of single points
 	std::vector<std::shared_ptr<PolyPattern>> initialPatterns;
 	std::transform(points.begin(), points.end(), std::back_inserter(initialPatterns), [](const auto& pt)
 	               { return std::make_shared<SinglePoint>(pt); });
 	Partition partition(initialPatterns);
 
-	std::vector<std::pair<Number<Inexact>, Partition>> history;
-	history.emplace_back(0, partition);
+	Partition initialPartition = partition;
+	std::vector<Merge> merges;
 
-	// Priority queue storing events based on their time
+	// Priority queue storing events based on their time.
+	// Events with equal times are popped in an order that depends only on the order in which they were pushed; the
+	// events computed in parallel are pushed in index order, so the result does not depend on the number of threads.
 	auto comparison = [](const PossibleMergeEvent& e1, const PossibleMergeEvent& e2) { return e1.time > e2.time; };
-	std::priority_queue<PossibleMergeEvent, std::vector<PossibleMergeEvent>, decltype(comparison)> events{comparison};
+	// Dilations of the patterns in the current partition, used to compute intersection delays.
+	DilationCache dilationCache;
+
+	int nThreads = std::max(1, ps.threads > 0 ? ps.threads : static_cast<int>(std::thread::hardware_concurrency()));
+	WorkerPool pool(nThreads);
 
 	// Add SinglePoint--SinglePoint merges
-	for (int i = 0; i < partition.size(); ++i) {
+	// Points can only be merged if they are within distance 2 * maxTime, and a point can only be too close to the
+	// segment between them if it lies near that segment. Both are pruned with range queries on a k-d tree of the
+	// (distinct) point locations.
+	std::map<Point<Inexact>, std::vector<int>> locationToPoints;
+	for (int i = 0; i < points.size(); ++i) {
+		locationToPoints[points[i].point].push_back(i);
+	}
+	std::vector<Point<Inexact>> locations;
+	for (const auto& [location, _] : locationToPoints) {
+		locations.push_back(location);
+	}
+	KdTree tree(locations.begin(), locations.end());
+	// Build the tree now: queries on a tree that is not yet built are not thread-safe.
+	tree.build();
+	auto pointsWithin = [&tree, &locationToPoints](const Point<Inexact>& center, Number<Inexact> radius) {
+		std::vector<Point<Inexact>> found;
+		tree.search(std::back_inserter(found), FuzzySphere(center, radius));
+		std::vector<int> result;
+		for (const auto& location : found) {
+			const auto& indices = locationToPoints.at(location);
+			std::copy(indices.begin(), indices.end(), std::back_inserter(result));
+		}
+		return result;
+	};
+
+	// Each task collects its events in its own buffer; the buffers are concatenated in order so that the result
+	// does not depend on the scheduling of the tasks.
+	auto admissibleRadius = ps.admissibleRadiusFactor * gs.dilationRadius();
+	std::vector<std::vector<PossibleMergeEvent>> pointEvents(partition.size());
+	pool.parallelFor(partition.size(), [&](int i) {
 		auto& p = dynamic_cast<SinglePoint&>(*partition[i]);
-		for (int j = i + 1; j < partition.size(); ++j) {
+		for (int j : pointsWithin(p.catPoint().point, 2 * maxTime)) {
+			if (j <= i) continue;
 			auto& q = dynamic_cast<SinglePoint&>(*partition[j]);
 			if (p.category() != q.category()) continue;
 			if (squared_distance(p.catPoint().point, q.catPoint().point) > squared(2 * maxTime)) continue;
@@ -130,10 +331,13 @@ partition(const std::vector<CatPoint>& points, const GeneralSettings& gs, const
 			Segment<Inexact> seg(p.catPoint().point, q.catPoint().point);
 
 			bool tooClose = false;
-			for (const CatPoint& pt : points) {
+			// Only points within this distance of the midpoint can be within the admissible radius of the segment.
+			auto nearbyRadius = sqrt(seg.squared_length()) / 2 + admissibleRadius + M_EPSILON;
+			for (int k : pointsWithin(CGAL::midpoint(seg.source(), seg.target()), nearbyRadius)) {
+				const CatPoint& pt = points[k];
 				// Check if a point is too close to the segment
 				if (pt != p.catPoint() && pt != q.catPoint() &&
-				    CGAL::squared_distance(seg, pt.point) < squared(ps.admissibleRadiusFactor * gs.dilationRadius()) &&
+				    CGAL::squared_distance(seg, pt.point) < squared(admissibleRadius) &&
 				    CGAL::squared_distance(seg, pt.point) < CGAL::min(CGAL::squared_distance(p.catPoint().point, pt.point),
 				                                                CGAL::squared_distance(q.catPoint().point, pt.point)) - M_EPSILON) {
 					tooClose = true;
@@ -143,9 +347,16 @@ partition(const std::vector<CatPoint>& points, const GeneralSettings& gs, const
 			if (tooClose) continue;
 
 			PossibleMergeEvent event{newPattern->coverRadius(), partition[i], partition[j], newPattern, false};
-			events.push(event);
+			pointEvents[i].push_back(event);
 		}
+	});
+
+	// Heapify all initial events at once.
+	std::vector<PossibleMergeEvent> initialEvents;
+	for (auto& evs : pointEvents) {
+		std::move(evs.begin(), evs.end(), std::back_inserter(initialEvents));
 	}
+	std::priority_queue<PossibleMergeEvent, std::vector<PossibleMergeEvent>, decltype(comparison)> events{comparison, std::move(initialEvents)};
 
 	while (!events.empty()) {
 		auto ev = events.top();
@@ -153,14 +364,6 @@ partition(const std::vector<CatPoint>& points, const GeneralSettings& gs, const
 
 		if (ev.time > maxTime) break;
 
-		if (!ev.final) {
-			auto delay = intersectionDelay(points, *ev.p1, *ev.p2, *ev.result, gs, ps);
-			ev.time += delay;
-			ev.final = true;
-			events.push(ev);
-			continue;
-		}
-
 		// Check if patterns that events wants to merge still exist
 		bool foundP1 = false;
 		bool foundP2 = false;
@@ -174,6 +377,14 @@ partition(const std::vector<CatPoint>& points, const GeneralSettings& gs, const
 		}
 		if (!foundP1 || !foundP2) continue;
 
+		if (!ev.final) {
+			auto delay = intersectionDelay(points, *ev.p1, *ev.p2, *ev.result, gs, ps, dilationCache);
+			ev.time += delay;
+			ev.final = true;
+			events.push(ev);
+			continue;
+		}
+
 		auto& newPts = ev.result->catPoints();
 		auto newPoly = ev.result->poly();
 
@@ -213,14 +424,23 @@ partition(const std::vector<CatPoint>& points, const GeneralSettings& gs, const
 		auto startTrash = std::remove_if(partition.begin(), partition.end(),
 		                                 [&ev](const auto& part) { return part == ev.p1 || part == ev.p2; });
 		partition.erase(startTrash, partition.end());
+		dilationCache.erase(*ev.p1);
+		dilationCache.erase(*ev.p2);
 		// Add the result
 		partition.push_back(ev.result);
-		// Save this partition
-		history.emplace_back(ev.time, partition);
+		// Save this merge
+		merges.push_back({ev.time, ev.p1, ev.p2, ev.result});
+		Profiler::count("partition merges");
 
 		// Create new merge events
+		std::vector<std::shared_ptr<PolyPattern>> candidates;
 		for (const auto& pattern : partition) {
 			if (pattern == ev.result || pattern->category() != ev.result->category()) continue;
+			candidates.push_back(pattern);
+		}
+		std::vector<std::vector<PossibleMergeEvent>> candidateEvents(candidates.size());
+		pool.parallelFor(candidates.size(), [&](int k) {
+			const auto& pattern = candidates[k];
 
 			if (ps.islands) {
 				// Do relatively cheap check first: are the points in the two patterns close enough to ever form a pattern?
@@ -238,15 +458,22 @@ partition(const std::vector<CatPoint>& points, const GeneralSettings& gs, const
 					std::vector<CatPoint> mergedPoints;
 					std::copy(newPts.begin(), newPts.end(), std::back_inserter(mergedPoints));
 					std::copy(pattern->catPoints().begin(), pattern->catPoints().end(), std::back_inserter(mergedPoints));
-					auto newIsland = std::make_shared<Island>(mergedPoints);
 
-					// todo? do intersection check here already? check how this affects performance
+					// Second cheap check: does a lower bound on the cover radius already put the merge after maxTime?
+					// The event time only grows with the cover radius, so then the island need not be constructed.
+					Number<Inexact> lowerBound = islandCoverRadiusLowerBound(mergedPoints);
+					Number<Inexact> regDelayLowerBound = !ps.regularityDelay ? 0 : lowerBound - std::max(pattern->coverRadius(), ev.result->coverRadius());
+					if (lowerBound + regDelayLowerBound <= maxTime + M_EPSILON) {
+						auto newIsland = std::make_shared<Island>(mergedPoints);
 
-					Number<Inexact> regDelay = !ps.regularityDelay ? 0 : newIsland->coverRadius() - std::max(pattern->coverRadius(), ev.result->coverRadius());
-					Number<Inexact> eventTime = newIsland->coverRadius() + regDelay;
-					PossibleMergeEvent newEvent{eventTime, ev.result, pattern, newIsland, false};
-					if (eventTime <= maxTime) {
-						events.push(newEvent);
+						// todo? do intersection check here already? check how this affects performance
+
+						Number<Inexact> regDelay = !ps.regularityDelay ? 0 : newIsland->coverRadius() - std::max(pattern->coverRadius(), ev.result->coverRadius());
+						Number<Inexact> eventTime = newIsland->coverRadius() + regDelay;
+						PossibleMergeEvent newEvent{eventTime, ev.result, pattern, newIsland, false};
+						if (eventTime <= maxTime) {
+							candidateEvents[k].push_back(newEvent);
+						}
 					}
 				}
 			}
@@ -287,14 +514,19 @@ partition(const std::vector<CatPoint>& points, const GeneralSettings& gs, const
 						Number<Inexact> eventTime = b->coverRadius() + regDelay;
 						PossibleMergeEvent newEvent{eventTime * 1, ev.result, pattern, b, false};
 						if (eventTime <= maxTime) {
-							events.push(newEvent);
+							candidateEvents[k].push_back(newEvent);
 						}
 					}
 				}
 			}
+		});
+		for (auto& evs : candidateEvents) {
+			for (auto& newEvent : evs) {
+				events.push(std::move(newEvent));
+			}
 		}
 	}
 
-	return history;
+	return {initialPartition, merges};
 }
 }
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "types.h"
 #include "cat_point.h"
 #include "partition.h"
+#include "dilated/dilated_poly.h"
 #include "patterns/bank.h"
 #include "patterns/island.h"
 #include "patterns/matching.h"
@@ -22,8 +23,17 @@ struct PossibleMergeEvent {
 
 Number<Inexact> intersectionDelay(const std::vector<CatPoint>& points, const PolyPattern& p1, const PolyPattern& p2,
 								  const PolyPattern& result, const GeneralSettings& gs, const PartitionSettings& ps);
+/// Computes the intersection delay, taking the dilations of \c p1 and \c p2 from \c cache.
+Number<Inexact> intersectionDelay(const std::vector<CatPoint>& points, const PolyPattern& p1, const PolyPattern& p2,
+								  const PolyPattern& result, const GeneralSettings& gs, const PartitionSettings& ps,
+								  DilationCache& cache);
 
 std::vector<std::pair<Number<Inexact>, Partition>>
 partition(const std::vector<CatPoint>& points, const GeneralSettings& gs, const PartitionSettings& ps, Number<Inexact> maxTime);
+
+/// Computes the partitions up to cover radius \c maxTime, stored as the sequence of merges.
+/// The partition at any cover radius can be obtained from the returned history.
+PartitionHistory
+partitionHistory(const std::vector<CatPoint>& points, const GeneralSettings& gs, const PartitionSettings& ps, Number<Inexact> maxTime);
 }
 #endif //CARTOCROW_PARTITION_ALGORITHM_H
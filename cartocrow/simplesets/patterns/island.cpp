@@ -1,6 +1,7 @@
 #include "island.h"
 #include "bank.h"
 #include "cartocrow/simplesets/helpers/cropped_voronoi.h"
+#include "cartocrow/simplesets/helpers/monotone_chain.h"
 #include "cartocrow/simplesets/helpers/point_voronoi_helpers.h"
 #include <CGAL/Boolean_set_operations_2.h>
 #include <CGAL/bounding_box.h>
@@ -57,6 +58,33 @@ Number<Inexact> coverRadiusOfPoints(const std::vector<Point<Inexact>>& points) {
 	return sqrt(*squaredCoverRadius);
 }
 
+Number<Inexact> islandCoverRadiusLowerBound(const std::vector<CatPoint>& catPoints) {
+	std::vector<Point<Inexact>> points;
+	for (const auto& cp : catPoints) {
+		points.push_back(cp.point);
+	}
+	auto hull = monotoneChainHull(points,
+	    [&points](int i, int j) { return CGAL::compare_xy(points[i], points[j]); },
+	    [&points](int i, int j, int k) { return CGAL::orientation(points[i], points[j], points[k]); });
+	if (hull.size() < 2) {
+		return 0;
+	}
+
+	// Each hull edge midpoint lies in the hull, so its distance to the nearest point is at most the cover radius.
+	Number<Inexact> squaredLowerBound = 0;
+	for (int i = 0; i < hull.size(); ++i) {
+		auto m = CGAL::midpoint(points[hull[i]], points[hull[(i + 1) % hull.size()]]);
+		Number<Inexact> nearest = std::numeric_limits<double>::infinity();
+		for (const auto& p : points) {
+			nearest = std::min(nearest, CGAL::squared_distance(m, p));
+			// This midpoint cannot improve the bound anymore.
+			if (nearest <= squaredLowerBound) break;
+		}
+		squaredLowerBound = std::max(squaredLowerBound, nearest);
+	}
+	return sqrt(squaredLowerBound);
+}
+
 Island::Island(std::vector<CatPoint> catPoints): m_catPoints(std::move(catPoints)) {
 	// Store the point positions separately, sometimes only the positions are needed.
 	std::transform(m_catPoints.begin(), m_catPoints.end(), std::back_inserter(m_points), [](const CatPoint& cp) {
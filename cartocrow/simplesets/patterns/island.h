@@ -8,6 +8,10 @@
 namespace cartocrow::simplesets {
 typedef CGAL::Delaunay_triangulation_2<Exact> DT;
 
+/// Returns a lower bound on the cover radius of an island on \p catPoints, which is much cheaper to
+/// compute than the cover radius itself. It is based on the floating-point convex hull of the points.
+Number<Inexact> islandCoverRadiusLowerBound(const std::vector<CatPoint>& catPoints);
+
 class Island : public PolyPattern {
   public:
 	Island(std::vector<CatPoint> catPoints);
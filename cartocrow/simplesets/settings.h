@@ -32,6 +32,11 @@ struct PartitionSettings {
 	bool intersectionDelay;
 	/// Disallow merges that have a point within distance admissibleRadiusFactor * dilationRadius.
 	Number<Inexact> admissibleRadiusFactor;
+	/// Number of threads used to generate candidate merges; 0 uses the hardware concurrency.
+	/// Generating a candidate constructs islands and banks, which evaluate lazy exact (Epeck) numbers, and reads the
+	/// patterns of the current partition. CGAL only supports this concurrently if its lazy kernel is thread-safe,
+	/// which depends on the version and configuration of CGAL. The default is therefore 1.
+	int threads = 1;
 };
 
 struct ComputeDrawingSettings {
@@ -88,7 +88,7 @@ OptimizationDemo::OptimizationDemo() {
 				break;
 			}
 		}
-		m_renderer->update();
+		m_renderer->invalidate();
 	});
 	m_stopOnNanCheckbox = new QCheckBox("Stop on nan");
 	toolBar->addWidget(m_stopOnNanCheckbox);
@@ -97,7 +97,7 @@ OptimizationDemo::OptimizationDemo() {
 	connect(m_optimizeOneStepButton, &QPushButton::clicked, [&]() {
 		m_iterationCount++;
 		m_smoothTree->optimize();
-		m_renderer->update();
+		m_renderer->invalidate();
 		updateCostLabel();
 	});
 	toolBar->addSeparator();
@@ -331,19 +331,27 @@ IsolineSimplificationDemo::IsolineSimplificationDemo() {
 	connect(simplify_button, &QPushButton::clicked, [this, simplificationTarget, doDykenSimplify, measure_text, dyken_r]() {
 	  	m_debug_ladder = std::nullopt;
 		int target = simplificationTarget->value();
+		std::string measure_text_string;
 		if (doDykenSimplify->isChecked()) {
 			m_isoline_simplifier->dyken_simplify(target, dyken_r->value());
+
+			// The incremental metrics are not maintained by the Dyken simplification, so compute the measures
+			// from scratch on the result.
+			auto temp_simplifier = IsolineSimplifier(m_isoline_simplifier->m_simplified_isolines);
+			auto [avg_align, max_align] = temp_simplifier.average_max_vertex_alignment();
+			measure_text_string = "Symmetric difference: " + std::to_string(m_isoline_simplifier->total_symmetric_difference()) +
+			                      "\n#Ladders: " + std::to_string(temp_simplifier.ladder_count()) +
+			                      "\nAvg alignment: " + std::to_string(avg_align) +
+			                      "\nMax alignment: " + std::to_string(max_align);
 		} else {
 			m_isoline_simplifier->simplify(target);
-		}
 
-		auto temp_simplifier = IsolineSimplifier(m_isoline_simplifier->m_simplified_isolines);
-
-		auto [avg_align, max_align] = temp_simplifier.average_max_vertex_alignment();
-		auto measure_text_string = "Symmetric difference: " + std::to_string(m_isoline_simplifier->total_symmetric_difference()) +
-		                           "\n#Ladders: " + std::to_string(temp_simplifier.ladder_count()) +
-		                           "\nAvg alignment: " + std::to_string(avg_align) +
-		                           "\nMax alignment: " + std::to_string(max_align);
+			auto metrics = m_isoline_simplifier->metrics();
+			measure_text_string = "Symmetric difference (upper bound): " + std::to_string(metrics.m_symmetric_difference) +
+			                      "\nMax collapse symmetric difference: " + std::to_string(metrics.m_max_collapse_symmetric_difference) +
+			                      "\nAvg alignment: " + std::to_string(metrics.m_average_alignment) +
+			                      "\nMax alignment: " + std::to_string(metrics.m_max_alignment);
+		}
 
 		measure_text->setText(QString(measure_text_string.c_str()));
 		m_recalculate();
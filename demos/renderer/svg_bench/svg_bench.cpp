@@ -0,0 +1,233 @@
+/*
+The CartoCrow library implements algorithmic geo-visualization methods,
+developed at TU Eindhoven.
+Copyright (C) 2024 TU Eindhoven
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Benchmarks writing a synthetic map with many polygons to SVG, and reports the time and output size as JSON. The
+// SvgRenderer is compared to a renderer that formats its output like the SvgRenderer used to: through std::ofstream,
+// with a style string per element, and after setting the global locale. Both render the same painting.
+//
+// Usage: svg_bench [--polygons N] [--vertices K] [--output FILE]
+
+#include "cartocrow/renderer/function_painting.h"
+#include "cartocrow/renderer/svg_renderer.h"
+
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <sstream>
+
+using namespace cartocrow;
+using namespace cartocrow::renderer;
+
+namespace {
+struct Map {
+	std::vector<Polygon<Inexact>> polygons;
+	std::vector<Color> colors;
+};
+
+/// Generates star-shaped polygons on a grid, each with one of a few colors.
+Map generateMap(int polygons, int vertices, std::mt19937& rng) {
+	std::vector<Color> palette{{166, 206, 227}, {251, 154, 153}, {178, 223, 138}, {202, 178, 214}, {253, 191, 111}};
+	std::uniform_real_distribution<double> radius(20, 45);
+	std::uniform_int_distribution<size_t> color(0, palette.size() - 1);
+	int columns = static_cast<int>(std::ceil(std::sqrt(polygons)));
+
+	Map map;
+	for (int i = 0; i < polygons; ++i) {
+		double cx = 100.0 * (i % columns);
+		double cy = 100.0 * (i / columns);
+		std::vector<Point<Inexact>> points;
+		for (int j = 0; j < vertices; ++j) {
+			double angle = 2 * M_PI * j / vertices;
+			double r = radius(rng);
+			points.emplace_back(cx + r * std::cos(angle), cy + r * std::sin(angle));
+		}
+		map.polygons.emplace_back(points.begin(), points.end());
+		map.colors.push_back(palette[color(rng)]);
+	}
+	return map;
+}
+
+std::string legacyColor(const Color& color) {
+	return "rgb(" + std::to_string(color.r) + ", " + std::to_string(color.g) + ", " + std::to_string(color.b) + ")";
+}
+
+/// Renderer that writes polygons the way the SvgRenderer used to. It is driven
+/// by the same painting as the SvgRenderer, so that both pay for dispatching
+/// the draw calls. Only the calls that the benchmark painting makes are
+/// implemented; the others draw nothing.
+class LegacySvgRenderer : public GeometryRenderer {
+  public:
+	explicit LegacySvgRenderer(std::shared_ptr<GeometryPainting> painting) : m_painting(std::move(painting)) {}
+
+	void save(const std::filesystem::path& file) {
+		std::locale::global(std::locale("C"));
+		m_out.open(file);
+		m_out << "<svg version=\"1.1\" xmlns:inkscape=\"http://www.inkscape.org/namespaces/inkscape\" xmlns=\"http://www.w3.org/2000/svg\">\n";
+		m_out << "<g inkscape:groupmode=\"layer\">\n";
+		pushStyle();
+		m_painting->paint(*this);
+		popStyle();
+		m_out << "</g>\n";
+		m_out << "</svg>\n";
+		m_out.close();
+	}
+
+	void draw(const Polygon<Inexact>& polygon) override {
+		std::string style = "fill=\"" + legacyColor(m_style.fill) +
+		                    "\" fill-opacity=\"" + std::to_string(1.0) +
+		                    "\" stroke=\"" + legacyColor(m_style.stroke) +
+		                    "\" stroke-linecap=\"round" +
+		                    "\" stroke-linejoin=\"round" +
+		                    "\" stroke-opacity=\"" + std::to_string(1.0) +
+		                    "\" stroke-width=\"" + std::to_string(m_style.strokeWidth) + "\"";
+		std::stringstream curve;
+		bool first = true;
+		for (const auto& vertex : polygon) {
+			curve << (first ? "M " : "L ") << vertex.x() << " " << -vertex.y() << " ";
+			first = false;
+		}
+		curve << "Z";
+		m_out << "<path " << style << " d=\"" << curve.str() << "\"/>\n";
+	}
+	void draw(const Point<Inexact>&) override {}
+	void draw(const Segment<Inexact>&) override {}
+	void draw(const PolygonWithHoles<Inexact>&) override {}
+	void draw(const Circle<Inexact>&) override {}
+	void draw(const BezierSpline&) override {}
+	void draw(const Line<Inexact>&) override {}
+	void draw(const Ray<Inexact>&) override {}
+	void draw(const Polyline<Inexact>&) override {}
+	void draw(const CircularArc&) override {}
+	void drawText(const Point<Inexact>&, const std::string&) override {}
+
+	void pushStyle() override {
+		m_styles.push_back(m_style);
+	}
+	void popStyle() override {
+		m_style = m_styles.back();
+		m_styles.pop_back();
+	}
+	void setMode(int) override {}
+	void setStroke(Color color, double width) override {
+		m_style.stroke = color;
+		m_style.strokeWidth = width;
+	}
+	void setStrokeOpacity(int) override {}
+	void setFill(Color color) override {
+		m_style.fill = color;
+	}
+	void setFillOpacity(int) override {}
+
+  private:
+	struct Style {
+		Color stroke{0, 0, 0};
+		double strokeWidth = 1;
+		Color fill{0, 0, 0};
+	};
+	std::shared_ptr<GeometryPainting> m_painting;
+	std::ofstream m_out;
+	Style m_style;
+	std::vector<Style> m_styles;
+};
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void report(const std::string& name, double seconds, const std::filesystem::path& file, std::ostream& json) {
+	json << "    {\"writer\": \"" << name << "\", \"seconds\": " << seconds
+	     << ", \"output_bytes\": " << std::filesystem::file_size(file) << "}";
+}
+}
+
+int main(int argc, char* argv[]) {
+	int polygons = 100000;
+	int vertices = 50;
+	std::optional<std::filesystem::path> outputPath;
+
+	for (int i = 1; i + 1 < argc; i += 2) {
+		std::string option = argv[i];
+		std::string value = argv[i + 1];
+		if (option == "--polygons") {
+			polygons = std::stoi(value);
+		} else if (option == "--vertices") {
+			vertices = std::stoi(value);
+		} else if (option == "--output") {
+			outputPath = value;
+		} else {
+			std::cerr << "Unknown option " << option << std::endl;
+			return 1;
+		}
+	}
+
+	std::mt19937 rng(0);
+	Map map = generateMap(polygons, vertices, rng);
+	auto painting = std::make_shared<FunctionPainting>([&map](GeometryRenderer& renderer) {
+		renderer.setMode(GeometryRenderer::fill | GeometryRenderer::stroke);
+		renderer.setStroke(Color{0, 0, 0}, 1.0);
+		for (size_t i = 0; i < map.polygons.size(); ++i) {
+			renderer.setFill(map.colors[i]);
+			renderer.draw(map.polygons[i]);
+		}
+	});
+
+	auto outputDir = std::filesystem::temp_directory_path() / "svg_bench";
+	std::filesystem::create_directories(outputDir);
+
+	std::stringstream json;
+	json << "{\n  \"polygons\": " << polygons << ",\n  \"vertices\": " << vertices << ",\n  \"runs\": [\n";
+
+	auto file = outputDir / "legacy.svg";
+	LegacySvgRenderer legacy(painting);
+	auto start = std::chrono::steady_clock::now();
+	legacy.save(file);
+	report("legacy", secondsSince(start), file, json);
+	json << ",\n";
+
+	struct Variant {
+		std::string name;
+		std::string fileName;
+		int precision;
+	};
+	std::vector<Variant> variants{{"svg", "map.svg", 6}, {"svg-precision-4", "map-4.svg", 4}};
+	if (SvgRenderer::supportsCompression()) {
+		variants.push_back({"svgz", "map.svgz", 6});
+	}
+	for (size_t i = 0; i < variants.size(); ++i) {
+		SvgRenderer renderer(painting);
+		renderer.setPrecision(variants[i].precision);
+		file = outputDir / variants[i].fileName;
+		start = std::chrono::steady_clock::now();
+		renderer.save(file);
+		report(variants[i].name, secondsSince(start), file, json);
+		json << (i + 1 < variants.size() ? ",\n" : "\n");
+	}
+	json << "  ]\n}\n";
+
+	if (outputPath.has_value()) {
+		std::ofstream out(*outputPath);
+		out << json.str();
+	} else {
+		std::cout << json.str();
+	}
+}
@@ -0,0 +1,99 @@
+/*
+The CartoCrow library implements algorithmic geo-visualization methods,
+developed at TU Eindhoven.
+Copyright (C) 2024 TU Eindhoven
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Counts the heap allocations made while computing a SimpleSets partition and drawing, with and without scratch
+// arenas for temporaries.
+//
+// Usage: simplesets_allocation_bench [input file] [cover]
+
+#include "cartocrow/simplesets/drawing_algorithm.h"
+#include "cartocrow/simplesets/helpers/scratch_arena.h"
+#include "cartocrow/simplesets/parse_input.h"
+#include "cartocrow/simplesets/partition_algorithm.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <sstream>
+
+namespace {
+std::atomic<long long> allocations = 0;
+}
+
+void* operator new(std::size_t size) {
+	++allocations;
+	if (void* p = std::malloc(size == 0 ? 1 : size)) {
+		return p;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+	std::free(p);
+}
+
+using namespace cartocrow;
+using namespace cartocrow::simplesets;
+
+int main(int argc, char* argv[]) {
+	std::string filePath = argc > 1 ? argv[1] : "data/nyc.txt";
+	double cover = argc > 2 ? std::stod(argv[2]) : 4.7;
+
+	std::ifstream inputStream(filePath, std::ios_base::in);
+	if (!inputStream.good()) {
+		std::cerr << "Failed to read input " << filePath << std::endl;
+		return 1;
+	}
+	std::stringstream buffer;
+	buffer << inputStream.rdbuf();
+	auto points = parseCatPoints(buffer.str());
+
+	GeneralSettings gs{2.1, 2, M_PI, 70.0 / 180 * M_PI};
+	PartitionSettings ps{true, true, true, true, 0.1, 1};
+	ComputeDrawingSettings cds{0.675};
+
+	for (bool enabled : {false, true}) {
+		ScratchArena::setEnabled(enabled);
+
+		allocations = 0;
+		auto start = std::chrono::steady_clock::now();
+		auto history = partitionHistory(points, gs, ps, 8 * gs.dilationRadius());
+		long long partitionAllocations = allocations;
+		auto partition = history.at(history.stepAt(cover * gs.dilationRadius()));
+
+		allocations = 0;
+		auto drawStart = std::chrono::steady_clock::now();
+		DilatedPatternDrawing dpd(partition, gs, cds);
+		long long drawingAllocations = allocations;
+		auto end = std::chrono::steady_clock::now();
+
+		std::cout << (enabled ? "with arenas:    " : "without arenas: ")
+		          << "partition " << partitionAllocations << " allocations ("
+		          << std::chrono::duration<double>(drawStart - start).count() << " s), "
+		          << "drawing " << drawingAllocations << " allocations ("
+		          << std::chrono::duration<double>(end - drawStart).count() << " s)" << std::endl;
+	}
+}
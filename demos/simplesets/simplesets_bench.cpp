@@ -0,0 +1,278 @@
+/*
+The CartoCrow library implements algorithmic geo-visualization methods,
+developed at TU Eindhoven.
+Copyright (C) 2024 TU Eindhoven
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Benchmarks the SimpleSets pipeline on the example data and on synthetic point sets, and reports the time spent in
+// each stage as JSON.
+//
+// Usage: simplesets_bench [--data-dir DIR] [--sizes N1,N2,...] [--cover C] [--output FILE]
+
+#include "cartocrow/renderer/svg_renderer.h"
+#include "cartocrow/simplesets/drawing_algorithm.h"
+#include "cartocrow/simplesets/parse_input.h"
+#include "cartocrow/simplesets/partition_algorithm.h"
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <set>
+#include <sstream>
+
+using namespace cartocrow;
+using namespace cartocrow::renderer;
+using namespace cartocrow::simplesets;
+
+namespace {
+struct Input {
+	std::string name;
+	std::vector<CatPoint> points;
+	GeneralSettings gs;
+	PartitionSettings ps;
+};
+
+/// Distance between the cells of the grid on which synthetic points are placed. Points are jittered within their
+/// cell, but stay far enough apart that points of different categories are never too close to draw.
+constexpr double cellSize = 12;
+constexpr double jitter = 3;
+constexpr int categories = 3;
+
+std::vector<CatPoint> uniformPoints(int n, std::mt19937& rng) {
+	// Occupy half of the cells of a square grid.
+	int side = static_cast<int>(std::ceil(std::sqrt(2.0 * n)));
+	std::uniform_int_distribution<int> cell(0, side - 1);
+	std::uniform_int_distribution<int> category(0, categories - 1);
+	std::uniform_real_distribution<double> offset(0, jitter);
+	std::set<std::pair<int, int>> occupied;
+	std::vector<CatPoint> points;
+	while (points.size() < n) {
+		int x = cell(rng);
+		int y = cell(rng);
+		if (!occupied.emplace(x, y).second) continue;
+		points.emplace_back(category(rng), Point<Inexact>(x * cellSize + offset(rng), y * cellSize + offset(rng)));
+	}
+	return points;
+}
+
+std::vector<CatPoint> clusteredPoints(int n, std::mt19937& rng) {
+	// Clusters of about 50 points, mostly of a single category.
+	int clusters = std::max(1, n / 50);
+	int side = static_cast<int>(std::ceil(std::sqrt(8.0 * n)));
+	std::uniform_real_distribution<double> center(0, side);
+	std::normal_distribution<double> spread(0, 3);
+	std::uniform_int_distribution<int> category(0, categories - 1);
+	std::bernoulli_distribution noise(0.1);
+	std::uniform_real_distribution<double> offset(0, jitter);
+	std::vector<std::pair<Point<Inexact>, int>> centers;
+	for (int c = 0; c < clusters; ++c) {
+		centers.emplace_back(Point<Inexact>(center(rng), center(rng)), category(rng));
+	}
+	std::uniform_int_distribution<int> clusterIndex(0, clusters - 1);
+	std::set<std::pair<int, int>> occupied;
+	std::vector<CatPoint> points;
+	while (points.size() < n) {
+		const auto& [c, cat] = centers[clusterIndex(rng)];
+		int x = static_cast<int>(std::round(c.x() + spread(rng)));
+		int y = static_cast<int>(std::round(c.y() + spread(rng)));
+		if (!occupied.emplace(x, y).second) continue;
+		points.emplace_back(noise(rng) ? category(rng) : cat,
+		                    Point<Inexact>(x * cellSize + offset(rng), y * cellSize + offset(rng)));
+	}
+	return points;
+}
+
+std::vector<CatPoint> readPoints(const std::filesystem::path& path) {
+	std::ifstream inputStream(path, std::ios_base::in);
+	if (!inputStream.good()) {
+		throw std::runtime_error("Failed to read input " + path.string());
+	}
+	std::stringstream buffer;
+	buffer << inputStream.rdbuf();
+	return parseCatPoints(buffer.str());
+}
+
+bool wellSeparated(const std::vector<CatPoint>& points, const GeneralSettings& gs) {
+	// Sort by x so that only points within the separation distance in x need to be compared.
+	auto sorted = points;
+	std::sort(sorted.begin(), sorted.end(), [](const CatPoint& p, const CatPoint& q) {
+		return p.point.x() < q.point.x();
+	});
+	auto separation = 2 * gs.pointSize;
+	for (int i = 0; i < sorted.size(); ++i) {
+		for (int j = i + 1; j < sorted.size() && sorted[j].point.x() - sorted[i].point.x() < separation; ++j) {
+			if (sorted[i].category != sorted[j].category &&
+			    CGAL::squared_distance(sorted[i].point, sorted[j].point) < separation * separation) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+/// Resets the peak resident memory of this process to its current resident memory, so that \ref peakMemory()
+/// measures the peak of a single run. Returns false if this is not supported (it needs Linux 4.0 or later), in which
+/// case the peak is that of the whole process so far.
+bool resetPeakMemory() {
+	std::ofstream clearRefs("/proc/self/clear_refs");
+	clearRefs << "5";
+	clearRefs.flush();
+	return clearRefs.good();
+}
+
+/// Peak resident memory since the last successful \ref resetPeakMemory(), in kilobytes.
+long peakMemory() {
+	std::ifstream status("/proc/self/status");
+	std::string line;
+	while (std::getline(status, line)) {
+		if (line.rfind("VmHWM:", 0) == 0) {
+			return std::stol(line.substr(6));
+		}
+	}
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss;
+}
+
+/// Writes the peak memory of a run, under a key that says whether it is the peak of the run or of the process.
+void writePeakMemory(bool perRun, std::ostream& json) {
+	json << (perRun ? ", \"peak_memory_kb\": " : ", \"process_peak_memory_kb\": ") << peakMemory();
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+std::string escape(const std::string& s) {
+	std::string result;
+	for (char c : s) {
+		if (c == '"' || c == '\\') result += '\\';
+		result += c;
+	}
+	return result;
+}
+
+void run(const Input& input, double cover, const std::filesystem::path& outputDir, std::ostream& json) {
+	std::cerr << "Running " << input.name << " (" << input.points.size() << " points)" << std::endl;
+	bool perRunMemory = resetPeakMemory();
+	json << "    {\"input\": \"" << escape(input.name) << "\", \"points\": " << input.points.size();
+
+	auto start = std::chrono::steady_clock::now();
+	auto history = partitionHistory(input.points, input.gs, input.ps, 8 * input.gs.dilationRadius());
+	json << ", \"partition\": " << secondsSince(start);
+	auto partition = history.at(history.stepAt(cover * input.gs.dilationRadius()));
+	json << ", \"merges\": " << history.merges().size() << ", \"patterns\": " << partition.size();
+
+	if (!wellSeparated(input.points, input.gs)) {
+		json << ", \"drawing\": null";
+		writePeakMemory(perRunMemory, json);
+		json << "}";
+		return;
+	}
+
+	ComputeDrawingSettings cds{0.675};
+	start = std::chrono::steady_clock::now();
+	DilatedPatternDrawing dpd(partition, input.gs, cds);
+	json << ", \"drawing\": " << secondsSince(start);
+	for (size_t i = 0; i < dpd.m_timer.size(); ++i) {
+		auto [stage, seconds] = dpd.m_timer[i];
+		std::string key = stage;
+		std::transform(key.begin(), key.end(), key.begin(), [](char c) { return c == ' ' ? '_' : std::tolower(c); });
+		json << ", \"" << key << "\": " << seconds;
+	}
+
+	DrawSettings ds{{Color{166, 206, 227}, Color{251, 154, 153}, Color{178, 223, 138}, Color{202, 178, 214}, Color{253, 191, 111}}, 0.7};
+	start = std::chrono::steady_clock::now();
+	auto painting = std::make_shared<SimpleSetsPainting>(dpd, ds);
+	SvgRenderer renderer(painting);
+	auto outputFile = outputDir / (input.name + ".svg");
+	renderer.save(outputFile);
+	json << ", \"paint\": " << secondsSince(start);
+	json << ", \"output_bytes\": " << std::filesystem::file_size(outputFile);
+	writePeakMemory(perRunMemory, json);
+	json << "}";
+}
+}
+
+int main(int argc, char* argv[]) {
+	std::filesystem::path dataDir = "data";
+	std::vector<int> sizes{1000, 10000};
+	double cover = 4.7;
+	std::optional<std::filesystem::path> outputPath;
+
+	for (int i = 1; i + 1 < argc; i += 2) {
+		std::string option = argv[i];
+		std::string value = argv[i + 1];
+		if (option == "--data-dir") {
+			dataDir = value;
+		} else if (option == "--sizes") {
+			sizes.clear();
+			std::stringstream ss(value);
+			std::string size;
+			while (std::getline(ss, size, ',')) {
+				sizes.push_back(std::stoi(size));
+			}
+		} else if (option == "--cover") {
+			cover = std::stod(value);
+		} else if (option == "--output") {
+			outputPath = value;
+		} else {
+			std::cerr << "Unknown option " << option << std::endl;
+			return 1;
+		}
+	}
+
+	// Settings as in the SimpleSets demo.
+	GeneralSettings nycSettings{2.1, 2, M_PI, 70.0 / 180 * M_PI};
+	PartitionSettings nycPartitionSettings{true, true, true, true, 0.1};
+	GeneralSettings diseasomeSettings{5.204, 2, M_PI, 70.0 / 180 * M_PI};
+	PartitionSettings diseasomePartitionSettings{true, true, true, false, 0.5};
+
+	std::vector<Input> inputs;
+	inputs.push_back({"nyc", readPoints(dataDir / "nyc.txt"), nycSettings, nycPartitionSettings});
+	inputs.push_back({"diseasome", readPoints(dataDir / "diseasome.txt"), diseasomeSettings, diseasomePartitionSettings});
+	std::mt19937 rng(0);
+	for (int n : sizes) {
+		inputs.push_back({"uniform-" + std::to_string(n), uniformPoints(n, rng), nycSettings, nycPartitionSettings});
+		inputs.push_back({"clustered-" + std::to_string(n), clusteredPoints(n, rng), nycSettings, nycPartitionSettings});
+	}
+
+	auto outputDir = std::filesystem::temp_directory_path() / "simplesets_bench";
+	std::filesystem::create_directories(outputDir);
+
+	std::stringstream json;
+	json << "{\n  \"cover\": " << cover << ",\n  \"runs\": [\n";
+	for (int i = 0; i < inputs.size(); ++i) {
+		run(inputs[i], cover, outputDir, json);
+		json << (i + 1 < inputs.size() ? ",\n" : "\n");
+	}
+	json << "  ]\n}\n";
+
+	if (outputPath.has_value()) {
+		std::ofstream out(*outputPath);
+		out << json.str();
+	} else {
+		std::cout << json.str();
+	}
+}
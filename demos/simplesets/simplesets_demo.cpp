@@ -169,23 +169,12 @@ void SimpleSetsDemo::resizeEvent(QResizeEvent *event) {
 }
 
 void SimpleSetsDemo::computePartitions(){
-	m_partitions = partition(m_points, m_gs, m_ps, 8 * m_gs.dilationRadius());
+	m_history = partitionHistory(m_points, m_gs, m_ps, 8 * m_gs.dilationRadius());
+	m_dilationCache.clear();
 }
 
 void SimpleSetsDemo::computeDrawing(double cover) {
-	Partition* thePartition;
-	bool found = false;
-	for (auto& [time, partition] : m_partitions) {
-		if (time < cover * m_gs.dilationRadius()) {
-			thePartition = &partition;
-			found = true;
-		}
-	}
-	if (found) {
-		m_partition = *thePartition;
-	} else {
-		m_partition = m_partitions.front().second;
-	}
+	m_partition = m_history.at(m_history.stepAt(cover * m_gs.dilationRadius()));
 
 	m_renderer->clear();
 
@@ -202,7 +191,7 @@ void SimpleSetsDemo::computeDrawing(double cover) {
 		}
 	}
 	if (wellSeparated) {
-		m_dpd = std::make_shared<DilatedPatternDrawing>(m_partition, m_gs, m_cds);
+		m_dpd = std::make_shared<DilatedPatternDrawing>(m_partition, m_gs, m_cds, m_dilationCache);
 		auto ap = std::make_shared<SimpleSetsPainting>(*m_dpd, m_ds);
 		m_renderer->addPainting(ap, "Arrangement");
 	} else {
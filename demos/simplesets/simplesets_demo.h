@@ -50,7 +50,8 @@ class SimpleSetsDemo : public QMainWindow {
 	PartitionSettings m_ps;
 	ComputeDrawingSettings m_cds;
 	GeometryWidget* m_renderer;
-	std::vector<std::pair<Number<Inexact>, Partition>> m_partitions;
+	PartitionHistory m_history;
+	DilationCache m_dilationCache;
 
 	std::shared_ptr<Point<Inexact>> m_cc;
 	void fitToScreen();
@@ -37,6 +37,7 @@ Created by tvl (t.vanlankveld@esciencecenter.nl) on 10-09-2019
 #include "cartocrow/flow_map/place.h"
 #include "cartocrow/flow_map/spiral_tree.h"
 #include "cartocrow/flow_map/spiral_tree_unobstructed_algorithm.h"
+#include "cartocrow/isoline_simplification/binary_isolines.h"
 #include "cartocrow/isoline_simplification/ipe_isolines.h"
 #include "cartocrow/isoline_simplification/isoline_simplifier.h"
 #include "cartocrow/isoline_simplification/simple_isoline_painting.h"
@@ -119,8 +120,12 @@ int main(int argc, char* argv[]) {
 		painting = std::make_shared<flow_map::Painting>(map_ptr, tree, options);
 
 	} else if (projectData["type"] == "isoline_simplification") {
-		auto isolines = isoline_simplification::ipeToIsolines(projectFilename.parent_path() / projectData["isolines"]);
-		isoline_simplification::IsolineSimplifier simplifier(isolines);
+		std::filesystem::path isolinesFile = projectFilename.parent_path() / projectData["isolines"];
+		// binary isoline files are streamed directly, which is much cheaper than going through Ipelib for large inputs
+		auto isolines = isolinesFile.extension() == ".isolines"
+		                    ? isoline_simplification::binaryToIsolines(isolinesFile)
+		                    : isoline_simplification::ipeToIsolines(isolinesFile);
+		isoline_simplification::IsolineSimplifier simplifier(std::move(isolines));
 		int target = projectData["target"];
 		simplifier.simplify(target);
 		painting = std::make_shared<isoline_simplification::SimpleIsolinePainting>(simplifier.m_simplified_isolines);
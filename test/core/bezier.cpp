@@ -0,0 +1,52 @@
+#include "../catch.hpp"
+
+#include "cartocrow/core/bezier.h"
+
+using namespace cartocrow;
+
+TEST_CASE("Flattening a Bezier spline") {
+	BezierSpline spline;
+	spline.appendCurve(Point<Inexact>(0, 0), Point<Inexact>(0, 10), Point<Inexact>(10, 10), Point<Inexact>(10, 0));
+	spline.appendCurve(Point<Inexact>(10, -10), Point<Inexact>(20, -10), Point<Inexact>(20, 0));
+	const Number<Inexact> tolerance = 0.01;
+
+	std::vector<Point<Inexact>> points;
+	CHECK(spline.flatten(tolerance, points));
+	int n0 = spline.curves()[0].flatteningSegmentCount(tolerance);
+	int n1 = spline.curves()[1].flatteningSegmentCount(tolerance);
+	REQUIRE(points.size() == static_cast<size_t>(n0 + n1 + 1));
+	CHECK(points.front() == spline.curves()[0].source());
+	CHECK(points[n0] == spline.curves()[0].target());
+	CHECK(points.back() == spline.curves()[1].target());
+
+	// every segment stays within the tolerance of the part of the curve it replaces
+	for (int c = 0; c < 2; ++c) {
+		const BezierCurve& curve = spline.curves()[c];
+		int n = c == 0 ? n0 : n1;
+		int offset = c == 0 ? 0 : n0;
+		for (int i = 0; i < n; ++i) {
+			Segment<Inexact> segment(points[offset + i], points[offset + i + 1]);
+			for (int j = 0; j <= 10; ++j) {
+				Number<Inexact> t = (i + j / 10.0) / n;
+				CHECK(CGAL::squared_distance(segment, curve.evaluate(t)) <= tolerance * tolerance);
+			}
+		}
+	}
+
+	// a straight curve needs only one segment
+	BezierCurve straight(Point<Inexact>(0, 0), Point<Inexact>(1, 1), Point<Inexact>(2, 2), Point<Inexact>(3, 3));
+	CHECK(straight.flatteningSegmentCount(tolerance) == 1);
+
+	// the buffer is reused
+	BezierSpline empty;
+	CHECK(empty.flatten(tolerance, points));
+	CHECK(points.empty());
+
+	// a curve that needs too many segments is flattened into the maximum number, and reported
+	BezierSpline huge;
+	huge.appendCurve(Point<Inexact>(0, 0), Point<Inexact>(0, 1e6), Point<Inexact>(1e6, 1e6), Point<Inexact>(1e6, 0));
+	CHECK(huge.curves()[0].flatteningSegmentCount(1e-6) == MAX_FLATTENING_SEGMENTS);
+	CHECK_FALSE(huge.flatten(1e-6, points));
+	CHECK(points.size() == static_cast<size_t>(MAX_FLATTENING_SEGMENTS + 1));
+	CHECK(points.back() == huge.curves()[0].target());
+}
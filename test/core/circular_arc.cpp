@@ -0,0 +1,32 @@
+#include "../catch.hpp"
+
+#include "cartocrow/core/circular_arc.h"
+
+using namespace cartocrow;
+
+TEST_CASE("Flattening a circular arc") {
+	const Number<Inexact> tolerance = 0.001;
+	const Point<Inexact> center(1, 2);
+	const Number<Inexact> radius = 3;
+	CircularArc arc(Circle<Inexact>(center, radius * radius), M_PI / 4, -3 * M_PI / 2);
+
+	std::vector<Point<Inexact>> points;
+	CHECK(arc.flatten(tolerance, points));
+	REQUIRE(points.size() >= 2);
+	CHECK(CGAL::squared_distance(points.front(), center + radius * Vector<Inexact>(std::cos(M_PI / 4), std::sin(M_PI / 4))) < 1e-18);
+	CHECK(CGAL::squared_distance(points.back(), center + radius * Vector<Inexact>(std::cos(-5 * M_PI / 4), std::sin(-5 * M_PI / 4))) < 1e-18);
+
+	for (size_t i = 0; i + 1 < points.size(); ++i) {
+		// the vertices lie on the circle, and the middle of each chord is within the tolerance
+		CHECK(std::abs(std::sqrt(CGAL::squared_distance(points[i], center)) - radius) < 1e-9);
+		Point<Inexact> middle = CGAL::midpoint(points[i], points[i + 1]);
+		CHECK(radius - std::sqrt(CGAL::squared_distance(middle, center)) <= tolerance + 1e-9);
+		// the vertices go clockwise, like the arc
+		CHECK(CGAL::orientation(center, points[i], points[i + 1]) == CGAL::RIGHT_TURN);
+	}
+
+	// an arc that needs too many segments is flattened into the maximum number, and reported
+	CircularArc large(Circle<Inexact>(center, 1e6), 0, M_PI);
+	CHECK_FALSE(large.flatten(1e-9, points));
+	CHECK(points.size() == static_cast<size_t>(MAX_FLATTENING_SEGMENTS + 1));
+}
@@ -0,0 +1,87 @@
+#include "../catch.hpp"
+
+#include <sstream>
+#include <thread>
+
+#include "cartocrow/core/profiler.h"
+
+using namespace cartocrow;
+
+TEST_CASE("Profiling nested zones and counters") {
+	Profiler& profiler = Profiler::instance();
+	profiler.clear();
+	profiler.setEnabled(true);
+	{
+		ProfileZone outer("outer");
+		{
+			ProfileZone inner("inner");
+			Profiler::count("items", 2);
+		}
+		std::thread thread([]() {
+			ProfileZone zone("thread");
+			Profiler::count("items");
+		});
+		thread.join();
+	}
+	profiler.setEnabled(false);
+	{
+		ProfileZone ignored("ignored");
+		Profiler::count("items");
+	}
+
+	std::vector<Profiler::Zone> zones = profiler.zones();
+	REQUIRE(zones.size() == 3);
+	CHECK(std::string(zones[0].m_name) == "outer");
+	CHECK(zones[0].m_depth == 0);
+	CHECK(std::string(zones[1].m_name) == "inner");
+	CHECK(zones[1].m_depth == 1);
+	CHECK(zones[1].m_thread == zones[0].m_thread);
+	CHECK(zones[1].m_duration <= zones[0].m_duration);
+	CHECK(std::string(zones[2].m_name) == "thread");
+	CHECK(zones[2].m_depth == 0);
+	CHECK(zones[2].m_thread != zones[0].m_thread);
+	CHECK(profiler.counters().at("items") == 3);
+
+	std::stringstream trace;
+	profiler.writeChromeTrace(trace);
+	CHECK(trace.str().find("\"name\": \"inner\", \"ph\": \"X\"") != std::string::npos);
+	CHECK(trace.str().find("\"ph\": \"C\"") != std::string::npos);
+
+	profiler.clear();
+	CHECK(profiler.zones().empty());
+	CHECK(profiler.counters().empty());
+}
+
+TEST_CASE("Profiling counters in a loop and threads that exit") {
+	Profiler& profiler = Profiler::instance();
+	profiler.clear();
+	profiler.setEnabled(true);
+	for (int i = 0; i < 100000; ++i) {
+		Profiler::count("iterations");
+	}
+	for (int i = 0; i < 2; ++i) {
+		std::thread thread([]() {
+			ProfileZone zone("thread");
+			Profiler::count("iterations", 10);
+		});
+		thread.join();
+	}
+	profiler.setEnabled(false);
+
+	CHECK(profiler.counters().at("iterations") == 100020);
+	std::stringstream trace;
+	profiler.writeChromeTrace(trace);
+	std::string text = trace.str();
+	size_t counterEvents = 0;
+	for (size_t i = text.find("\"ph\": \"C\""); i != std::string::npos; i = text.find("\"ph\": \"C\"", i + 1)) {
+		++counterEvents;
+	}
+	CHECK(counterEvents == 1);
+	CHECK(text.find("\"value\": 100020") != std::string::npos);
+
+	// the second thread starts after the first has exited, so it reuses its buffer
+	std::vector<Profiler::Zone> zones = profiler.zones();
+	REQUIRE(zones.size() == 2);
+	CHECK(zones[0].m_thread == zones[1].m_thread);
+	profiler.clear();
+}
@@ -1,38 +1,59 @@
 #include "../catch.hpp"
 
-#include <ctime>
+#include <chrono>
 
 #include "cartocrow/core/timer.h"
 
+namespace {
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+void busyWaitUntil(Clock::time_point start, double seconds) {
+	while (secondsSince(start) < seconds) {
+		// busy wait
+	}
+}
+} // namespace
+
+// The machine may be loaded while the tests run, so instead of comparing the
+// times with fixed values, we check that they lie between our own measurements
+// taken just before and just after the timer calls.
 TEST_CASE("Creating and using a timer") {
-	clock_t startTime = clock();
+	Clock::time_point beforeStart = Clock::now();
 	cartocrow::Timer timer;
+	Clock::time_point afterStart = Clock::now();
 	REQUIRE(timer.size() == 0);
 
-	while (double(clock() - startTime) / CLOCKS_PER_SEC < 0.01) {
-		// busy wait
-	}
+	busyWaitUntil(afterStart, 0.01);
 	timer.stamp("Test stamp");
+	double firstElapsed = secondsSince(beforeStart);
 	REQUIRE(timer.size() == 1);
 	CHECK(timer[0].first == "Test stamp");
-	CHECK(timer[0].second == Approx(0.01).epsilon(0.01));
+	CHECK(timer[0].second >= 0.01);
+	CHECK(timer[0].second <= firstElapsed);
 	double firstDuration = timer[0].second;
 
-	while (double(clock() - startTime) / CLOCKS_PER_SEC < 0.03) {
-		// busy wait
-	}
-	timer.stamp("Another test stamp");
+	Clock::time_point secondStart = Clock::now();
+	busyWaitUntil(secondStart, 0.02);
+	double secondDuration = timer.stamp("Another test stamp");
+	double secondElapsed = secondsSince(beforeStart);
 	REQUIRE(timer.size() == 2);
+	CHECK(secondDuration == timer[1].second);
 	CHECK(timer[0].first == "Test stamp");
 	CHECK(timer[0].second == firstDuration);
 	CHECK(timer[1].first == "Another test stamp");
-	CHECK(timer[1].second == Approx(0.02).epsilon(0.01));
+	CHECK(timer[1].second >= 0.02);
+	CHECK(firstDuration + secondDuration <= secondElapsed);
 
-	while (double(clock() - startTime) / CLOCKS_PER_SEC < 0.06) {
-		// busy wait
-	}
+	Clock::time_point thirdStart = Clock::now();
+	busyWaitUntil(thirdStart, 0.03);
+	double peek = timer.peek();
 	REQUIRE(timer.size() == 2);
-	CHECK(timer.peek() == Approx(0.03).epsilon(0.01));
+	CHECK(peek >= 0.03);
+	CHECK(timer.span() == Approx(firstDuration + secondDuration));
 
 	timer.reset();
 	REQUIRE(timer.size() == 0);
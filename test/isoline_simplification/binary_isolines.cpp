@@ -0,0 +1,133 @@
+#include "../catch.hpp"
+#include "cartocrow/isoline_simplification/binary_isolines.h"
+#include "cartocrow/isoline_simplification/ipe_isolines.h"
+#include "cartocrow/renderer/geometry_painting.h"
+#include "cartocrow/renderer/ipe_renderer.h"
+
+#include <filesystem>
+#include <fstream>
+
+using namespace cartocrow;
+using namespace cartocrow::isoline_simplification;
+
+namespace {
+/// Draws isolines as Ipe paths, in the form that \ref ipeToIsolines reads.
+class IsolinesPainting : public renderer::GeometryPainting {
+  public:
+	explicit IsolinesPainting(std::vector<Isoline<K>> isolines) : m_isolines(std::move(isolines)) {}
+	void paint(renderer::GeometryRenderer& renderer) const override {
+		for (const auto& isoline : m_isolines) {
+			if (isoline.m_closed) {
+				renderer.draw(isoline.polygon());
+			} else {
+				renderer.draw(isoline.polyline());
+			}
+		}
+	}
+
+  private:
+	std::vector<Isoline<K>> m_isolines;
+};
+
+/// Nested squares and open horizontal lines on a small grid.
+std::vector<Isoline<K>> gridIsolines() {
+	std::vector<Isoline<K>> isolines;
+	for (int i = 1; i <= 3; ++i) {
+		std::vector<Point<K>> square;
+		for (int x = -i; x < i; ++x) square.emplace_back(x, -i);
+		for (int y = -i; y < i; ++y) square.emplace_back(i, y);
+		for (int x = i; x > -i; --x) square.emplace_back(x, i);
+		for (int y = i; y > -i; --y) square.emplace_back(-i, y);
+		isolines.emplace_back(square, true);
+	}
+	for (int y = 5; y <= 6; ++y) {
+		std::vector<Point<K>> line;
+		for (int x = -4; x <= 4; ++x) {
+			line.emplace_back(x, y + 0.25 * (x % 2));
+		}
+		isolines.emplace_back(line, false);
+	}
+	return isolines;
+}
+
+void checkEqual(const std::vector<Isoline<K>>& actual, const std::vector<Isoline<K>>& expected) {
+	REQUIRE(actual.size() == expected.size());
+	for (size_t i = 0; i < actual.size(); ++i) {
+		CHECK(actual[i].m_closed == expected[i].m_closed);
+		CHECK(actual[i].m_points == expected[i].m_points);
+	}
+}
+} // namespace
+
+TEST_CASE("Reading binary isolines gives the same isolines as reading them from Ipe") {
+	std::vector<Isoline<K>> isolines = gridIsolines();
+	std::filesystem::path ipeFile = std::filesystem::temp_directory_path() / "grid_isolines.ipe";
+	renderer::IpeRenderer renderer(std::make_shared<IsolinesPainting>(isolines));
+	renderer.save(ipeFile);
+	std::vector<Isoline<K>> fromIpe = ipeToIsolines(ipeFile);
+	checkEqual(fromIpe, isolines);
+
+	std::filesystem::path binaryFile = std::filesystem::temp_directory_path() / "grid_isolines.isolines";
+	isolinesToBinary(fromIpe, binaryFile);
+	BinaryIsolineReader reader(binaryFile);
+	CHECK(reader.header().m_isolines == 5);
+	CHECK(reader.header().m_vertices == 8 + 16 + 24 + 9 + 9);
+	CHECK(reader.header().m_bbox == Box(-4, -3, 4, 6.25));
+	checkEqual(reader.readAll(), fromIpe);
+}
+
+TEST_CASE("Reading a binary isoline file with a corrupt vertex count") {
+	std::filesystem::path file = std::filesystem::temp_directory_path() / "corrupt.isolines";
+	isolinesToBinary(gridIsolines(), file);
+	// the vertex count of the first isoline directly follows the 56-byte header
+	{
+		std::fstream out(file, std::ios::binary | std::ios::in | std::ios::out);
+		out.seekp(56);
+		uint64_t huge = uint64_t(1) << 63;
+		out.write(reinterpret_cast<const char*>(&huge), sizeof(huge));
+	}
+	BinaryIsolineReader reader(file);
+	CHECK_THROWS_AS(reader.next(), std::runtime_error);
+}
+
+TEST_CASE("Reading a binary isoline file whose size does not match its header") {
+	std::filesystem::path file = std::filesystem::temp_directory_path() / "mismatched.isolines";
+
+	// a huge isoline count is rejected before anything is allocated for it
+	isolinesToBinary(gridIsolines(), file);
+	{
+		std::fstream out(file, std::ios::binary | std::ios::in | std::ios::out);
+		out.seekp(8);
+		uint64_t huge = uint64_t(1) << 62;
+		out.write(reinterpret_cast<const char*>(&huge), sizeof(huge));
+	}
+	CHECK_THROWS_AS(BinaryIsolineReader(file), std::runtime_error);
+
+	// a truncated file
+	isolinesToBinary(gridIsolines(), file);
+	std::filesystem::resize_file(file, std::filesystem::file_size(file) - 1);
+	CHECK_THROWS_AS(BinaryIsolineReader(file), std::runtime_error);
+
+	// trailing bytes after the last isoline
+	isolinesToBinary(gridIsolines(), file);
+	{
+		std::ofstream out(file, std::ios::binary | std::ios::app);
+		out.put(0);
+	}
+	CHECK_THROWS_AS(BinaryIsolineReader(file), std::runtime_error);
+}
+
+TEST_CASE("Reading a binary isoline file with fewer vertices than its header states") {
+	// Lower the vertex count of the first isoline by one. The file size still matches the header, but the isolines
+	// after the first one are read from the wrong offsets, which must be detected.
+	std::filesystem::path file = std::filesystem::temp_directory_path() / "short_isoline.isolines";
+	isolinesToBinary(gridIsolines(), file);
+	{
+		std::fstream out(file, std::ios::binary | std::ios::in | std::ios::out);
+		out.seekp(56);
+		uint64_t count = 7;
+		out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+	}
+	BinaryIsolineReader reader(file);
+	CHECK_THROWS_AS(reader.readAll(), std::runtime_error);
+}
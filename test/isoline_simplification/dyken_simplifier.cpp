@@ -0,0 +1,75 @@
+#include "../catch.hpp"
+#include "cartocrow/isoline_simplification/dyken_simplifier.h"
+
+#include <cmath>
+
+using namespace cartocrow;
+using namespace cartocrow::isoline_simplification;
+
+namespace {
+std::vector<Point<K>> points(const Isoline<K>& isoline) {
+	return std::vector<Point<K>>(isoline.m_points.begin(), isoline.m_points.end());
+}
+
+/// An open polyline with one vertex that hardly deviates from a straight line, and one sharp peak.
+Isoline<K> peak() {
+	return Isoline<K>({Point<K>(0, 0), Point<K>(1, 0.01), Point<K>(2, 0), Point<K>(3, 5), Point<K>(4, 0)}, false);
+}
+
+/// A closed wavy isoline, irregular enough that no two vertices are equally costly to remove.
+Isoline<K> wave() {
+	std::vector<Point<K>> points;
+	for (int i = 0; i < 40; ++i) {
+		double angle = 2 * M_PI * i / 40;
+		double radius = 20 + std::sin(4 * angle) + 0.3 * std::cos(7 * angle + 1);
+		points.emplace_back(radius * std::cos(angle), radius * std::sin(angle));
+	}
+	return Isoline<K>(points, true);
+}
+} // namespace
+
+TEST_CASE("Simplifying a small polyline with the Dyken simplifier") {
+	DykenSimplifier simplifier({peak()});
+	REQUIRE(simplifier.complexity() == 5);
+
+	// the nearly collinear vertex is the cheapest to remove
+	CHECK(simplifier.simplify(4) == 1);
+	CHECK(simplifier.complexity() == 4);
+	auto result = simplifier.isolines();
+	REQUIRE(result.size() == 1);
+	CHECK(!result[0].m_closed);
+	CHECK(points(result[0]) == std::vector<Point<K>>({Point<K>(0, 0), Point<K>(2, 0), Point<K>(3, 5), Point<K>(4, 0)}));
+
+	// targets at or above the current complexity do nothing
+	CHECK(simplifier.simplify(4) == 0);
+	CHECK(simplifier.simplify(10) == 0);
+
+	// resetting restores the input
+	simplifier.reset();
+	CHECK(simplifier.complexity() == 5);
+	CHECK(points(simplifier.isolines()[0]) == points(peak()));
+}
+
+TEST_CASE("Simplifying to several targets continues from the previous result") {
+	DykenSimplifier simplifier({wave(), peak()});
+	REQUIRE(simplifier.complexity() == 45);
+
+	// the targets are simplified to in decreasing order, but returned in the given order
+	std::vector<int> targets({20, 35, 10});
+	auto results = simplifier.simplify(targets);
+	REQUIRE(results.size() == targets.size());
+	for (int i = 0; i < targets.size(); ++i) {
+		DykenSimplifier separate({wave(), peak()});
+		separate.simplify(targets[i]);
+		auto expected = separate.isolines();
+		REQUIRE(results[i].size() == expected.size());
+		int complexity = 0;
+		for (int j = 0; j < expected.size(); ++j) {
+			CHECK(results[i][j].m_closed == expected[j].m_closed);
+			CHECK(points(results[i][j]) == points(expected[j]));
+			complexity += results[i][j].m_points.size();
+		}
+		CHECK(complexity == separate.complexity());
+	}
+	CHECK(simplifier.complexity() <= 10);
+}
@@ -0,0 +1,84 @@
+#include "../catch.hpp"
+#include "cartocrow/isoline_simplification/isoline_simplifier.h"
+
+#include <cmath>
+
+using namespace cartocrow;
+using namespace cartocrow::isoline_simplification;
+
+namespace {
+/// Nested wavy closed isolines, so that there are slope ladders spanning several isolines.
+std::vector<Isoline<K>> wavyIsolines() {
+	std::vector<Isoline<K>> isolines;
+	for (int level = 1; level <= 3; ++level) {
+		std::vector<Point<K>> points;
+		for (int i = 0; i < 60; ++i) {
+			double angle = 2 * M_PI * i / 60;
+			double radius = 10 * level + 2 * std::sin(5 * angle) + 0.5 * std::cos(13 * angle + level);
+			points.emplace_back(radius * std::cos(angle), radius * std::sin(angle));
+		}
+		isolines.emplace_back(points, true);
+	}
+	return isolines;
+}
+
+std::vector<std::vector<Point<K>>> simplified(int batchSize, int threads) {
+	IsolineSimplifier simplifier(wavyIsolines());
+	simplifier.set_batch_size(batchSize, threads);
+	simplifier.simplify(90);
+	std::vector<std::vector<Point<K>>> result;
+	for (const auto& isoline : simplifier.m_simplified_isolines) {
+		result.emplace_back(isoline.m_points.begin(), isoline.m_points.end());
+	}
+	return result;
+}
+} // namespace
+
+TEST_CASE("Validating slope ladders in batches gives the same simplification as validating them one by one") {
+	auto serial = simplified(1, 1);
+	CHECK(serial == simplified(8, 4));
+	CHECK(serial == simplified(8, 1));
+}
+
+TEST_CASE("The incremental metrics agree with the measures computed from scratch") {
+	IsolineSimplifier simplifier(wavyIsolines());
+	REQUIRE(simplifier.m_metrics_history.size() == 1);
+	CHECK(simplifier.m_metrics_history[0].m_complexity == 180);
+	CHECK(simplifier.m_metrics_history[0].m_symmetric_difference == 0);
+
+	for (int steps = 1; steps <= 10; ++steps) {
+		REQUIRE(simplifier.step());
+		simplifier.update_matching();
+		simplifier.update_ladders();
+		// update_matching() completes the entry recorded by step(), but does not add one
+		simplifier.update_matching();
+		REQUIRE(simplifier.m_metrics_history.size() == steps + 1);
+
+		SimplificationMetrics metrics = simplifier.metrics();
+		const SimplificationMetrics& recorded = simplifier.m_metrics_history.back();
+		CHECK(recorded.m_complexity == metrics.m_complexity);
+		CHECK(recorded.m_symmetric_difference == metrics.m_symmetric_difference);
+		CHECK(recorded.m_average_alignment == metrics.m_average_alignment);
+		CHECK(recorded.m_max_alignment == metrics.m_max_alignment);
+
+		auto [average, max] = simplifier.average_max_vertex_alignment();
+		CHECK(metrics.m_average_alignment == Approx(average));
+		CHECK(metrics.m_max_alignment == Approx(max));
+
+		// the rungs of the first ladder lie on different isolines, so their collapses do not overlap
+		double total = simplifier.total_symmetric_difference();
+		if (steps == 1) {
+			CHECK(metrics.m_symmetric_difference == Approx(total));
+		} else {
+			CHECK(metrics.m_symmetric_difference >= Approx(total));
+		}
+	}
+
+	// recomputing the ladders starts the metrics anew from the current simplification
+	int complexity = simplifier.metrics().m_complexity;
+	simplifier.ladder_count();
+	REQUIRE(simplifier.m_metrics_history.size() == 1);
+	CHECK(simplifier.metrics().m_complexity == complexity);
+	CHECK(simplifier.metrics().m_symmetric_difference == 0);
+	CHECK(simplifier.metrics().m_max_collapse_symmetric_difference == 0);
+}
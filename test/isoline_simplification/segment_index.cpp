@@ -0,0 +1,72 @@
+#include "../catch.hpp"
+#include "cartocrow/isoline_simplification/segment_index.h"
+
+#include <algorithm>
+#include <random>
+
+using namespace cartocrow;
+using namespace cartocrow::isoline_simplification;
+
+namespace {
+/// Returns the segments whose bounding box intersects the bounding box of \c seg, by checking all of them.
+std::vector<Segment<K>> nearbyBruteForce(const std::vector<Segment<K>>& segments, const Segment<K>& seg) {
+	std::vector<Segment<K>> result;
+	for (const auto& s : segments) {
+		if (CGAL::do_overlap(s.bbox(), seg.bbox())) {
+			result.push_back(s);
+		}
+	}
+	return result;
+}
+
+Segment<K> randomSegment(std::mt19937& random) {
+	std::uniform_real_distribution<double> position(0, 100);
+	std::uniform_real_distribution<double> offset(-5, 5);
+	Point<K> source(position(random), position(random));
+	return Segment<K>(source, source + Vector<K>(offset(random), offset(random)));
+}
+} // namespace
+
+TEST_CASE("Querying a segment index gives the same segments as brute force") {
+	std::mt19937 random(42);
+	std::vector<Segment<K>> segments;
+	for (int i = 0; i < 500; ++i) {
+		segments.push_back(randomSegment(random));
+	}
+	SegmentIndex index;
+	index.assign(segments);
+	REQUIRE(index.size() == segments.size());
+
+	auto checkQueries = [&]() {
+		for (int i = 0; i < 100; ++i) {
+			Segment<K> query = randomSegment(random);
+			auto expected = nearbyBruteForce(segments, query);
+			auto found = index.nearby(query);
+			CHECK(found.size() == expected.size());
+			CHECK(std::is_permutation(found.begin(), found.end(), expected.begin(), expected.end()));
+		}
+	};
+	checkQueries();
+
+	SECTION("after inserting and removing segments") {
+		for (int i = 0; i < 200; ++i) {
+			CHECK(index.remove(segments.back()));
+			segments.pop_back();
+		}
+		for (int i = 0; i < 100; ++i) {
+			segments.push_back(randomSegment(random));
+			index.insert(segments.back());
+		}
+		REQUIRE(index.size() == segments.size());
+		checkQueries();
+	}
+
+	SECTION("removing a segment that is not present") {
+		const Segment<K>& s = segments.front();
+		CHECK(!index.remove(s.opposite()));
+		CHECK(index.size() == segments.size());
+		CHECK(index.remove(s));
+		CHECK(!index.remove(s));
+		CHECK(index.size() == segments.size() - 1);
+	}
+}
@@ -1,7 +1,8 @@
 #include "../catch.hpp"
 
+#include "cartocrow/core/circular_arc.h"
 #include "cartocrow/core/ipe_reader.h"
-#include "cartocrow/renderer/geometry_painting.h"
+#include "cartocrow/renderer/function_painting.h"
 #include "cartocrow/renderer/ipe_renderer.h"
 
 #include <ipeattributes.h>
@@ -9,8 +10,53 @@
 #include <ipeshape.h>
 
 #include <filesystem>
+#include <functional>
+#include <fstream>
+#include <sstream>
 
 using namespace cartocrow;
+using renderer::FunctionPainting;
+
+namespace {
+/// Saves the renderer's output to Ipe and returns the contents of the file.
+std::string ipeOutput(renderer::IpeRenderer& renderer) {
+	std::filesystem::path path = std::filesystem::temp_directory_path() / "test.ipe";
+	renderer.save(path);
+	std::ifstream file(path);
+	std::stringstream contents;
+	contents << file.rdbuf();
+	return contents.str();
+}
+
+/// Saves the painting to Ipe and returns the contents of the file.
+std::string ipeOutput(const std::shared_ptr<renderer::GeometryPainting>& painting) {
+	renderer::IpeRenderer renderer(painting);
+	return ipeOutput(renderer);
+}
+
+/// Returns the part of the Ipe output that depends on what was painted: the
+/// alpha values style sheet and the page.
+std::string ipePage(renderer::IpeRenderer& renderer) {
+	std::string output = ipeOutput(renderer);
+	return output.substr(output.find("<ipestyle name=\"alpha-values\">"));
+}
+
+std::string ipePage(std::function<void(renderer::GeometryRenderer&)> paint) {
+	renderer::IpeRenderer renderer(std::make_shared<FunctionPainting>(paint));
+	return ipePage(renderer);
+}
+
+/// The output of a painting on one layer with only the default opacity.
+std::string singleLayerPage(const std::string& objects) {
+	return "<ipestyle name=\"alpha-values\">\n"
+	       "<opacity name=\"255\" value=\"1.000\"/>\n"
+	       "</ipestyle>\n"
+	       "<page>\n"
+	       "<layer name=\"layer1\"/>\n"
+	       "<view layers=\"layer1\" active=\"layer1\"/>\n" +
+	       objects + "</page>\n</ipe>\n";
+}
+} // namespace
 
 TEST_CASE("Exporting marks to Ipe") {
 	class TestPainting : public renderer::GeometryPainting {
@@ -93,3 +139,152 @@ TEST_CASE("Exporting a label to Ipe") {
 	REQUIRE(ipeText->verticalAlignment() == ipe::TVerticalAlignment::EAlignVCenter);
 	REQUIRE(ipeText->text().z() == expectedText);
 }
+
+TEST_CASE("Batched drawing in Ipe looks the same as drawing one by one") {
+	auto setStyle = [](renderer::GeometryRenderer& renderer) {
+		renderer.setMode(renderer::GeometryRenderer::stroke | renderer::GeometryRenderer::vertices);
+		renderer.setStroke(Color{10, 20, 30}, 2);
+		renderer.setFill(Color{200, 100, 0});
+	};
+	std::vector<Point<Inexact>> points{{0, 0}, {2, 1}, {3.5, -1}};
+
+	SECTION("points") {
+		std::string batched = ipeOutput(std::make_shared<FunctionPainting>([&](auto& renderer) {
+			setStyle(renderer);
+			renderer.drawPoints(points);
+		}));
+		std::string single = ipeOutput(std::make_shared<FunctionPainting>([&](auto& renderer) {
+			setStyle(renderer);
+			for (const Point<Inexact>& p : points) {
+				renderer.draw(p);
+			}
+		}));
+		CHECK(batched == single);
+	}
+
+	SECTION("vertices of segments") {
+		std::vector<Segment<Inexact>> segments{{points[0], points[1]}, {points[1], points[2]}};
+		std::string batched = ipeOutput(std::make_shared<FunctionPainting>([&](auto& renderer) {
+			setStyle(renderer);
+			renderer.drawSegments(segments);
+		}));
+		CHECK(batched.find("<use stroke=\"0.0392 0.0784 0.118\" name=\"mark/fdisk(sfx)\" pos=\"3.5 -1\" "
+		                   "fill=\"0.784 0.392 0\"/>") != std::string::npos);
+		std::string single = ipeOutput(std::make_shared<FunctionPainting>([&](auto& renderer) {
+			setStyle(renderer);
+			renderer.setMode(renderer::GeometryRenderer::stroke);
+			renderer.drawSegments(segments);
+			renderer.setMode(renderer::GeometryRenderer::stroke | renderer::GeometryRenderer::vertices);
+			for (const Point<Inexact>& p : {points[0], points[1], points[1], points[2]}) {
+				renderer.draw(p);
+			}
+		}));
+		CHECK(batched == single);
+	}
+}
+
+TEST_CASE("Ipe output of filled polygons") {
+	auto fill = [](renderer::GeometryRenderer& renderer) {
+		renderer.setMode(renderer::GeometryRenderer::stroke | renderer::GeometryRenderer::fill);
+		renderer.setFill(Color{255, 0, 0});
+	};
+	Polygon<Inexact> square;
+	for (const Point<Inexact>& p : {Point<Inexact>(0, 0), Point<Inexact>(4, 0), Point<Inexact>(4, 4), Point<Inexact>(0, 4)}) {
+		square.push_back(p);
+	}
+
+	SECTION("without holes") {
+		CHECK(ipePage([&](auto& renderer) {
+			      fill(renderer);
+			      renderer.draw(square);
+		      }) == singleLayerPage("<path layer=\"layer1\" stroke=\"0 0 0\" fill=\"1 0 0\" pen=\"1\" opacity=\"255\">\n"
+		                            "0 0 m\n4 0 l\n4 4 l\n0 4 l\nh\n"
+		                            "</path>\n"));
+	}
+
+	SECTION("with a hole") {
+		Polygon<Inexact> hole;
+		for (const Point<Inexact>& p : {Point<Inexact>(1, 1), Point<Inexact>(1, 3), Point<Inexact>(3, 3), Point<Inexact>(3, 1)}) {
+			hole.push_back(p);
+		}
+		PolygonWithHoles<Inexact> withHole(square);
+		withHole.add_hole(hole);
+		CHECK(ipePage([&](auto& renderer) {
+			      fill(renderer);
+			      renderer.draw(withHole);
+		      }) == singleLayerPage("<path layer=\"layer1\" stroke=\"0 0 0\" fill=\"1 0 0\" pen=\"1\" opacity=\"255\">\n"
+		                            "0 0 m\n4 0 l\n4 4 l\n0 4 l\nh\n"
+		                            "1 1 m\n1 3 l\n3 3 l\n3 1 l\nh\n"
+		                            "</path>\n"));
+	}
+}
+
+TEST_CASE("Ipe output of circles and circular arcs") {
+	SECTION("circle") {
+		CHECK(ipePage([](auto& renderer) {
+			      renderer.draw(Circle<Inexact>(Point<Inexact>(5, 6), 4));
+		      }) == singleLayerPage("<path layer=\"layer1\" stroke=\"0 0 0\" pen=\"1\" opacity=\"255\">\n"
+		                            "2 0 0 2 5 6 e\n"
+		                            "</path>\n"));
+	}
+
+	Circle<Inexact> circle(Point<Inexact>(10, 10), 4);
+	SECTION("counter-clockwise arc") {
+		CHECK(ipePage([&](auto& renderer) {
+			      renderer.draw(CircularArc(circle, 0, M_PI / 2));
+		      }) == singleLayerPage("<path layer=\"layer1\" stroke=\"0 0 0\" pen=\"1\" opacity=\"255\">\n"
+		                            "12 10 m\n2 0 0 2 10 10 10 12 a\n"
+		                            "</path>\n"));
+	}
+
+	SECTION("clockwise arc") {
+		CHECK(ipePage([&](auto& renderer) {
+			      renderer.draw(CircularArc(circle, 0, -M_PI / 2));
+		      }) == singleLayerPage("<path layer=\"layer1\" stroke=\"0 0 0\" pen=\"1\" opacity=\"255\">\n"
+		                            "12 10 m\n2 0 0 -2 10 10 10 8 a\n"
+		                            "</path>\n"));
+	}
+
+	SECTION("full circle arc") {
+		CHECK(ipePage([&](auto& renderer) {
+			      renderer.draw(CircularArc(circle, 1, 2 * M_PI));
+		      }) == singleLayerPage("<path layer=\"layer1\" stroke=\"0 0 0\" pen=\"1\" opacity=\"255\">\n"
+		                            "2 0 0 2 10 10 e\n"
+		                            "</path>\n"));
+	}
+}
+
+TEST_CASE("Ipe output of layers and opacities") {
+	renderer::IpeRenderer renderer(std::make_shared<FunctionPainting>([](auto& renderer) {
+		renderer.draw(Point<Inexact>(1, 2));
+		renderer.draw(Point<Inexact>(3, 4));
+	}), "points");
+	renderer.addPainting(std::make_shared<FunctionPainting>([](auto& renderer) {
+		renderer.setMode(renderer::GeometryRenderer::fill);
+		renderer.setFillOpacity(128);
+		renderer.draw(Circle<Inexact>(Point<Inexact>(0, 0), 1));
+	}), "translucent disk");
+	CHECK(ipePage(renderer) ==
+	      "<ipestyle name=\"alpha-values\">\n"
+	      "<opacity name=\"128\" value=\"0.502\"/>\n"
+	      "<opacity name=\"255\" value=\"1.000\"/>\n"
+	      "</ipestyle>\n"
+	      "<page>\n"
+	      "<layer name=\"points\"/>\n"
+	      "<layer name=\"translucent_disk\"/>\n"
+	      "<view layers=\"points translucent_disk\" active=\"points\"/>\n"
+	      "<use layer=\"points\" stroke=\"0 0 0\" name=\"mark/fdisk(sfx)\" pos=\"1 2\" fill=\"0 0.4 0.796\"/>\n"
+	      "<use stroke=\"0 0 0\" name=\"mark/fdisk(sfx)\" pos=\"3 4\" fill=\"0 0.4 0.796\"/>\n"
+	      "<path layer=\"translucent_disk\" fill=\"0 0.4 0.796\" pen=\"1\" opacity=\"128\">\n"
+	      "1 0 0 1 0 0 e\n"
+	      "</path>\n"
+	      "</page>\n"
+	      "</ipe>\n");
+}
+
+TEST_CASE("Ipe output does not use exponents") {
+	std::string page = ipePage([](auto& renderer) {
+		renderer.draw(Segment<Inexact>(Point<Inexact>(1e-7, 0), Point<Inexact>(2.5e8, -3e-12)));
+	});
+	CHECK(page.find("0.0000001 0 m\n250000000 -0.000000000003 l\n") != std::string::npos);
+}
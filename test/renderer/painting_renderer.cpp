@@ -0,0 +1,171 @@
+#include "../catch.hpp"
+
+#include "cartocrow/core/circular_arc.h"
+#include "cartocrow/renderer/ipe_renderer.h"
+#include "cartocrow/renderer/painting_renderer.h"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+using namespace cartocrow;
+using namespace cartocrow::renderer;
+
+namespace {
+std::string fileContents(const std::filesystem::path& path) {
+	std::ifstream file(path, std::ios::binary);
+	std::stringstream contents;
+	contents << file.rdbuf();
+	return contents.str();
+}
+
+void writeFile(const std::filesystem::path& path, const std::string& contents) {
+	std::ofstream file(path, std::ios::binary);
+	file << contents;
+}
+
+/// Renders the painting to Ipe and returns the contents of the file.
+std::string ipeOutput(const std::shared_ptr<GeometryPainting>& painting) {
+	IpeRenderer renderer(painting);
+	std::filesystem::path path = std::filesystem::temp_directory_path() / "painting_renderer.ipe";
+	renderer.save(path);
+	return fileContents(path);
+}
+} // namespace
+
+TEST_CASE("Saving and loading a recorded painting") {
+	auto painting = std::make_shared<PaintingRenderer>();
+	painting->setMode(GeometryRenderer::stroke | GeometryRenderer::fill);
+	painting->setStroke(Color{10, 20, 30}, 1.5);
+	painting->setFill(Color{200, 100, 0});
+	painting->setFillOpacity(100);
+	painting->draw(Point<Inexact>(1, 2));
+	painting->draw(Segment<Inexact>(Point<Inexact>(0, 0), Point<Inexact>(3, 4)));
+	painting->pushStyle();
+	painting->setStrokeOpacity(50);
+	Polygon<Inexact> triangle;
+	triangle.push_back(Point<Inexact>(0, 0));
+	triangle.push_back(Point<Inexact>(4, 0));
+	triangle.push_back(Point<Inexact>(0, 4));
+	PolygonWithHoles<Inexact> withHole(triangle);
+	Polygon<Inexact> hole;
+	hole.push_back(Point<Inexact>(1, 1));
+	hole.push_back(Point<Inexact>(1, 2));
+	hole.push_back(Point<Inexact>(2, 1));
+	withHole.add_hole(hole);
+	painting->draw(withHole);
+	painting->popStyle();
+	painting->draw(Circle<Inexact>(Point<Inexact>(5, 5), 4));
+	painting->draw(CircularArc(Circle<Inexact>(Point<Inexact>(5, 5), 4), 0.5, -1));
+	painting->drawText(Point<Inexact>(2, 2), "label");
+	painting->drawText(Point<Inexact>(3, 3), "");
+
+	std::filesystem::path path = std::filesystem::temp_directory_path() / "painting_renderer.bin";
+	painting->save(path);
+	std::string saved = fileContents(path);
+
+	SECTION("round trip") {
+		auto loaded = PaintingRenderer::load(path);
+		CHECK(loaded->commandCount() == painting->commandCount());
+		CHECK(ipeOutput(loaded) == ipeOutput(painting));
+		loaded->save(path);
+		CHECK(fileContents(path) == saved);
+	}
+
+	SECTION("truncated file") {
+		for (size_t size : {size_t(0), size_t(6), size_t(20), saved.size() / 2, saved.size() - 1}) {
+			writeFile(path, saved.substr(0, size));
+			CHECK_THROWS_AS(PaintingRenderer::load(path), std::runtime_error);
+		}
+	}
+
+	SECTION("counts larger than the file") {
+		// the command, coordinate and text counts follow the magic and the version
+		for (size_t offset : {size_t(8), size_t(16), size_t(24)}) {
+			std::string corrupt = saved;
+			uint64_t huge = uint64_t(1) << 60;
+			corrupt.replace(offset, sizeof(huge), reinterpret_cast<const char*>(&huge), sizeof(huge));
+			writeFile(path, corrupt);
+			CHECK_THROWS_AS(PaintingRenderer::load(path), std::runtime_error);
+		}
+	}
+
+	SECTION("text length larger than the file") {
+		// the length of the last text (which is empty) is the last field of the file
+		std::string corrupt = saved;
+		uint64_t huge = uint64_t(1) << 60;
+		corrupt.replace(corrupt.size() - sizeof(huge), sizeof(huge), reinterpret_cast<const char*>(&huge),
+		                sizeof(huge));
+		writeFile(path, corrupt);
+		CHECK_THROWS_AS(PaintingRenderer::load(path), std::runtime_error);
+	}
+}
+
+TEST_CASE("Unbalanced style commands in a painting file") {
+	// the file contains three commands: a push, a point and a pop
+	auto painting = std::make_shared<PaintingRenderer>();
+	painting->pushStyle();
+	painting->draw(Point<Inexact>(1, 2));
+	painting->popStyle();
+	std::filesystem::path path = std::filesystem::temp_directory_path() / "painting_renderer_styles.bin";
+	painting->save(path);
+	std::string saved = fileContents(path);
+	// the commands follow the magic, the version and the three counts, and
+	// each starts with its opcode
+	const size_t pushOpcode = 32;
+	const size_t popOpcode = pushOpcode + 2 * 9;
+	REQUIRE(saved.size() > popOpcode);
+
+	SECTION("pop without a push") {
+		std::string corrupt = saved;
+		corrupt[pushOpcode] = saved[popOpcode];
+		writeFile(path, corrupt);
+		CHECK_THROWS_AS(PaintingRenderer::load(path), std::runtime_error);
+	}
+
+	SECTION("push without a pop") {
+		std::string corrupt = saved;
+		corrupt[popOpcode] = saved[pushOpcode];
+		writeFile(path, corrupt);
+		CHECK_THROWS_AS(PaintingRenderer::load(path), std::runtime_error);
+	}
+
+	SECTION("unbalanced recording") {
+		// a stray pop is ignored, and a push that is left open is closed on saving
+		auto unbalanced = std::make_shared<PaintingRenderer>();
+		unbalanced->popStyle();
+		unbalanced->pushStyle();
+		unbalanced->draw(Point<Inexact>(1, 2));
+		unbalanced->save(path);
+		CHECK(fileContents(path) == saved);
+	}
+}
+
+TEST_CASE("Replaying a painting does not inherit the style of the renderer") {
+	Polygon<Inexact> triangle;
+	triangle.push_back(Point<Inexact>(0, 0));
+	triangle.push_back(Point<Inexact>(4, 0));
+	triangle.push_back(Point<Inexact>(0, 4));
+
+	auto inner = std::make_shared<PaintingRenderer>();
+	inner->setFill(Color{0, 0, 255});
+	inner->draw(triangle);
+
+	// replay the inner painting after changing the mode and the stroke
+	auto outer = std::make_shared<PaintingRenderer>();
+	outer->setStroke(Color{255, 0, 0}, 5);
+	outer->setMode(GeometryRenderer::fill);
+	inner->paint(*outer);
+
+	// the triangle is drawn with the default mode and stroke of the inner
+	// painting, not with the ones set before it
+	auto expected = std::make_shared<PaintingRenderer>();
+	expected->setStroke(Color{255, 0, 0}, 5);
+	expected->setMode(GeometryRenderer::fill);
+	expected->setMode(GeometryRenderer::stroke);
+	expected->setStroke(Color{0, 0, 0}, 1);
+	expected->setFill(Color{0, 0, 255});
+	expected->draw(triangle);
+
+	CHECK(ipeOutput(outer) == ipeOutput(expected));
+}
@@ -0,0 +1,113 @@
+#include "../catch.hpp"
+
+#include "cartocrow/renderer/function_painting.h"
+#include "cartocrow/renderer/painter_path.h"
+#include "cartocrow/renderer/retained_scene.h"
+
+#include <QImage>
+#include <QPainter>
+
+using namespace cartocrow;
+using namespace cartocrow::renderer;
+
+namespace {
+/// 10 pixels per unit, with the y-axis pointing up, so that [0, 10] × [0, 10] covers a 100 × 100 image.
+const QTransform transform(10, 0, 0, -10, 0, 100);
+
+/// Returns an empty 100 × 100 image, painted by \c paint.
+template <class Paint> QImage render(Paint paint) {
+	QImage image(100, 100, QImage::Format_ARGB32_Premultiplied);
+	image.fill(Qt::transparent);
+	QPainter painter(&image);
+	painter.setRenderHint(QPainter::Antialiasing);
+	paint(painter);
+	painter.end();
+	return image;
+}
+
+Polygon<Inexact> square(double x, double y, double size) {
+	Polygon<Inexact> square;
+	square.push_back(Point<Inexact>(x, y));
+	square.push_back(Point<Inexact>(x + size, y));
+	square.push_back(Point<Inexact>(x + size, y + size));
+	square.push_back(Point<Inexact>(x, y + size));
+	return square;
+}
+
+/// Returns the pen that paints strokes of the given color and width in pixels.
+QPen pen(const QColor& color, double width) {
+	QPen pen(color, width, Qt::SolidLine, Qt::FlatCap, Qt::RoundJoin);
+	pen.setCosmetic(true);
+	return pen;
+}
+
+/// Draws two filled squares and a thick line just above [0, 10] × [0, 10], whose stroke reaches into it. The line
+/// is drawn with a pushed style, so the second square is drawn with the style of the first.
+void paintObjects(GeometryRenderer& renderer) {
+	renderer.setMode(GeometryRenderer::fill | GeometryRenderer::stroke);
+	renderer.setStroke(Color{0, 0, 0}, 2);
+	renderer.setFill(Color{255, 0, 0});
+	renderer.draw(square(2, 2, 2));
+	renderer.pushStyle();
+	renderer.setMode(GeometryRenderer::stroke);
+	renderer.setStroke(Color{0, 0, 255}, 20);
+	renderer.draw(Segment<Inexact>(Point<Inexact>(-5, 10.5), Point<Inexact>(15, 10.5)));
+	renderer.popStyle();
+	renderer.draw(square(20, 20, 2));
+	renderer.draw(square(7, 6, 2));
+}
+
+/// Draws the objects of \ref paintObjects directly with a QPainter.
+void paintDirectly(QPainter& painter) {
+	painter.setTransform(transform);
+	auto drawSquare = [&painter](const Polygon<Inexact>& polygon) {
+		QPainterPath path;
+		addPolygonToPath(path, polygon);
+		painter.setPen(pen(Qt::black, 2));
+		painter.setBrush(QColor(255, 0, 0));
+		painter.drawPath(path);
+	};
+	drawSquare(square(2, 2, 2));
+	QPainterPath line;
+	line.moveTo(-5, 10.5);
+	line.lineTo(15, 10.5);
+	painter.setPen(pen(QColor(0, 0, 255), 20));
+	painter.setBrush(Qt::NoBrush);
+	painter.drawPath(line);
+	drawSquare(square(20, 20, 2));
+	drawSquare(square(7, 6, 2));
+}
+} // namespace
+
+TEST_CASE("Painting a retained scene") {
+	FunctionPainting painting(paintObjects);
+	RetainedScene scene(painting, GeometryWidgetStyle());
+	REQUIRE(scene.size() == 4);
+
+	QImage direct = render(paintDirectly);
+	QImage retained = render([&scene](QPainter& painter) {
+		scene.paint(painter, transform, Box(0, 0, 10, 10));
+	});
+	// the line is outside the viewport but its stroke is not, so it must not be culled
+	CHECK(qBlue(direct.pixel(50, 2)) == 255);
+	CHECK(retained == direct);
+
+	SECTION("objects outside the viewport are culled") {
+		// only the left half of the drawing is visible; the viewport is extended by the largest stroke padding of
+		// 11 pixels, which does not reach the last square
+		QImage left = render([&scene](QPainter& painter) {
+			scene.paint(painter, transform, Box(0, 0, 5, 10));
+		});
+		CHECK(qRed(direct.pixel(80, 30)) == 255);
+		CHECK(qAlpha(left.pixel(80, 30)) == 0);
+		CHECK(left.pixel(30, 70) == direct.pixel(30, 70));
+		CHECK(left.pixel(30, 2) == direct.pixel(30, 2));
+	}
+
+	SECTION("drawing copies of the paths gives the same image") {
+		QImage copied = render([&scene](QPainter& painter) {
+			scene.paint(painter, transform, Box(0, 0, 10, 10), true);
+		});
+		CHECK(copied == direct);
+	}
+}
@@ -0,0 +1,167 @@
+#include "../catch.hpp"
+
+#include "cartocrow/renderer/function_painting.h"
+#include "cartocrow/renderer/svg_renderer.h"
+
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <sstream>
+
+using namespace cartocrow;
+using namespace cartocrow::renderer;
+
+namespace {
+std::string fileContents(const std::filesystem::path& path) {
+	std::ifstream file(path, std::ios::binary);
+	std::stringstream contents;
+	contents << file.rdbuf();
+	return contents.str();
+}
+
+/// Saves the renderer's output to SVG and returns the contents of the file.
+std::string svgOutput(SvgRenderer& renderer) {
+	std::filesystem::path path = std::filesystem::temp_directory_path() / "test.svg";
+	renderer.save(path);
+	return fileContents(path);
+}
+
+std::string svgOutput(std::function<void(GeometryRenderer&)> paint) {
+	SvgRenderer renderer(std::make_shared<FunctionPainting>(paint));
+	return svgOutput(renderer);
+}
+
+/// The output of one unnamed layer with the given elements and style classes.
+std::string svgDocument(const std::string& elements, const std::string& classes) {
+	return "<svg version=\"1.1\" xmlns=\"http://www.w3.org/2000/svg\" "
+	       "xmlns:xlink=\"http://www.w3.org/1999/xlink\" "
+	       "xmlns:inkscape=\"http://www.inkscape.org/namespaces/inkscape\">\n"
+	       "<defs><circle id=\"vertex\" cx=\"0\" cy=\"0\" r=\"4\"/></defs>\n"
+	       "<g inkscape:groupmode=\"layer\">\n" +
+	       elements + "</g>\n<style>\n" + classes + "</style>\n</svg>\n";
+}
+
+const std::string STROKE_CLASS = "{fill:none;stroke:#000000;stroke-width:1;stroke-linecap:round;stroke-linejoin:round;}\n";
+
+Polygon<Inexact> square(double x, double y, double size) {
+	Polygon<Inexact> result;
+	result.push_back(Point<Inexact>(x, y));
+	result.push_back(Point<Inexact>(x + size, y));
+	result.push_back(Point<Inexact>(x + size, y + size));
+	result.push_back(Point<Inexact>(x, y + size));
+	return result;
+}
+} // namespace
+
+TEST_CASE("SVG output of shapes") {
+	SECTION("polygon") {
+		CHECK(svgOutput([](GeometryRenderer& renderer) {
+			      renderer.setMode(GeometryRenderer::fill | GeometryRenderer::stroke);
+			      renderer.setFill(Color{255, 0, 0});
+			      renderer.draw(square(0, 0, 4));
+		      }) == svgDocument("<path class=\"s0\" d=\"M0 0L4 0 4 -4 0 -4Z\"/>\n",
+		                        ".s0{fill:#ff0000;stroke:#000000;stroke-width:1;stroke-linecap:round;"
+		                        "stroke-linejoin:round;}\n"));
+	}
+
+	SECTION("polygon with a hole") {
+		PolygonWithHoles<Inexact> withHole(square(0, 0, 4));
+		Polygon<Inexact> hole = square(1, 1, 2);
+		hole.reverse_orientation();
+		withHole.add_hole(hole);
+		CHECK(svgOutput([&](GeometryRenderer& renderer) {
+			      renderer.draw(withHole);
+		      }) == svgDocument("<path class=\"s0\" d=\"M0 0L4 0 4 -4 0 -4ZM1 -1L1 -3 3 -3 3 -1Z\"/>\n",
+		                        ".s0" + STROKE_CLASS));
+	}
+
+	SECTION("circle") {
+		CHECK(svgOutput([](GeometryRenderer& renderer) {
+			      renderer.draw(Circle<Inexact>(Point<Inexact>(5, 6), 4));
+		      }) == svgDocument("<circle class=\"s0\" r=\"2\" cx=\"5\" cy=\"-6\"/>\n", ".s0" + STROKE_CLASS));
+	}
+
+	SECTION("point") {
+		CHECK(svgOutput([](GeometryRenderer& renderer) {
+			      renderer.setStroke(Color{0, 0, 255}, 1);
+			      renderer.draw(Point<Inexact>(1, 2));
+		      }) == svgDocument("<use xlink:href=\"#vertex\" class=\"s0\" x=\"1\" y=\"-2\"/>\n",
+		                        ".s0{fill:#0000ff;}\n"));
+	}
+
+	SECTION("text") {
+		CHECK(svgOutput([](GeometryRenderer& renderer) {
+			      renderer.drawText(Point<Inexact>(1, 2), "a < b & \"c\"");
+		      }) == svgDocument("<text text-anchor=\"middle\" dominant-baseline=\"middle\" x=\"1\" y=\"-2\">"
+		                        "a &lt; b &amp; &quot;c&quot;</text>\n",
+		                        ""));
+	}
+}
+
+TEST_CASE("SVG output shares style classes between elements") {
+	CHECK(svgOutput([](GeometryRenderer& renderer) {
+		      renderer.setMode(GeometryRenderer::fill);
+		      renderer.draw(square(0, 0, 1));
+		      renderer.setFill(Color{255, 255, 0});
+		      renderer.setFillOpacity(128);
+		      renderer.draw(square(2, 0, 1));
+		      renderer.setFill(Color{0, 102, 203});
+		      renderer.setFillOpacity(255);
+		      renderer.draw(square(4, 0, 1));
+	      }) == svgDocument("<path class=\"s0\" d=\"M0 0L1 0 1 -1 0 -1Z\"/>\n"
+	                        "<path class=\"s1\" d=\"M2 0L3 0 3 -1 2 -1Z\"/>\n"
+	                        "<path class=\"s0\" d=\"M4 0L5 0 5 -1 4 -1Z\"/>\n",
+	                        ".s0{fill:#0066cb;}\n"
+	                        ".s1{fill:#ffff00;fill-opacity:0.502;}\n"));
+}
+
+TEST_CASE("SVG output with named layers and a lower precision") {
+	SvgRenderer renderer(std::make_shared<FunctionPainting>([](GeometryRenderer& renderer) {
+		renderer.draw(Segment<Inexact>(Point<Inexact>(1.23456, 0), Point<Inexact>(0, 2.5)));
+	}), "first");
+	renderer.addPainting(std::make_shared<FunctionPainting>([](GeometryRenderer& renderer) {}), "second layer");
+	renderer.setPrecision(3);
+	CHECK(svgOutput(renderer) ==
+	      "<svg version=\"1.1\" xmlns=\"http://www.w3.org/2000/svg\" "
+	      "xmlns:xlink=\"http://www.w3.org/1999/xlink\" "
+	      "xmlns:inkscape=\"http://www.inkscape.org/namespaces/inkscape\">\n"
+	      "<defs><circle id=\"vertex\" cx=\"0\" cy=\"0\" r=\"4\"/></defs>\n"
+	      "<g inkscape:groupmode=\"layer\" inkscape:label=\"first\">\n"
+	      "<path class=\"s0\" d=\"M1.23 0L0 -2.5\"/>\n"
+	      "</g>\n"
+	      "<g inkscape:groupmode=\"layer\" inkscape:label=\"second_layer\">\n"
+	      "</g>\n"
+	      "<style>\n.s0" +
+	          STROKE_CLASS + "</style>\n</svg>\n");
+}
+
+TEST_CASE("Compressed SVG output") {
+	if (!SvgRenderer::supportsCompression()) {
+		return;
+	}
+	SvgRenderer renderer(std::make_shared<FunctionPainting>([](GeometryRenderer& renderer) {
+		renderer.draw(square(0, 0, 4));
+	}));
+	std::filesystem::path path = std::filesystem::temp_directory_path() / "test.svgz";
+	renderer.save(path);
+	std::string contents = fileContents(path);
+	REQUIRE(contents.size() >= 2);
+	// the gzip magic number
+	CHECK(static_cast<unsigned char>(contents[0]) == 0x1f);
+	CHECK(static_cast<unsigned char>(contents[1]) == 0x8b);
+}
+
+TEST_CASE("SVG output with a level-of-detail tolerance") {
+	SvgRenderer renderer(std::make_shared<FunctionPainting>([](GeometryRenderer& renderer) {
+		Polygon<Inexact> almostSquare;
+		for (const Point<Inexact>& p : {Point<Inexact>(0, 0), Point<Inexact>(2, 0.01), Point<Inexact>(4, 0),
+		                                Point<Inexact>(4, 4), Point<Inexact>(0, 4)}) {
+			almostSquare.push_back(p);
+		}
+		renderer.draw(almostSquare);
+		// smaller than the tolerance, so it is dropped
+		renderer.draw(square(10, 10, 0.2));
+	}));
+	renderer.setLodTolerance(0.5);
+	CHECK(svgOutput(renderer) == svgDocument("<path class=\"s0\" d=\"M0 0L4 0 4 -4 0 -4Z\"/>\n", ".s0" + STROKE_CLASS));
+}
@@ -0,0 +1,87 @@
+#include "../catch.hpp"
+
+#include "cartocrow/renderer/geometry_painting.h"
+#include "cartocrow/renderer/tile_pyramid.h"
+
+#include <filesystem>
+
+using namespace cartocrow;
+using namespace cartocrow::renderer;
+
+namespace {
+/// Fills the top-left quarter of the square [0, 100] × [0, 100].
+class QuarterPainting : public GeometryPainting {
+	void paint(GeometryRenderer& renderer) const override {
+		renderer.setMode(GeometryRenderer::fill);
+		renderer.setFill(Color{255, 0, 0});
+		Polygon<Inexact> square;
+		square.push_back(Point<Inexact>(0, 50));
+		square.push_back(Point<Inexact>(50, 50));
+		square.push_back(Point<Inexact>(50, 100));
+		square.push_back(Point<Inexact>(0, 100));
+		renderer.draw(square);
+	}
+};
+
+bool isFilled(const QImage& image, int x, int y) {
+	return qAlpha(image.pixel(x, y)) == 255 && qRed(image.pixel(x, y)) == 255;
+}
+} // namespace
+
+TEST_CASE("Rendering tiles of a tile pyramid") {
+	TilePyramid pyramid(std::make_shared<QuarterPainting>(), Box(0, 0, 100, 100), 64);
+
+	SECTION("tile coordinates") {
+		QImage root = pyramid.renderTile(0, 0, 0);
+		CHECK(root.width() == 64);
+		CHECK(isFilled(root, 16, 16));
+		CHECK(!isFilled(root, 48, 48));
+
+		// tile (0, 0) is the top-left one, with y increasing downwards
+		CHECK(isFilled(pyramid.renderTile(1, 0, 0), 32, 32));
+		CHECK(!isFilled(pyramid.renderTile(1, 1, 0), 32, 32));
+		CHECK(!isFilled(pyramid.renderTile(1, 0, 1), 32, 32));
+		CHECK(!isFilled(pyramid.renderTile(1, 1, 1), 32, 32));
+		CHECK(isFilled(pyramid.renderTile(2, 1, 1), 32, 32));
+		CHECK(!isFilled(pyramid.renderTile(2, 2, 1), 32, 32));
+	}
+
+	SECTION("saving all tiles") {
+		std::filesystem::path directory = std::filesystem::temp_directory_path() / "cartocrow_tiles";
+		std::filesystem::remove_all(directory);
+		int threads = GENERATE(1, 4);
+		CHECK(pyramid.save(directory, 1, 3, threads) == 4 + 16 + 64);
+		for (int z = 1; z <= 3; ++z) {
+			int n = 1 << z;
+			for (int x = 0; x < n; ++x) {
+				for (int y = 0; y < n; ++y) {
+					std::filesystem::path file = directory / std::to_string(z) / std::to_string(x) /
+					                             (std::to_string(y) + ".png");
+					REQUIRE(std::filesystem::exists(file));
+					QImage tile(QString::fromStdString(file.string()));
+					CHECK(isFilled(tile, 32, 32) == (x < n / 2 && y < n / 2));
+				}
+			}
+		}
+		CHECK(!std::filesystem::exists(directory / "4"));
+		std::filesystem::remove_all(directory);
+	}
+
+	SECTION("zoom levels out of range") {
+		std::filesystem::path directory = std::filesystem::temp_directory_path() / "cartocrow_tiles";
+		CHECK_THROWS_AS(pyramid.save(directory, -1, 0), std::runtime_error);
+		CHECK_THROWS_AS(pyramid.save(directory, 31, 31), std::runtime_error);
+		CHECK_THROWS_AS(pyramid.save(directory, 0, TilePyramid::MAX_ZOOM + 1), std::runtime_error);
+	}
+
+	SECTION("a tile that cannot be written") {
+		// a directory in place of the first tile of zoom level 1 makes writing it fail
+		std::filesystem::path directory = std::filesystem::temp_directory_path() / "cartocrow_tiles";
+		std::filesystem::remove_all(directory);
+		std::filesystem::create_directories(directory / "1" / "0");
+		std::filesystem::create_directories(directory / "1" / "0" / "0.png");
+		int threads = GENERATE(1, 4);
+		CHECK_THROWS_AS(pyramid.save(directory, 1, 1, threads), std::runtime_error);
+		std::filesystem::remove_all(directory);
+	}
+}
@@ -0,0 +1,62 @@
+#include "../catch.hpp"
+#include "cartocrow/renderer/svg_renderer.h"
+#include "cartocrow/simplesets/drawing_algorithm.h"
+#include "cartocrow/simplesets/partition_algorithm.h"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+using namespace cartocrow;
+using namespace cartocrow::simplesets;
+
+namespace {
+std::string drawingOutput(const Partition& partition, const GeneralSettings& gs) {
+	ComputeDrawingSettings cds{0.675};
+	DilatedPatternDrawing dpd(partition, gs, cds);
+	DrawSettings ds{{Color{166, 206, 227}, Color{251, 154, 153}}, 0.7};
+	auto painting = std::make_shared<SimpleSetsPainting>(dpd, ds);
+	renderer::SvgRenderer renderer(painting);
+	std::filesystem::path path = std::filesystem::temp_directory_path() / "simplesets_drawing.svg";
+	renderer.save(path);
+	std::ifstream file(path);
+	std::stringstream contents;
+	contents << file.rdbuf();
+	return contents.str();
+}
+} // namespace
+
+TEST_CASE("Drawing overlapping patterns") {
+	GeneralSettings gs{2.1, 2, M_PI, 70.0 / 180 * M_PI};
+	PartitionSettings ps{true, true, true, true, 0.1, 1};
+	// A row of category 0 crossed by columns of category 1, so that the dilations overlap.
+	std::vector<CatPoint> points;
+	for (int i = 0; i < 8; ++i) {
+		points.push_back({0, Point<Inexact>(8 * i, 0)});
+	}
+	for (int x : {12, 36}) {
+		for (int j = 1; j < 4; ++j) {
+			points.push_back({1, Point<Inexact>(x, 7 * j)});
+			points.push_back({1, Point<Inexact>(x + 4, -7 * j)});
+		}
+	}
+	PartitionHistory history = partitionHistory(points, gs, ps, 8 * gs.dilationRadius());
+	Partition partition = history.at(history.stepAt(4.7 * gs.dilationRadius()));
+
+	REQUIRE(partition.size() >= 2);
+
+	// the dilations of the row and the columns overlap, so some faces have a stacking order of two patterns
+	ComputeDrawingSettings cds{0.675};
+	DilatedPatternDrawing dpd(partition, gs, cds);
+	bool overlap = false;
+	for (auto fit = dpd.m_arr.faces_begin(); fit != dpd.m_arr.faces_end(); ++fit) {
+		CHECK(fit->data().ordering.size() == fit->data().origins.size());
+		overlap |= fit->data().ordering.size() >= 2;
+	}
+	CHECK(overlap);
+
+	// drawing does not depend on anything but the input
+	std::string output = drawingOutput(partition, gs);
+	CHECK(output.find("<path") != std::string::npos);
+	CHECK(output == drawingOutput(partition, gs));
+}
@@ -1,6 +1,8 @@
 #include "../catch.hpp"
 #include "cartocrow/simplesets/partition_algorithm.h"
 
+#include <algorithm>
+
 using namespace cartocrow;
 using namespace cartocrow::simplesets;
 
@@ -21,4 +23,93 @@ TEST_CASE("Intersection delay") {
 	Island p3({points[0], points[1], points[2], points[3]});
 	CHECK(intersectionDelay(p3.catPoints(), p1, p2, p3, gs, ps) == 0);
 	CHECK(abs(intersectionDelay(points, p1, p2, p3, gs, ps) - 3 / sqrt(2)) < M_EPSILON);
-}
\ No newline at end of file
+}
+TEST_CASE("Partitioning in parallel gives the same merges as partitioning serially") {
+	GeneralSettings gs{2.1, 2, M_PI, 70.0 / 180 * M_PI};
+	// A jittered grid of two categories, large enough for the candidate events to be computed in parallel.
+	std::vector<CatPoint> points;
+	for (int i = 0; i < 12; ++i) {
+		for (int j = 0; j < 12; ++j) {
+			points.push_back({(i * 7 + j * 3) % 5 == 0 ? 1u : 0u, Point<Inexact>(6 * i + (j % 3), 6 * j + (i % 2))});
+		}
+	}
+	PartitionSettings serialSettings{true, true, true, true, 0.1, 1};
+	PartitionSettings parallelSettings{true, true, true, true, 0.1, 4};
+	auto serial = partitionHistory(points, gs, serialSettings, 8 * gs.dilationRadius());
+	auto parallel = partitionHistory(points, gs, parallelSettings, 8 * gs.dilationRadius());
+
+	REQUIRE(serial.merges().size() == parallel.merges().size());
+	for (int i = 0; i < serial.merges().size(); ++i) {
+		const Merge& s = serial.merges()[i];
+		const Merge& p = parallel.merges()[i];
+		CHECK(s.time == p.time);
+		CHECK(s.result->catPoints() == p.result->catPoints());
+	}
+}
+
+TEST_CASE("Finding the step of a cover radius when merge times are not monotone") {
+	CatPoint a{0, {0, 0}};
+	CatPoint b{0, {2, 0}};
+	CatPoint c{0, {10, 0}};
+	CatPoint d{0, {12, 0}};
+	auto pa = std::make_shared<SinglePoint>(a);
+	auto pb = std::make_shared<SinglePoint>(b);
+	auto pc = std::make_shared<SinglePoint>(c);
+	auto pd = std::make_shared<SinglePoint>(d);
+	auto ab = std::make_shared<Matching>(a, b);
+	auto cd = std::make_shared<Matching>(c, d);
+	auto abcd = std::make_shared<Bank>(std::vector<CatPoint>{a, b, c, d});
+	// the second merge happens at an earlier time than the first
+	PartitionHistory history({pa, pb, pc, pd}, {{3, pa, pb, ab}, {2, pc, pd, cd}, {5, ab, cd, abcd}});
+
+	CHECK(history.stepAt(1) == 0);
+	CHECK(history.stepAt(2) == 0);
+	CHECK(history.stepAt(2.5) == 2);
+	CHECK(history.stepAt(3) == 2);
+	CHECK(history.stepAt(4) == 2);
+	CHECK(history.stepAt(6) == 3);
+}
+
+TEST_CASE("Reconstructing partitions from a partition history") {
+	// merge 40 single points pairwise in a fixed order, with merge times that are not monotone
+	Partition initial;
+	for (int i = 0; i < 40; ++i) {
+		initial.push_back(std::make_shared<SinglePoint>(CatPoint{0, {static_cast<double>(i), 0}}));
+	}
+	std::vector<Merge> merges;
+	std::vector<Partition> expected({initial});
+	Partition current = initial;
+	for (int i = 0; current.size() > 1; ++i) {
+		auto p1 = current[i % current.size()];
+		auto p2 = current[(i + 1) % current.size()];
+		auto result = std::make_shared<SinglePoint>(CatPoint{0, {static_cast<double>(i), 1}});
+		merges.push_back({static_cast<double>((7 * i) % 10), p1, p2, result});
+		Partition next;
+		for (const auto& p : expected.back()) {
+			if (p != p1 && p != p2) {
+				next.push_back(p);
+			}
+		}
+		next.push_back(result);
+		expected.push_back(next);
+		current.erase(std::remove_if(current.begin(), current.end(),
+		                             [&](const auto& p) { return p == p1 || p == p2; }),
+		              current.end());
+		current.push_back(result);
+	}
+	PartitionHistory history(initial, merges);
+
+	REQUIRE(history.size() == expected.size());
+	for (int step = 0; step < history.size(); ++step) {
+		CHECK(history.at(step) == expected[step]);
+	}
+	for (double time = -1; time < 11; time += 0.25) {
+		int step = 0;
+		for (int s = 1; s < history.size(); ++s) {
+			if (merges[s - 1].time < time) {
+				step = s;
+			}
+		}
+		CHECK(history.stepAt(time) == step);
+	}
+}